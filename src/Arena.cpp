@@ -87,6 +87,73 @@ void* Arena::AllocOrDie(ptrdiff_t size, ptrdiff_t align, int flags)
     return ret;
 }
 
+void* Arena::Realloc(void* ptr, ptrdiff_t oldSize, ptrdiff_t newSize, ptrdiff_t align, int flags)
+{
+    assert(oldSize >= 0);
+    assert(newSize >= oldSize);
+
+    uchar* const bytes = static_cast<uchar*>(ptr);
+
+    if (bytes && bytes + oldSize == mBuffer + mCurrentOffset)
+    {
+        // Last allocation, grow in place.
+        const ptrdiff_t offset = bytes - mBuffer;
+        if (newSize > mBufferSize - offset)
+        {
+            return nullptr;
+        }
+
+        mCurrentOffset = offset + newSize;
+        mMaxOffset = mCurrentOffset;
+        if (!(flags & FlagNoZero))
+        {
+            memset(bytes + oldSize, 0, static_cast<size_t>(newSize - oldSize));
+        }
+
+        return ptr;
+    }
+
+    void* const newPtr = Alloc(newSize, align, flags | FlagNoZero);
+    if (!newPtr)
+    {
+        return nullptr;
+    }
+
+    if (bytes)
+    {
+        memcpy(newPtr, bytes, static_cast<size_t>(oldSize));
+    }
+    if (!(flags & FlagNoZero))
+    {
+        memset(static_cast<uchar*>(newPtr) + oldSize, 0, static_cast<size_t>(newSize - oldSize));
+    }
+
+    return newPtr;
+}
+
+void* Arena::ReallocOrDie(
+    void* ptr,
+    ptrdiff_t oldSize,
+    ptrdiff_t newSize,
+    ptrdiff_t align,
+    int flags
+)
+{
+    void* const ret = Realloc(ptr, oldSize, newSize, align, flags);
+    if (!ret)
+    {
+        fprintf(
+            stderr,
+            "Arena::Realloc failed (size = %td, align = %td, name = %s)\n",
+            newSize,
+            align,
+            mName
+        );
+        exit(1);
+    }
+    return ret;
+}
+
 void Arena::FreeAll()
 {
     mCurrentOffset = 0;
@@ -31,6 +31,22 @@ struct Arena
     void Init(ptrdiff_t size, const char* name = nullptr); // Exits on allocation failure.
     void* Alloc(ptrdiff_t size, ptrdiff_t align, int flags = FlagNone);
     void* AllocOrDie(ptrdiff_t size, ptrdiff_t align, int flags = FlagNone);
+    // Grows in place if ptr is the last allocation, otherwise allocates and copies
+    // (the old block is reclaimed with the rest of the arena).
+    void* Realloc(
+        void* ptr,
+        ptrdiff_t oldSize,
+        ptrdiff_t newSize,
+        ptrdiff_t align,
+        int flags = FlagNone
+    );
+    void* ReallocOrDie(
+        void* ptr,
+        ptrdiff_t oldSize,
+        ptrdiff_t newSize,
+        ptrdiff_t align,
+        int flags = FlagNone
+    );
     void FreeAll();
     void FreeBuffer();
 
@@ -46,6 +62,17 @@ struct Arena
             AllocOrDie(count * static_cast<ptrdiff_t>(sizeof(T)), alignof(T), flags)
         );
     }
+    template <typename T>
+    T* ReallocOrDie(T* ptr, ptrdiff_t oldCount, ptrdiff_t newCount, int flags = FlagNone)
+    {
+        return static_cast<T*>(ReallocOrDie(
+            ptr,
+            oldCount * static_cast<ptrdiff_t>(sizeof(T)),
+            newCount * static_cast<ptrdiff_t>(sizeof(T)),
+            alignof(T),
+            flags
+        ));
+    }
 };
 
 // For static resources (whole program lifetime).
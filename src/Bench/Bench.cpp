@@ -0,0 +1,595 @@
+// Headless physics benchmark: steps canned scenes of different sizes without a window,
+// Vulkan or ImGui and prints per-phase step timings (min/median/p99) as CSV to stdout.
+//
+// Usage: demo_bench [--steps N] [--scene NAME] [--bodies N] [--solver NAME] [--threads N]
+//                   [--broadphase NAME] [--no-sleeping]
+
+#include "../Common.hpp"
+#include "../Arena.hpp"
+#include "../TimeMeter.hpp"
+#include "../ThreadPool.hpp"
+#include "../Utils.hpp"
+#include "../Physics/World.hpp"
+#include "../Math/Utils.hpp"
+#include "../Math/Vec3.hpp"
+#include "../Math/Quat.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr f32 TIME_STEP = 1.0f / 60.0f;
+static constexpr int ITERATIONS_COUNT = 10;
+static constexpr int DEFAULT_STEPS_COUNT = 300;
+static constexpr int DEFAULT_BODIES_COUNTS[] = {1'000, 10'000, 50'000};
+
+static constexpr f32 FLOOR_HEIGHT = 5.0f;
+static constexpr f32 FLOOR_MIN_SIZE = 200.0f;
+static constexpr f32 FLOOR_MARGIN = 20.0f;
+
+struct Phase
+{
+    int mTimeMeter;
+    const char* mName;
+};
+
+// Same phases as in the "Info" window of the demo, plus the whole step. Some run only in part
+// of the configurations: islands with sleeping, integrate_forces without the soft step solver
+// and continuous with bullets.
+static constexpr Phase PHASES[] = {
+    {TimeMeter::PhysicsUpdateBroadPhase, "update_broadphase"},
+    {TimeMeter::PhysicsContactManifold, "contact_manifold"},
+    {TimeMeter::PhysicsIslands, "islands"},
+    {TimeMeter::PhysicsInertiasWorld, "inertias_world"},
+    {TimeMeter::PhysicsIntegrateForces, "integrate_forces"},
+    {TimeMeter::PhysicsPrestep, "prestep"},
+    {TimeMeter::PhysicsApplyImpulse, "apply_impulse"},
+    {TimeMeter::PhysicsIntegrateVelocities, "integrate_velocities"},
+    {TimeMeter::PhysicsContinuous, "continuous"},
+    {TimeMeter::Physics, "step"},
+};
+
+using SceneFunction = void (*)(World& world, int bodiesCount);
+
+struct Scene
+{
+    const char* mName;
+    SceneFunction mFunction;
+};
+
+struct Solver
+{
+    const char* mName;
+    ContactSolverType mType;
+};
+
+static constexpr Solver SOLVERS[] = {
+    {"sequential", ContactSolverType::Sequential},
+    {"wide", ContactSolverType::Wide},
+    {"soft", ContactSolverType::SoftStep},
+};
+
+struct BroadPhase
+{
+    const char* mName;
+    BroadPhaseType mType;
+};
+
+static constexpr BroadPhase BROAD_PHASES[] = {
+    {"hgrid", BroadPhaseType::HGrid},
+    {"tree", BroadPhaseType::AabbTree},
+    {"sap", BroadPhaseType::SweepAndPrune},
+};
+
+// World settings from the command line.
+struct Options
+{
+    const Solver* mSolver;
+    const BroadPhase* mBroadPhase;
+    bool mDisableSleeping;
+};
+
+static World sWorld;
+static ThreadPool sThreadPool;
+
+static void AddFloor(World& world, f32 size)
+{
+    Body bodyDef{};
+    world.BodyInitBox(bodyDef, FLT_MAX, Vec3{size, FLOOR_HEIGHT, size} * 0.5f);
+    bodyDef.mPosition.Y() = -FLOOR_HEIGHT * 0.5f;
+    bodyDef.mFriction = 0.6f;
+    const Body::Id floorId = world.AddBody(bodyDef);
+    assert(world.IsBodyIdValid(floorId));
+    (void)floorId;
+}
+
+static int GridSide(int count)
+{
+    return Max(1, static_cast<int>(ceilf(sqrtf(static_cast<f32>(count)))));
+}
+
+// Spheres in a loose block, settling into a pile.
+static void SceneSpheres(World& world, int bodiesCount)
+{
+    constexpr f32 RADIUS = 0.2f;
+    constexpr f32 JITTER = 0.02f;
+    constexpr f32 SPACING = RADIUS * 2.0f + JITTER * 2.0f + 0.01f;
+    constexpr int LAYERS = 10;
+
+    const int side = GridSide((bodiesCount + LAYERS - 1) / LAYERS);
+    const f32 halfExtent = 0.5f * SPACING * static_cast<f32>(side);
+    AddFloor(world, Max(FLOOR_MIN_SIZE, 2.0f * halfExtent + FLOOR_MARGIN));
+
+    Body bodyDef{};
+    world.BodyInitSphere(bodyDef, 1000.0f, RADIUS);
+
+    u32 seed = 1;
+    for (int i = 0; i < bodiesCount; ++i)
+    {
+        const int x = i % side;
+        const int z = (i / side) % side;
+        const int y = i / (side * side);
+        bodyDef.mPosition
+            = {static_cast<f32>(x) * SPACING - halfExtent + LfsrNextGetFloat(seed, JITTER),
+               RADIUS + static_cast<f32>(y) * SPACING,
+               static_cast<f32>(z) * SPACING - halfExtent + LfsrNextGetFloat(seed, JITTER)};
+        if (!world.IsBodyIdValid(world.AddBody(bodyDef)))
+        {
+            return;
+        }
+    }
+}
+
+// Square pyramids of unit boxes laid out on a grid.
+static void SceneBoxPyramids(World& world, int bodiesCount)
+{
+    constexpr f32 BOX_SIZE = 1.0f;
+    constexpr f32 GAP_ROWS = 0.01f;
+    constexpr f32 GAP_COLUMNS = 0.05f;
+    constexpr int BASE = 10;
+    constexpr int BOXES_PER_PYRAMID = BASE * (BASE + 1) * (2 * BASE + 1) / 6;
+    constexpr f32 PYRAMID_SPACING = (BOX_SIZE + GAP_COLUMNS) * BASE + 2.0f;
+
+    const int pyramidsCount = (bodiesCount + BOXES_PER_PYRAMID - 1) / BOXES_PER_PYRAMID;
+    const int side = GridSide(pyramidsCount);
+    const f32 halfExtent = 0.5f * PYRAMID_SPACING * static_cast<f32>(side);
+    AddFloor(world, Max(FLOOR_MIN_SIZE, 2.0f * halfExtent + FLOOR_MARGIN));
+
+    Body bodyDef{};
+    world.BodyInitBox(bodyDef, 1000.0f, Vec3{BOX_SIZE * 0.5f});
+
+    int added = 0;
+    for (int p = 0; p < pyramidsCount; ++p)
+    {
+        const f32 baseX = static_cast<f32>(p % side) * PYRAMID_SPACING - halfExtent;
+        const f32 baseZ = static_cast<f32>(p / side) * PYRAMID_SPACING - halfExtent;
+        for (int layer = 0; layer < BASE; ++layer)
+        {
+            const int layerSide = BASE - layer;
+            const f32 layerOffset = 0.5f * (BOX_SIZE + GAP_COLUMNS) * static_cast<f32>(layer);
+            for (int i = 0; i < layerSide * layerSide; ++i)
+            {
+                if (added == bodiesCount)
+                {
+                    return;
+                }
+                bodyDef.mPosition
+                    = {baseX + layerOffset
+                           + (BOX_SIZE + GAP_COLUMNS) * static_cast<f32>(i % layerSide),
+                       BOX_SIZE / 2.0f + (BOX_SIZE + GAP_ROWS) * static_cast<f32>(layer),
+                       baseZ + layerOffset
+                           + (BOX_SIZE + GAP_COLUMNS) * static_cast<f32>(i / layerSide)};
+                if (!world.IsBodyIdValid(world.AddBody(bodyDef)))
+                {
+                    return;
+                }
+                ++added;
+            }
+        }
+    }
+}
+
+// The ResetWorld scene from Main.cpp (a wall hit by a fast collider, a block of spheres),
+// tiled until the requested body count is reached.
+static void SceneWall(World& world, int bodiesCount)
+{
+    constexpr int WALL_ROWS = 4;
+    constexpr int WALL_COLUMNS = 4;
+    constexpr int SPHERES_DIMENSION = 5;
+    constexpr int BODIES_PER_TILE
+        = 1 + WALL_ROWS * WALL_COLUMNS + SPHERES_DIMENSION * SPHERES_DIMENSION * SPHERES_DIMENSION;
+    constexpr f32 TILE_SIZE_X = 50.0f;
+    constexpr f32 TILE_SIZE_Z = 40.0f;
+
+    const int tilesCount = (bodiesCount + BODIES_PER_TILE - 1) / BODIES_PER_TILE;
+    const int side = GridSide(tilesCount);
+    const f32 halfExtent = 0.5f * Max(TILE_SIZE_X, TILE_SIZE_Z) * static_cast<f32>(side);
+    AddFloor(world, Max(FLOOR_MIN_SIZE, 2.0f * halfExtent + FLOOR_MARGIN));
+
+    ConvexHull colliderHull{};
+    colliderHull.InitTetrahedron(Vec3{2.0f});
+
+    constexpr f32 WALL_BOX_WIDTH = 2.0f;
+
+    const ConvexHull::Id colliderHullId = world.AddConvexHull(colliderHull);
+
+    constexpr f32 BODIES_GAP_ROWS = 0.01f;
+    constexpr f32 BODIES_GAP_COLUMNS = 0.05f;
+    constexpr f32 SPHERE_RADIUS = 0.2f;
+    constexpr f32 SPHERE_DIAMETER = SPHERE_RADIUS * 2.0f;
+    constexpr f32 SPHERES_GAP = 0.001f;
+
+    Body colliderDef{};
+    world.BodyInitConvexHull(colliderDef, 20000.0f, colliderHullId);
+    colliderDef.mOrientation
+        = Quat::FromAxis(Radians(40.0f), WORLD_Y) * Quat::FromAxis(Radians(83.0f), WORLD_Z);
+    colliderDef.mVelocity = Rotate(colliderDef.mOrientation, WORLD_Y) * 52.9f;
+    colliderDef.mAngularVelocity = {10.0f, 0.0f, 0.0f};
+    colliderDef.mIsBullet = true;
+
+    Body wallDef{};
+    world.BodyInitBox(wallDef, 1500.0f, Vec3{WALL_BOX_WIDTH * 0.5f});
+
+    Body sphereDef{};
+    world.BodyInitSphere(sphereDef, 1000.0f, SPHERE_RADIUS);
+
+    int added = 0;
+    const auto add = [&](const Body& bodyDef)
+    {
+        if (added == bodiesCount || !world.IsBodyIdValid(world.AddBody(bodyDef)))
+        {
+            return false;
+        }
+        ++added;
+        return true;
+    };
+
+    for (int t = 0; t < tilesCount; ++t)
+    {
+        const Vec3 origin
+            = {static_cast<f32>(t % side) * TILE_SIZE_X - halfExtent,
+               0.0f,
+               static_cast<f32>(t / side) * TILE_SIZE_Z - halfExtent + 30.0f};
+
+        colliderDef.mPosition = origin + Vec3{38.0f, 2.0f, -30.0f};
+        if (!add(colliderDef))
+        {
+            return;
+        }
+
+        for (int i = 0; i < WALL_COLUMNS; ++i)
+        {
+            for (int j = 0; j < WALL_ROWS; ++j)
+            {
+                wallDef.mPosition = origin
+                    + Vec3{(WALL_BOX_WIDTH + BODIES_GAP_COLUMNS) * static_cast<f32>(i),
+                           WALL_BOX_WIDTH / 2.0f
+                               + (WALL_BOX_WIDTH + BODIES_GAP_ROWS) * static_cast<f32>(j),
+                           0.0f};
+                if (!add(wallDef))
+                {
+                    return;
+                }
+            }
+        }
+
+        for (int x = 0; x < SPHERES_DIMENSION; ++x)
+        {
+            for (int y = 0; y < SPHERES_DIMENSION; ++y)
+            {
+                for (int z = 0; z < SPHERES_DIMENSION; ++z)
+                {
+                    constexpr f32 SPACING = SPHERE_DIAMETER + SPHERES_GAP;
+                    sphereDef.mPosition = origin
+                        + Vec3{SPACING * static_cast<f32>(x),
+                               SPHERE_RADIUS + SPACING * static_cast<f32>(y),
+                               -20.0f + SPACING * static_cast<f32>(z)};
+                    if (!add(sphereDef))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Boxes, planks, tetrahedra, cylinders and spheres of different sizes with random
+// orientations, dropped from a few layers.
+static void SceneMixed(World& world, int bodiesCount)
+{
+    constexpr f32 CELL_SIZE = 2.5f;
+    constexpr int LAYERS = 4;
+
+    const int side = GridSide((bodiesCount + LAYERS - 1) / LAYERS);
+    const f32 halfExtent = 0.5f * CELL_SIZE * static_cast<f32>(side);
+    AddFloor(world, Max(FLOOR_MIN_SIZE, 2.0f * halfExtent + FLOOR_MARGIN));
+
+    // Cylinder from quickhull.
+    constexpr int CYLINDER_SIDES = 12;
+    Vec3 cylinderPoints[2 * CYLINDER_SIDES]{};
+    for (int i = 0; i < CYLINDER_SIDES; ++i)
+    {
+        const f32 angle = 2.0f * M_PIf * static_cast<f32>(i) / CYLINDER_SIDES;
+        cylinderPoints[2 * i] = {0.5f * cosf(angle), -0.5f, 0.5f * sinf(angle)};
+        cylinderPoints[2 * i + 1] = {0.5f * cosf(angle), 0.5f, 0.5f * sinf(angle)};
+    }
+
+    ConvexHull tetrahedronHull{};
+    tetrahedronHull.InitTetrahedron(Vec3{1.0f});
+    ConvexHull cylinderHull{};
+    cylinderHull.InitFromPoints(cylinderPoints, ARRAY_SSIZE(cylinderPoints), gArenaReset);
+    const ConvexHull::Id tetrahedronHullId = world.AddConvexHull(tetrahedronHull);
+    const ConvexHull::Id cylinderHullId = world.AddConvexHull(cylinderHull);
+
+    // Boxes, then different sizes sharing the hulls.
+    Body hullDefs[6]{};
+    world.BodyInitBox(hullDefs[0], 1000.0f, Vec3{0.5f});
+    world.BodyInitBox(hullDefs[1], 1000.0f, {1.0f, 0.25f, 0.5f});
+    world.BodyInitBox(hullDefs[2], 1000.0f, Vec3{0.25f});
+    world.BodyInitConvexHull(hullDefs[3], 1000.0f, tetrahedronHullId);
+    world.BodyInitConvexHull(hullDefs[4], 1000.0f, tetrahedronHullId, {1.5f, 0.75f, 1.5f});
+    world.BodyInitConvexHull(hullDefs[5], 1000.0f, cylinderHullId);
+
+    Body sphereDefs[2]{};
+    world.BodyInitSphere(sphereDefs[0], 1000.0f, 0.25f);
+    world.BodyInitSphere(sphereDefs[1], 1000.0f, 0.5f);
+
+    constexpr int KINDS_COUNT = ARRAY_SIZE(hullDefs) + ARRAY_SIZE(sphereDefs);
+
+    u32 seed = 1;
+    for (int i = 0; i < bodiesCount; ++i)
+    {
+        seed = LfsrNext(seed);
+        const int kind = static_cast<int>(seed % KINDS_COUNT);
+        Body bodyDef = kind < ARRAY_SSIZE(hullDefs) ? hullDefs[kind]
+                                                    : sphereDefs[kind - ARRAY_SSIZE(hullDefs)];
+
+        const int x = i % side;
+        const int z = (i / side) % side;
+        const int y = i / (side * side);
+        bodyDef.mPosition
+            = {static_cast<f32>(x) * CELL_SIZE - halfExtent,
+               CELL_SIZE * (0.5f + static_cast<f32>(y)),
+               static_cast<f32>(z) * CELL_SIZE - halfExtent};
+
+        const Vec3 axis = Normalize(Vec3{
+            LfsrNextGetFloat(seed, 1.0f),
+            LfsrNextGetFloat(seed, 1.0f),
+            LfsrNextGetFloat(seed, 1.0f) + 0.01f,
+        });
+        bodyDef.mOrientation = Quat::FromAxis(LfsrNextGetFloat(seed, M_PIf), axis);
+
+        if (!world.IsBodyIdValid(world.AddBody(bodyDef)))
+        {
+            return;
+        }
+    }
+}
+
+static constexpr Scene SCENES[] = {
+    {"spheres", SceneSpheres},
+    {"pyramids", SceneBoxPyramids},
+    {"wall", SceneWall},
+    {"mixed", SceneMixed},
+};
+
+static int CompareF64(const void* a, const void* b)
+{
+    const f64 x = *static_cast<const f64*>(a);
+    const f64 y = *static_cast<const f64*>(b);
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples.
+static f64 Percentile(const f64* sorted, int count, f64 percentile)
+{
+    assert(count > 0);
+    const int rank = static_cast<int>(ceil(percentile / 100.0 * static_cast<f64>(count)));
+    return sorted[Clamp(rank - 1, 0, count - 1)];
+}
+
+static void RunScene(const Scene& scene, int bodiesCount, int stepsCount, const Options& options)
+{
+    sWorld.Reset();
+    WorldDesc worldDesc{};
+    worldDesc.mGravity = {0.0f, -9.81f, 0.0f};
+    worldDesc.mTimeStep = TIME_STEP;
+    worldDesc.mIterationsCount = ITERATIONS_COUNT;
+    worldDesc.mSolver = options.mSolver->mType;
+    worldDesc.mBroadPhase = options.mBroadPhase->mType;
+    worldDesc.mThreadPool = &sThreadPool;
+    worldDesc.mDisableSleeping = options.mDisableSleeping;
+    worldDesc.mBodiesCapacity = bodiesCount + 1; // With the floor.
+    sWorld.Init(worldDesc);
+    scene.mFunction(sWorld, bodiesCount);
+
+    constexpr int PHASES_COUNT = ARRAY_SSIZE(PHASES);
+    // Not in gArenaReset, World owns that one.
+    f64* samples = static_cast<f64*>(
+        Utils::xmalloc(sizeof(f64) * static_cast<size_t>(PHASES_COUNT * stepsCount))
+    );
+    DEFER(SAFE_FREE(samples));
+    // Phases the solver or the scene never runs (integrate_forces of the soft step solver, ...)
+    // aren't printed.
+    bool isPhaseRun[PHASES_COUNT] = {};
+
+    for (int step = 0; step < stepsCount; ++step)
+    {
+        gArenaFrame.FreeAll();
+
+        // Phases skipped in this step (no bullets, ...) read 0 instead of an older step.
+        for (int p = 0; p < PHASES_COUNT; ++p)
+        {
+            gTimeMeters[PHASES[p].mTimeMeter].ClearLast();
+        }
+
+        gTimeMeters[TimeMeter::Physics].Start();
+        sWorld.Step();
+        gTimeMeters[TimeMeter::Physics].End();
+
+        for (int p = 0; p < PHASES_COUNT; ++p)
+        {
+            const TimeMeter& meter = gTimeMeters[PHASES[p].mTimeMeter];
+            samples[p * stepsCount + step] = meter.GetLastUs();
+            isPhaseRun[p] = isPhaseRun[p] || meter.HasLast();
+        }
+    }
+
+    for (int p = 0; p < PHASES_COUNT; ++p)
+    {
+        if (!isPhaseRun[p])
+        {
+            continue;
+        }
+        f64* const phaseSamples = samples + p * stepsCount;
+        qsort(phaseSamples, static_cast<size_t>(stepsCount), sizeof(f64), CompareF64);
+        printf(
+            "%s,%s,%s,%d,%d,%d,%s,%.1f,%.1f,%.1f\n",
+            scene.mName,
+            options.mSolver->mName,
+            options.mBroadPhase->mName,
+            sThreadPool.GetThreadsCount(),
+            sWorld.GetBodiesCount() - 1, // Without the floor.
+            stepsCount,
+            PHASES[p].mName,
+            phaseSamples[0],
+            Percentile(phaseSamples, stepsCount, 50.0),
+            Percentile(phaseSamples, stepsCount, 99.0)
+        );
+    }
+    fflush(stdout);
+}
+
+static void PrintUsage(const char* program)
+{
+    fprintf(
+        stderr,
+        "Usage: %s [--steps N] [--scene NAME] [--bodies N] [--solver NAME] [--threads N]"
+        " [--broadphase NAME] [--no-sleeping]\n",
+        program
+    );
+    fprintf(stderr, "Scenes:");
+    for (size_t i = 0; i < ARRAY_SIZE(SCENES); ++i)
+    {
+        fprintf(stderr, " %s", SCENES[i].mName);
+    }
+    fprintf(stderr, "\nSolvers:");
+    for (size_t i = 0; i < ARRAY_SIZE(SOLVERS); ++i)
+    {
+        fprintf(stderr, " %s", SOLVERS[i].mName);
+    }
+    fprintf(stderr, "\nBroad-phases:");
+    for (size_t i = 0; i < ARRAY_SIZE(BROAD_PHASES); ++i)
+    {
+        fprintf(stderr, " %s", BROAD_PHASES[i].mName);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char** argv)
+{
+    int stepsCount = DEFAULT_STEPS_COUNT;
+    int bodiesCount = 0; // All of DEFAULT_BODIES_COUNTS.
+    const char* sceneName = nullptr; // All of SCENES.
+    Options options{&SOLVERS[0], &BROAD_PHASES[0], false};
+    int threadsCount = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (hasValue && strcmp(argv[i], "--steps") == 0)
+        {
+            stepsCount = atoi(argv[++i]);
+        }
+        else if (hasValue && strcmp(argv[i], "--bodies") == 0)
+        {
+            bodiesCount = atoi(argv[++i]);
+        }
+        else if (hasValue && strcmp(argv[i], "--scene") == 0)
+        {
+            sceneName = argv[++i];
+        }
+        else if (hasValue && strcmp(argv[i], "--threads") == 0)
+        {
+            threadsCount = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--no-sleeping") == 0)
+        {
+            options.mDisableSleeping = true;
+        }
+        else if (hasValue && strcmp(argv[i], "--solver") == 0)
+        {
+            ++i;
+            options.mSolver = nullptr;
+            for (size_t j = 0; j < ARRAY_SIZE(SOLVERS); ++j)
+            {
+                if (strcmp(argv[i], SOLVERS[j].mName) == 0)
+                {
+                    options.mSolver = &SOLVERS[j];
+                }
+            }
+        }
+        else if (hasValue && strcmp(argv[i], "--broadphase") == 0)
+        {
+            ++i;
+            options.mBroadPhase = nullptr;
+            for (size_t j = 0; j < ARRAY_SIZE(BROAD_PHASES); ++j)
+            {
+                if (strcmp(argv[i], BROAD_PHASES[j].mName) == 0)
+                {
+                    options.mBroadPhase = &BROAD_PHASES[j];
+                }
+            }
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (stepsCount <= 0 || bodiesCount < 0 || !options.mSolver || !options.mBroadPhase
+        || threadsCount <= 0)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    gArenaReset.Init(2'000'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(256'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+    sThreadPool.Init(threadsCount);
+    DEFER(sThreadPool.Shutdown());
+
+    printf("scene,solver,broadphase,threads,bodies,steps,phase,min_us,median_us,p99_us\n");
+
+    bool sceneFound = false;
+    for (size_t i = 0; i < ARRAY_SIZE(SCENES); ++i)
+    {
+        if (sceneName && strcmp(sceneName, SCENES[i].mName) != 0)
+        {
+            continue;
+        }
+        sceneFound = true;
+
+        if (bodiesCount > 0)
+        {
+            RunScene(SCENES[i], bodiesCount, stepsCount, options);
+            continue;
+        }
+        for (size_t j = 0; j < ARRAY_SIZE(DEFAULT_BODIES_COUNTS); ++j)
+        {
+            RunScene(SCENES[i], DEFAULT_BODIES_COUNTS[j], stepsCount, options);
+        }
+    }
+
+    if (!sceneFound)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    return 0;
+}
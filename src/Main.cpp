@@ -3,6 +3,7 @@
 #include "Camera.hpp"
 #include "Physics/World.hpp"
 #include "TimeMeter.hpp"
+#include "ThreadPool.hpp"
 #include "Math/Quat.hpp"
 #include "Math/Utils.hpp"
 #include "Utils.hpp"
@@ -32,15 +33,17 @@ struct Bodies
 
     struct Table
     {
+        static constexpr int CAPACITY = 16;
+
         int mCount;
         int mChosen;
-        Body::Id mIds[PHYSICS_MAX_BODIES];
-        const char* mStrings[PHYSICS_MAX_BODIES];
+        Body::Id mIds[CAPACITY];
+        const char* mStrings[CAPACITY];
 
         void Add(Body::Id id, const char* string)
         {
-            assert(mCount < PHYSICS_MAX_BODIES);
-            if (mCount >= PHYSICS_MAX_BODIES)
+            assert(mCount < CAPACITY);
+            if (mCount >= CAPACITY)
             {
                 return;
             }
@@ -60,6 +63,7 @@ static bool sEnableUI = true;
 static bool sMouseRelativeMode = true;
 static bool sPhysicsStepped;
 static World sWorld;
+static ThreadPool sThreadPool;
 static Bodies sBodies;
 constexpr f32 TIME_STEP = 1.0f / 60.0f;
 
@@ -78,33 +82,31 @@ static void ResetWorld(World& world, Bodies& bodies, f32 timeStep, bool accurate
         timeStep /= 10.0f;
     }
 
+    WorldDesc worldDesc{};
 #ifdef PHYSICS_COLLIDE_ONLY
-    world.Init({0.0f, 0.0f, 0.0f}, timeStep, 10);
+    worldDesc.mGravity = {0.0f, 0.0f, 0.0f};
 #else
-    world.Init({0.0f, -9.81f, 0.0f}, timeStep, 10);
+    worldDesc.mGravity = {0.0f, -9.81f, 0.0f};
 #endif
+    worldDesc.mTimeStep = timeStep;
+    worldDesc.mIterationsCount = 10;
+    worldDesc.mThreadPool = &sThreadPool;
+    world.Init(worldDesc);
 
     ConvexHull colliderHull{};
     colliderHull.InitTetrahedron(Vec3{2.0f});
 
-    ConvexHull floorHull{};
     constexpr Vec3 FLOOR_SIZE = {200.0f, 5.0f, 200.0f};
-    floorHull.InitBox(FLOOR_SIZE);
-
     constexpr f32 WALL_BOX_WIDTH = 2.0f;
-    ConvexHull wallHull{};
-    wallHull.InitBox(Vec3{WALL_BOX_WIDTH});
 
     const ConvexHull::Id colliderHullId = world.AddConvexHull(colliderHull);
-    const ConvexHull::Id floorHullId = world.AddConvexHull(floorHull);
-    const ConvexHull::Id wallHullId = world.AddConvexHull(wallHull);
 
     Body bodyDef{};
 
-    world.BodyInitConvexHull(bodyDef, FLT_MAX, floorHullId);
+    world.BodyInitBox(bodyDef, FLT_MAX, FLOOR_SIZE * 0.5f);
     bodyDef.mPosition.Y() = -FLOOR_SIZE.Y() * 0.5f;
     bodyDef.mFriction = 0.6f;
-    bodies.mFloor = world.SetFloor(bodyDef);
+    bodies.mFloor = world.AddBody(bodyDef);
     assert(world.IsBodyIdValid(bodies.mFloor));
 
     world.BodyInitConvexHull(bodyDef, 20000.0f, colliderHullId);
@@ -113,6 +115,7 @@ static void ResetWorld(World& world, Bodies& bodies, f32 timeStep, bool accurate
         = Quat::FromAxis(Radians(40.0f), WORLD_Y) * Quat::FromAxis(Radians(83.0f), WORLD_Z);
     bodyDef.mVelocity = Rotate(bodyDef.mOrientation, WORLD_Y) * 52.9f;
     bodyDef.mAngularVelocity = {10.0f, 0.0f, 0.0f};
+    bodyDef.mIsBullet = true;
     bodies.mCollider = world.AddBody(bodyDef);
     assert(world.IsBodyIdValid(bodies.mCollider));
     bodies.mTable.Add(bodies.mCollider, "Collider");
@@ -120,21 +123,25 @@ static void ResetWorld(World& world, Bodies& bodies, f32 timeStep, bool accurate
     constexpr f32 BODIES_GAP_ROWS = 0.01f;
     constexpr f32 BODIES_GAP_COLUMNS = 0.05f;
 
-    world.BodyInitConvexHull(bodyDef, 1500.0f, wallHullId);
+    world.BodyInitBox(bodyDef, 1500.0f, Vec3{WALL_BOX_WIDTH * 0.5f});
 
+    Vec3 wallPositions[ARRAY_SIZE(bodies.mWall)];
     for (int i = 0; i < bodies.WALL_COLUMNS; ++i)
     {
         for (int j = 0; j < bodies.WALL_ROWS; ++j)
         {
-            const int index = i * bodies.WALL_ROWS + j;
-            bodyDef.mPosition
+            wallPositions[i * bodies.WALL_ROWS + j]
                 = {(WALL_BOX_WIDTH + BODIES_GAP_COLUMNS) * static_cast<f32>(i),
                    WALL_BOX_WIDTH / 2.0f + (WALL_BOX_WIDTH + BODIES_GAP_ROWS) * static_cast<f32>(j),
                    0.0f};
-            bodies.mWall[index] = world.AddBody(bodyDef);
-            assert(world.IsBodyIdValid(bodies.mWall[index]));
         }
     }
+    const Body::Id wallId = world.AddBodies(bodyDef, wallPositions, ARRAY_SSIZE(wallPositions));
+    for (int i = 0; i < ARRAY_SSIZE(bodies.mWall); ++i)
+    {
+        bodies.mWall[i] = wallId + i;
+        assert(world.IsBodyIdValid(bodies.mWall[i]));
+    }
 
     constexpr f32 SPHERE_RADIUS = 0.2f;
     constexpr f32 SPHERE_DIAMETER = SPHERE_RADIUS * 2.0f;
@@ -475,6 +482,9 @@ int main()
 
     bool windowShouldClose = false;
 
+    sThreadPool.Init(SDL_GetNumLogicalCPUCores());
+    DEFER(sThreadPool.Shutdown());
+
     ResetWorld(sWorld, sBodies, TIME_STEP, false);
 
     u64 performanceCounter = SDL_GetPerformanceCounter();
@@ -628,13 +638,14 @@ int main()
             ImGuiTableRowStringFloat("Process input", gTimeMeters[TimeMeter::ProcessInput].GetUs());
             ImGuiTableRowStringFloat("Text draw", gTimeMeters[TimeMeter::UiDraw].GetUs());
             ImGuiTableRowStringFloat(
-                "Create HGrid",
-                gTimeMeters[TimeMeter::PhysicsCreateHGrid].GetUs()
+                "Update broad-phase",
+                gTimeMeters[TimeMeter::PhysicsUpdateBroadPhase].GetUs()
             );
             ImGuiTableRowStringFloat(
                 "Manifolds",
                 gTimeMeters[TimeMeter::PhysicsContactManifold].GetUs()
             );
+            ImGuiTableRowStringFloat("Islands", gTimeMeters[TimeMeter::PhysicsIslands].GetUs());
             ImGuiTableRowStringFloat(
                 "Inertias world",
                 gTimeMeters[TimeMeter::PhysicsInertiasWorld].GetUs()
@@ -652,6 +663,10 @@ int main()
                 "Integrate velocities",
                 gTimeMeters[TimeMeter::PhysicsIntegrateVelocities].GetUs()
             );
+            ImGuiTableRowStringFloat(
+                "Continuous",
+                gTimeMeters[TimeMeter::PhysicsContinuous].GetUs()
+            );
             ImGuiTableRowStringFloat("Physics", gTimeMeters[TimeMeter::Physics].GetUs());
             ImGuiTableRowStringFloat(
                 "New frame fence",
@@ -698,14 +713,21 @@ int main()
         {
             ImGui::TableNextRow();
             ImGui::TableNextColumn();
-            ImGui::Text("Manifolds load factor");
+            ImGui::Text("Manifolds capacity used");
 
             ImGui::TableNextColumn();
             ImGui::Text(
                 "%.2f\n",
-                static_cast<f64>(sWorld.GetContactManifoldsCount()) / PHYSICS_MAX_CONTACT_MANIFOLDS
+                static_cast<f64>(sWorld.GetContactManifoldsCount())
+                    / static_cast<f64>(sWorld.GetContactManifoldsCapacity())
             );
 
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("Awake bodies");
+            ImGui::TableNextColumn();
+            ImGui::Text("%d/%d", sWorld.GetAwakeBodiesCount(), sWorld.GetBodiesCount());
+
             ImGui::EndTable();
         }
 
@@ -0,0 +1,442 @@
+#pragma once
+
+#include "../Common.hpp"
+
+#include <math.h>
+#include <string.h>
+
+// Wide float, FLOAT_W_WIDTH lanes of f32 processed by one instruction.
+// AVX2 (8 lanes) when the compiler targets it, SSE2 (4 lanes) on x86-64 otherwise,
+// plain scalar code (4 lanes) on everything else.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FLOAT_W_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLOAT_W_SSE2
+#endif
+
+// SSE2 builds on x86-64 also have AVX2 kernels picked at run time, see FloatW8.hpp.
+#if defined(FLOAT_W_SSE2) && (defined(__x86_64__) || defined(_M_X64))
+#define FLOAT_W_DISPATCH_AVX2
+#endif
+
+#if defined(FLOAT_W_AVX2)
+static constexpr int FLOAT_W_WIDTH = 8;
+#else
+static constexpr int FLOAT_W_WIDTH = 4;
+#endif
+
+struct [[nodiscard]] alignas(FLOAT_W_WIDTH * sizeof(f32)) FloatW
+{
+    static constexpr int N = FLOAT_W_WIDTH;
+
+#if defined(FLOAT_W_AVX2)
+    __m256 mVal;
+#elif defined(FLOAT_W_SSE2)
+    __m128 mVal;
+#else
+    f32 mVal[N];
+#endif
+};
+
+[[nodiscard]]
+inline FloatW ZeroW()
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_setzero_ps()};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_setzero_ps()};
+#else
+    return {};
+#endif
+}
+
+[[nodiscard]]
+inline FloatW SplatW(f32 x)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_set1_ps(x)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_set1_ps(x)};
+#else
+    return {{x, x, x, x}};
+#endif
+}
+
+// src must be aligned to sizeof(FloatW).
+[[nodiscard]]
+inline FloatW LoadW(const f32* src)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_load_ps(src)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_load_ps(src)};
+#else
+    return {{src[0], src[1], src[2], src[3]}};
+#endif
+}
+
+[[nodiscard]]
+inline FloatW LoadUnalignedW(const f32* src)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_loadu_ps(src)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_loadu_ps(src)};
+#else
+    return {{src[0], src[1], src[2], src[3]}};
+#endif
+}
+
+// dst must be aligned to sizeof(FloatW).
+inline void StoreW(f32* dst, FloatW x)
+{
+#if defined(FLOAT_W_AVX2)
+    _mm256_store_ps(dst, x.mVal);
+#elif defined(FLOAT_W_SSE2)
+    _mm_store_ps(dst, x.mVal);
+#else
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        dst[i] = x.mVal[i];
+    }
+#endif
+}
+
+inline FloatW operator+(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_add_ps(a.mVal, b.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_add_ps(a.mVal, b.mVal)};
+#else
+    return {{a.mVal[0] + b.mVal[0],
+             a.mVal[1] + b.mVal[1],
+             a.mVal[2] + b.mVal[2],
+             a.mVal[3] + b.mVal[3]}};
+#endif
+}
+
+inline FloatW operator-(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_sub_ps(a.mVal, b.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_sub_ps(a.mVal, b.mVal)};
+#else
+    return {{a.mVal[0] - b.mVal[0],
+             a.mVal[1] - b.mVal[1],
+             a.mVal[2] - b.mVal[2],
+             a.mVal[3] - b.mVal[3]}};
+#endif
+}
+
+inline FloatW operator-(FloatW a)
+{
+    return ZeroW() - a;
+}
+
+inline FloatW operator*(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_mul_ps(a.mVal, b.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_mul_ps(a.mVal, b.mVal)};
+#else
+    return {{a.mVal[0] * b.mVal[0],
+             a.mVal[1] * b.mVal[1],
+             a.mVal[2] * b.mVal[2],
+             a.mVal[3] * b.mVal[3]}};
+#endif
+}
+
+inline FloatW& operator+=(FloatW& a, FloatW b)
+{
+    a = a + b;
+    return a;
+}
+
+inline FloatW& operator-=(FloatW& a, FloatW b)
+{
+    a = a - b;
+    return a;
+}
+
+[[nodiscard]]
+inline FloatW Min(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_min_ps(a.mVal, b.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_min_ps(a.mVal, b.mVal)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        res.mVal[i] = a.mVal[i] < b.mVal[i] ? a.mVal[i] : b.mVal[i];
+    }
+    return res;
+#endif
+}
+
+[[nodiscard]]
+inline FloatW Max(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_max_ps(a.mVal, b.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_max_ps(a.mVal, b.mVal)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        res.mVal[i] = a.mVal[i] > b.mVal[i] ? a.mVal[i] : b.mVal[i];
+    }
+    return res;
+#endif
+}
+
+[[nodiscard]]
+inline FloatW Clamp(FloatW x, FloatW min, FloatW max)
+{
+    return Min(Max(x, min), max);
+}
+
+// Lanes where b is 0 give 0 (padding lanes of constraint bundles).
+[[nodiscard]]
+inline FloatW SafeReciprocal(FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 mask = _mm256_cmp_ps(b.mVal, zero, _CMP_NEQ_OQ);
+    return {_mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), b.mVal), mask)};
+#elif defined(FLOAT_W_SSE2)
+    const __m128 mask = _mm_cmpneq_ps(b.mVal, _mm_setzero_ps());
+    return {_mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), b.mVal), mask)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        res.mVal[i] = b.mVal[i] != 0.0f ? 1.0f / b.mVal[i] : 0.0f;
+    }
+    return res;
+#endif
+}
+
+[[nodiscard]]
+inline FloatW SqrtW(FloatW x)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_sqrt_ps(x.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_sqrt_ps(x.mVal)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        res.mVal[i] = sqrtf(x.mVal[i]);
+    }
+    return res;
+#endif
+}
+
+// Comparison masks: all bits set in the lanes where the condition holds.
+
+[[nodiscard]]
+inline FloatW LessW(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_cmp_ps(a.mVal, b.mVal, _CMP_LT_OQ)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_cmplt_ps(a.mVal, b.mVal)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        const u32 bits = a.mVal[i] < b.mVal[i] ? UINT32_MAX : 0;
+        memcpy(&res.mVal[i], &bits, sizeof(f32));
+    }
+    return res;
+#endif
+}
+
+[[nodiscard]]
+inline FloatW LessEqualW(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_cmp_ps(a.mVal, b.mVal, _CMP_LE_OQ)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_cmple_ps(a.mVal, b.mVal)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        const u32 bits = a.mVal[i] <= b.mVal[i] ? UINT32_MAX : 0;
+        memcpy(&res.mVal[i], &bits, sizeof(f32));
+    }
+    return res;
+#endif
+}
+
+[[nodiscard]]
+inline FloatW AndW(FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_and_ps(a.mVal, b.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_and_ps(a.mVal, b.mVal)};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        u32 bitsA;
+        u32 bitsB;
+        memcpy(&bitsA, &a.mVal[i], sizeof(f32));
+        memcpy(&bitsB, &b.mVal[i], sizeof(f32));
+        bitsA &= bitsB;
+        memcpy(&res.mVal[i], &bitsA, sizeof(f32));
+    }
+    return res;
+#endif
+}
+
+// a in the lanes where the mask is set, b in the rest.
+[[nodiscard]]
+inline FloatW SelectW(FloatW mask, FloatW a, FloatW b)
+{
+#if defined(FLOAT_W_AVX2)
+    return {_mm256_blendv_ps(b.mVal, a.mVal, mask.mVal)};
+#elif defined(FLOAT_W_SSE2)
+    return {_mm_or_ps(_mm_and_ps(mask.mVal, a.mVal), _mm_andnot_ps(mask.mVal, b.mVal))};
+#else
+    FloatW res;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        u32 bits;
+        memcpy(&bits, &mask.mVal[i], sizeof(f32));
+        res.mVal[i] = bits ? a.mVal[i] : b.mVal[i];
+    }
+    return res;
+#endif
+}
+
+// Bit i is the sign bit of lane i.
+[[nodiscard]]
+inline int MoveMaskW(FloatW mask)
+{
+#if defined(FLOAT_W_AVX2)
+    return _mm256_movemask_ps(mask.mVal);
+#elif defined(FLOAT_W_SSE2)
+    return _mm_movemask_ps(mask.mVal);
+#else
+    int res = 0;
+    for (int i = 0; i < FloatW::N; ++i)
+    {
+        u32 bits;
+        memcpy(&bits, &mask.mVal[i], sizeof(f32));
+        res |= static_cast<int>(bits >> 31) << i;
+    }
+    return res;
+#endif
+}
+
+struct [[nodiscard]] Vec3W
+{
+    FloatW mX;
+    FloatW mY;
+    FloatW mZ;
+};
+
+inline Vec3W operator+(const Vec3W& a, const Vec3W& b)
+{
+    return {a.mX + b.mX, a.mY + b.mY, a.mZ + b.mZ};
+}
+
+inline Vec3W operator-(const Vec3W& a, const Vec3W& b)
+{
+    return {a.mX - b.mX, a.mY - b.mY, a.mZ - b.mZ};
+}
+
+inline Vec3W operator*(const Vec3W& a, FloatW s)
+{
+    return {a.mX * s, a.mY * s, a.mZ * s};
+}
+
+// Component-wise.
+inline Vec3W operator*(const Vec3W& a, const Vec3W& b)
+{
+    return {a.mX * b.mX, a.mY * b.mY, a.mZ * b.mZ};
+}
+
+inline Vec3W& operator+=(Vec3W& a, const Vec3W& b)
+{
+    a = a + b;
+    return a;
+}
+
+inline Vec3W& operator-=(Vec3W& a, const Vec3W& b)
+{
+    a = a - b;
+    return a;
+}
+
+[[nodiscard]]
+inline FloatW Dot(const Vec3W& a, const Vec3W& b)
+{
+    return a.mX * b.mX + a.mY * b.mY + a.mZ * b.mZ;
+}
+
+[[nodiscard]]
+inline Vec3W Cross(const Vec3W& a, const Vec3W& b)
+{
+    return {
+        a.mY * b.mZ - a.mZ * b.mY,
+        a.mZ * b.mX - a.mX * b.mZ,
+        a.mX * b.mY - a.mY * b.mX,
+    };
+}
+
+// Symmetric 3x3 matrix (inverse inertia tensors), only the upper triangle is stored.
+struct [[nodiscard]] SymMat3W
+{
+    FloatW mXX;
+    FloatW mXY;
+    FloatW mXZ;
+    FloatW mYY;
+    FloatW mYZ;
+    FloatW mZZ;
+};
+
+inline Vec3W operator*(const SymMat3W& m, const Vec3W& v)
+{
+    return {
+        m.mXX * v.mX + m.mXY * v.mY + m.mXZ * v.mZ,
+        m.mXY * v.mX + m.mYY * v.mY + m.mYZ * v.mZ,
+        m.mXZ * v.mX + m.mYZ * v.mY + m.mZZ * v.mZ,
+    };
+}
+
+// FloatW needed for count lanes.
+[[nodiscard]]
+inline int GetBlocksCountW(int count)
+{
+    return (count + FloatW::N - 1) / FloatW::N;
+}
+
+// Lane access for packing/unpacking, not meant for hot loops.
+[[nodiscard]]
+inline f32 GetLaneW(const FloatW& x, int lane)
+{
+    assert(lane >= 0 && lane < FloatW::N);
+    f32 res;
+    memcpy(&res, reinterpret_cast<const f32*>(&x) + lane, sizeof(f32));
+    return res;
+}
+
+inline void SetLaneW(FloatW& x, int lane, f32 value)
+{
+    assert(lane >= 0 && lane < FloatW::N);
+    memcpy(reinterpret_cast<f32*>(&x) + lane, &value, sizeof(f32));
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "FloatW.hpp"
+#include "Vec3.hpp"
+#include "Mat3.hpp"
+
+// 8 lanes of f32 for the kernels picked at run time on AVX2 CPUs, when the build itself
+// targets SSE2 (FLOAT_W_DISPATCH_AVX2). Everything here is compiled for AVX2 whatever the build
+// flags are, so it's only called from FLOAT_W8_TARGET functions after IsAvx2Supported().
+// The lanes are pairs of FloatW blocks, so the data keeps the FloatW layout.
+
+#if defined(FLOAT_W_DISPATCH_AVX2)
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define FLOAT_W8_TARGET
+#else
+#define FLOAT_W8_TARGET __attribute__((target("avx2")))
+#endif
+
+[[nodiscard]]
+inline bool IsAvx2Supported()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    // The OS saves the YMM registers (OSXSAVE, XCR0 bits 1 and 2).
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+struct [[nodiscard]] alignas(32) FloatW8
+{
+    static constexpr int N = 8;
+
+    __m256 mVal;
+};
+
+struct [[nodiscard]] Vec3W8
+{
+    FloatW8 mX;
+    FloatW8 mY;
+    FloatW8 mZ;
+};
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 ZeroW8()
+{
+    return {_mm256_setzero_ps()};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 SplatW8(f32 x)
+{
+    return {_mm256_set1_ps(x)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline Vec3W8 SplatW8(Vec3 v)
+{
+    return {SplatW8(v.X()), SplatW8(v.Y()), SplatW8(v.Z())};
+}
+
+// Lanes 0-3 from a, 4-7 from b.
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 CombineW8(FloatW a, FloatW b)
+{
+    return {_mm256_insertf128_ps(_mm256_castps128_ps256(a.mVal), b.mVal, 1)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline Vec3W8 CombineW8(const Vec3W& a, const Vec3W& b)
+{
+    return {CombineW8(a.mX, b.mX), CombineW8(a.mY, b.mY), CombineW8(a.mZ, b.mZ)};
+}
+
+FLOAT_W8_TARGET inline FloatW8 operator+(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_add_ps(a.mVal, b.mVal)};
+}
+
+FLOAT_W8_TARGET inline FloatW8 operator-(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_sub_ps(a.mVal, b.mVal)};
+}
+
+FLOAT_W8_TARGET inline FloatW8 operator-(FloatW8 a)
+{
+    return ZeroW8() - a;
+}
+
+FLOAT_W8_TARGET inline FloatW8 operator*(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_mul_ps(a.mVal, b.mVal)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 Min(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_min_ps(a.mVal, b.mVal)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 Max(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_max_ps(a.mVal, b.mVal)};
+}
+
+// Lanes where b is 0 give 0, like SafeReciprocal(FloatW).
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 SafeReciprocal(FloatW8 b)
+{
+    const __m256 mask = _mm256_cmp_ps(b.mVal, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+    return {_mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), b.mVal), mask)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 SqrtW(FloatW8 x)
+{
+    return {_mm256_sqrt_ps(x.mVal)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 LessW(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_cmp_ps(a.mVal, b.mVal, _CMP_LT_OQ)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 LessEqualW(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_cmp_ps(a.mVal, b.mVal, _CMP_LE_OQ)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 AndW(FloatW8 a, FloatW8 b)
+{
+    return {_mm256_and_ps(a.mVal, b.mVal)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 SelectW(FloatW8 mask, FloatW8 a, FloatW8 b)
+{
+    return {_mm256_blendv_ps(b.mVal, a.mVal, mask.mVal)};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline int MoveMaskW(FloatW8 mask)
+{
+    return _mm256_movemask_ps(mask.mVal);
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline f32 GetLaneW(const FloatW8& x, int lane)
+{
+    assert(lane >= 0 && lane < FloatW8::N);
+    f32 res;
+    memcpy(&res, reinterpret_cast<const f32*>(&x) + lane, sizeof(f32));
+    return res;
+}
+
+FLOAT_W8_TARGET inline Vec3W8 operator-(const Vec3W8& a, const Vec3W8& b)
+{
+    return {a.mX - b.mX, a.mY - b.mY, a.mZ - b.mZ};
+}
+
+FLOAT_W8_TARGET inline Vec3W8 operator*(const Vec3W8& a, FloatW8 s)
+{
+    return {a.mX * s, a.mY * s, a.mZ * s};
+}
+
+// Component-wise.
+FLOAT_W8_TARGET inline Vec3W8 operator*(const Vec3W8& a, const Vec3W8& b)
+{
+    return {a.mX * b.mX, a.mY * b.mY, a.mZ * b.mZ};
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline FloatW8 Dot(const Vec3W8& a, const Vec3W8& b)
+{
+    return a.mX * b.mX + a.mY * b.mY + a.mZ * b.mZ;
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline Vec3W8 Cross(const Vec3W8& a, const Vec3W8& b)
+{
+    return {
+        a.mY * b.mZ - a.mZ * b.mY,
+        a.mZ * b.mX - a.mX * b.mZ,
+        a.mX * b.mY - a.mY * b.mX,
+    };
+}
+
+[[nodiscard]]
+FLOAT_W8_TARGET inline Vec3W8 operator*(const Mat3& m, const Vec3W8& v)
+{
+    const Vec3W8 col0 = SplatW8(m.mCol[0]);
+    const Vec3W8 col1 = SplatW8(m.mCol[1]);
+    const Vec3W8 col2 = SplatW8(m.mCol[2]);
+    const Vec3W8 x = col0 * v.mX;
+    const Vec3W8 y = col1 * v.mY;
+    const Vec3W8 z = col2 * v.mZ;
+    return {x.mX + y.mX + z.mX, x.mY + y.mY + z.mY, x.mZ + y.mZ + z.mZ};
+}
+
+#endif
@@ -3,14 +3,26 @@
 #include "Config.hpp"
 #include "Geometry.hpp"
 #include "GJK.hpp"
-#include "../Renderer/Renderer.hpp"
+#include "../Arena.hpp"
 #include "../Math/Utils.hpp"
 #include "../Math/Vec3.hpp"
 #include "../Math/Mat3.hpp"
 #include "../Math/Quat.hpp"
+#include "../Math/FloatW8.hpp"
+
+#ifdef PHYSICS_DEBUG
+#include "../Renderer/Renderer.hpp"
+#endif
 
 #include <string.h>
 
+constexpr f32 LINEAR_SLOP = 0.005f;
+constexpr f32 RELATIVE_EDGE_TOLERANCE = 0.90f;
+constexpr f32 RELATIVE_FACE_TOLERANCE = 0.98f;
+constexpr f32 ABSOLUTE_TOLERANCE = 0.5f * LINEAR_SLOP;
+// Edges closer to parallel don't define a separating axis.
+constexpr f32 EDGE_PARALLEL_TOLERANCE = 0.005f;
+
 struct HullFaceQuery
 {
     int mFaceIndex;
@@ -24,18 +36,25 @@ struct HullEdgeQuery
     f32 mSeparation;
 };
 
+static void SatCacheSetAxis(SatCache& cache, u8 type, int index1, int index2, f32 separation)
+{
+    cache.mType = type;
+    cache.mIndex1 = index1;
+    cache.mIndex2 = index2;
+    cache.mSeparation = separation;
+}
+
+// Indices of the points kept.
 static int ReduceContactPoints(
-    ClipVertex out[4],
-    Vec3* positions,
-    FeatureId* featureIds,
-    f32* separations,
+    int out[ContactManifold::CONTACT_MAX_POINTS],
+    const Vec3* positions,
+    const f32* separations,
     int pointsCount,
     Vec3 pointsNormal
 )
 {
     assert(out);
     assert(positions);
-    assert(featureIds);
     assert(separations);
     assert(pointsCount >= ContactManifold::CONTACT_MAX_POINTS);
 
@@ -53,7 +72,7 @@ static int ReduceContactPoints(
 
     const Vec3 point1 = positions[index];
     int reducedCount = 0;
-    out[reducedCount++] = {positions[index], featureIds[index]};
+    out[reducedCount++] = index;
 
     tmp = -FLT_MAX;
     index = -1;
@@ -69,7 +88,7 @@ static int ReduceContactPoints(
     assert(index > -1);
 
     const Vec3 point2 = positions[index];
-    out[reducedCount++] = {positions[index], featureIds[index]};
+    out[reducedCount++] = index;
 
     index = -1;
     tmp = -FLT_MAX;
@@ -86,7 +105,7 @@ static int ReduceContactPoints(
     assert(index > -1);
 
     const Vec3 point3 = positions[index];
-    out[reducedCount++] = {positions[index], featureIds[index]};
+    out[reducedCount++] = index;
 
     index = -1;
     tmp = 0.0f; // Finding a minimum of negative values.
@@ -114,16 +133,134 @@ static int ReduceContactPoints(
     }
     assert(index > -1);
 
-    out[reducedCount++] = {positions[index], featureIds[index]};
+    out[reducedCount++] = index;
 
     return reducedCount;
 }
 
+// Small hulls: FloatW::N planes of the first hull at once, projected on every vertex of the
+// second one. The transform is from the local space of the first hull to the second.
+static HullFaceQuery HullQueryFacesFloatW(
+    const TransformMat& transform,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+)
+{
+    int maxIndex = -1;
+    f32 maxSeparation = -FLT_MAX;
+
+    const Vec3W translation = SplatW(transform.mTranslation);
+    const Vec3W inverseScale1
+        = SplatW(Vec3{1.0f / scale1.X(), 1.0f / scale1.Y(), 1.0f / scale1.Z()});
+    for (int i = 0; i < GetBlocksCountW(hull1.mFacesCount); ++i)
+    {
+        // Scale(), FloatW::N planes at once.
+        const Vec3W scaledNormal = hull1.mFacePlanesW[i].mNormal * inverseScale1;
+        const FloatW inverseLength = SafeReciprocal(SqrtW(Dot(scaledNormal, scaledNormal)));
+        const Vec3W normal = transform.mRotation * (scaledNormal * inverseLength);
+        const FloatW offset
+            = hull1.mFacePlanesW[i].mOffset * inverseLength + Dot(normal, translation);
+        // The support point along -normal is the vertex with the smallest projection.
+        FloatW minProjection = SplatW(FLT_MAX);
+        for (int j = 0; j < hull2.mVerticesCount; ++j)
+        {
+            const Vec3W vertex = SplatW(hull2.mVertexPositions[j] * scale2);
+            minProjection = Min(minProjection, Dot(normal, vertex));
+        }
+        const FloatW separation = minProjection - offset;
+        // Padding lanes repeat the last face, ties keep the first one.
+        if (MoveMaskW(LessW(SplatW(maxSeparation), separation)) == 0)
+        {
+            continue;
+        }
+        for (int lane = 0; lane < FloatW::N; ++lane)
+        {
+            const f32 laneSeparation = GetLaneW(separation, lane);
+            if (laneSeparation > maxSeparation)
+            {
+                maxIndex = i * FloatW::N + lane;
+                maxSeparation = laneSeparation;
+            }
+        }
+    }
+    assert(maxIndex > -1 && maxIndex < hull1.mFacesCount);
+
+    return {maxIndex, maxSeparation};
+}
+
+#if defined(FLOAT_W_DISPATCH_AVX2)
+// HullQueryFacesFloatW() on two blocks at a time, an odd last block is paired with itself.
+FLOAT_W8_TARGET static HullFaceQuery HullQueryFacesAvx2(
+    const TransformMat& transform,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+)
+{
+    int maxIndex = -1;
+    f32 maxSeparation = -FLT_MAX;
+
+    const Vec3W8 translation = SplatW8(transform.mTranslation);
+    const Vec3W8 inverseScale1
+        = SplatW8(Vec3{1.0f / scale1.X(), 1.0f / scale1.Y(), 1.0f / scale1.Z()});
+    const int blocksCount = GetBlocksCountW(hull1.mFacesCount);
+    for (int i = 0; i < blocksCount; i += 2)
+    {
+        const PlaneW& planes1 = hull1.mFacePlanesW[i];
+        const PlaneW& planes2 = hull1.mFacePlanesW[Min(i + 1, blocksCount - 1)];
+        const Vec3W8 scaledNormal = CombineW8(planes1.mNormal, planes2.mNormal) * inverseScale1;
+        const FloatW8 inverseLength = SafeReciprocal(SqrtW(Dot(scaledNormal, scaledNormal)));
+        const Vec3W8 normal = transform.mRotation * (scaledNormal * inverseLength);
+        const FloatW8 offset = CombineW8(planes1.mOffset, planes2.mOffset) * inverseLength
+                               + Dot(normal, translation);
+        FloatW8 minProjection = SplatW8(FLT_MAX);
+        for (int j = 0; j < hull2.mVerticesCount; ++j)
+        {
+            const Vec3W8 vertex = SplatW8(hull2.mVertexPositions[j] * scale2);
+            minProjection = Min(minProjection, Dot(normal, vertex));
+        }
+        const FloatW8 separation = minProjection - offset;
+        if (MoveMaskW(LessW(SplatW8(maxSeparation), separation)) == 0)
+        {
+            continue;
+        }
+        for (int lane = 0; lane < FloatW8::N; ++lane)
+        {
+            const f32 laneSeparation = GetLaneW(separation, lane);
+            if (laneSeparation > maxSeparation)
+            {
+                maxIndex = i * FloatW::N + lane;
+                maxSeparation = laneSeparation;
+            }
+        }
+    }
+    assert(maxIndex > -1 && maxIndex < hull1.mFacesCount);
+
+    return {maxIndex, maxSeparation};
+}
+#endif
+
+static HullFaceQuery (*sHullQueryFaces)(
+    const TransformMat& transform,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+) = HullQueryFacesFloatW;
+
+// supportIndex2 is the start of the support point search on the second hull, every face
+// starts where the previous one ended.
 static HullFaceQuery HullQueryFaceDirections(
     const TransformMat& transform1,
     const TransformMat& transform2,
     const ConvexHull& hull1,
-    const ConvexHull& hull2
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2,
+    int& supportIndex2
 )
 {
     // Transform from local space of first to second.
@@ -132,15 +269,17 @@ static HullFaceQuery HullQueryFaceDirections(
         TMul(transform2.mRotation, transform1.mTranslation - transform2.mTranslation)
     };
 
+    if (hull2.mVerticesCount < PHYSICS_HULL_HILL_CLIMBING_MIN_VERTICES)
+    {
+        return sHullQueryFaces(transform, hull1, hull2, scale1, scale2);
+    }
+
     int maxIndex = -1;
     f32 maxSeparation = -FLT_MAX;
-
-    const int faceCount1 = hull1.mFacesCount;
-
-    for (int i = 0; i < faceCount1; ++i)
+    for (int i = 0; i < hull1.mFacesCount; ++i)
     {
-        const Plane plane = Transform(transform, hull1.mFacePlanes[i]);
-        const f32 separation = Project(plane, hull2);
+        const Plane plane = Transform(transform, Scale(hull1.mFacePlanes[i], scale1));
+        const f32 separation = Project(plane, hull2, scale2, supportIndex2);
         if (separation > maxSeparation)
         {
             maxIndex = i;
@@ -152,6 +291,29 @@ static HullFaceQuery HullQueryFaceDirections(
     return {maxIndex, maxSeparation};
 }
 
+// Separation along one face of the first hull.
+static f32 HullQueryFaceDirection(
+    const TransformMat& transform1,
+    const TransformMat& transform2,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2,
+    int faceIndex,
+    int& supportIndex2
+)
+{
+    // Transform from local space of first to second.
+    const TransformMat transform{
+        TMul(transform2.mRotation, transform1.mRotation),
+        TMul(transform2.mRotation, transform1.mTranslation - transform2.mTranslation)
+    };
+
+    assert(faceIndex < hull1.mFacesCount);
+    const Plane plane = Transform(transform, Scale(hull1.mFacePlanes[faceIndex], scale1));
+    return Project(plane, hull2, scale2, supportIndex2);
+}
+
 static bool IsMinkowskiFace(Vec3 a, Vec3 b, Vec3 crossBA, Vec3 c, Vec3 d, Vec3 crossDC)
 {
     const f32 cba = Dot(c, crossBA);
@@ -164,12 +326,10 @@ static bool IsMinkowskiFace(Vec3 a, Vec3 b, Vec3 crossBA, Vec3 c, Vec3 d, Vec3 c
 
 static f32 Project(Vec3 p1, Vec3 e1, Vec3 p2, Vec3 e2, Vec3 c1)
 {
-    constexpr f32 TOLERANCE = 0.005f;
-
     const Vec3 crossE1E2 = Cross(e1, e2);
 
     const f32 l = Magnitude(crossE1E2);
-    if (l < TOLERANCE * sqrtf(MagnitudeSq(e1) * MagnitudeSq(e2)))
+    if (l < EDGE_PARALLEL_TOLERANCE * sqrtf(MagnitudeSq(e1) * MagnitudeSq(e2)))
     {
         return -FLT_MAX;
     }
@@ -183,11 +343,15 @@ static f32 Project(Vec3 p1, Vec3 e1, Vec3 p2, Vec3 e2, Vec3 c1)
     return Dot(n, p2 - p1);
 }
 
-static HullEdgeQuery HullQueryEdgeDirections(
+// Every edge of the first hull with every edge of the second one. The face normals are only
+// compared by sign, so they are scaled without normalizing.
+static HullEdgeQuery HullQueryEdgePairsFloatW(
     const TransformMat& transform1,
     const TransformMat& transform2,
     const ConvexHull& hull1,
-    const ConvexHull& hull2
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
 )
 {
     // Transform from local space of first to second.
@@ -196,48 +360,189 @@ static HullEdgeQuery HullQueryEdgeDirections(
         TMul(transform2.mRotation, transform1.mTranslation - transform2.mTranslation)
     };
 
-    const Vec3 c1 = Transform(transform, hull1.mCentroid);
+    const Vec3 c1 = Transform(transform, hull1.mCentroid * scale1);
+    const Vec3 inverseScale1 = {1.0f / scale1.X(), 1.0f / scale1.Y(), 1.0f / scale1.Z()};
+    const Vec3W scale2W = SplatW(scale2);
+    const Vec3W inverseScale2W
+        = SplatW(Vec3{1.0f / scale2.X(), 1.0f / scale2.Y(), 1.0f / scale2.Z()});
+
+    int maxIndex1 = -1;
+    int maxIndex2 = -1;
+    f32 maxSeparation = -FLT_MAX;
+
+    const int edgeCount1 = hull1.mHalfEdgesCount;
+    const int blocksCount2 = GetBlocksCountW(hull2.mHalfEdgesCount / 2);
+    const FloatW zero = ZeroW();
+    for (int i1 = 0; i1 < edgeCount1; i1 += 2)
+    {
+        const ConvexHull::HalfEdge edge1 = hull1.GetHalfEdge(i1);
+        const ConvexHull::HalfEdge twin1 = hull1.GetHalfEdge(i1 + 1);
+        assert(edge1.mTwin == i1 + 1 && twin1.mTwin == i1);
+
+        const Vec3 p1 = Transform(transform, hull1.mVertexPositions[edge1.mOrigin] * scale1);
+        const Vec3 q1 = Transform(transform, hull1.mVertexPositions[twin1.mOrigin] * scale1);
+        const Vec3 e1 = q1 - p1;
+
+        const Vec3 u1
+            = transform.mRotation * (hull1.mFacePlanes[edge1.mFace].mNormal * inverseScale1);
+        const Vec3 v1
+            = transform.mRotation * (hull1.mFacePlanes[twin1.mFace].mNormal * inverseScale1);
+
+        const Vec3W p1W = SplatW(p1);
+        const Vec3W e1W = SplatW(e1);
+        const Vec3W u1W = SplatW(u1);
+        const Vec3W v1W = SplatW(v1);
+        const Vec3W p1c1 = SplatW(p1 - c1);
+        const FloatW e1LengthSq = SplatW(MagnitudeSq(e1));
+
+        // FloatW::N edges of the second hull at once, the same math as IsMinkowskiFace(u1, v1,
+        // -e1, -u2, -v2, -e2) and Project(p1, e1, p2, e2, c1) with the signs cancelled out.
+        for (int i = 0; i < blocksCount2; ++i)
+        {
+            const EdgeW& edges2 = hull2.mEdgesW[i];
+            const Vec3W e2 = edges2.mDirection * scale2W;
+
+            const FloatW cba = Dot(edges2.mNormal1 * inverseScale2W, e1W);
+            const FloatW dba = Dot(edges2.mNormal2 * inverseScale2W, e1W);
+            const FloatW adc = Dot(u1W, e2);
+            const FloatW bdc = Dot(v1W, e2);
+            FloatW isValid = AndW(
+                AndW(LessW(cba * dba, zero), LessW(adc * bdc, zero)),
+                LessW(cba * bdc, zero)
+            );
+
+            // Parallel edges don't define an axis.
+            const Vec3W crossE1E2 = Cross(e1W, e2);
+            const FloatW l = SqrtW(Dot(crossE1E2, crossE1E2));
+            const FloatW minL = SplatW(EDGE_PARALLEL_TOLERANCE) * SqrtW(e1LengthSq * Dot(e2, e2));
+            isValid = AndW(isValid, LessEqualW(minL, l));
+            if (MoveMaskW(isValid) == 0)
+            {
+                continue;
+            }
+
+            const Vec3W n = crossE1E2 * SafeReciprocal(l);
+            FloatW separation = Dot(n, edges2.mOrigin * scale2W - p1W);
+            separation = SelectW(LessW(Dot(n, p1c1), zero), -separation, separation);
+            separation = SelectW(isValid, separation, SplatW(-FLT_MAX));
+
+            // Padding lanes repeat the last edge, ties keep the first one.
+            if (MoveMaskW(LessW(SplatW(maxSeparation), separation)) == 0)
+            {
+                continue;
+            }
+            for (int lane = 0; lane < FloatW::N; ++lane)
+            {
+                const f32 laneSeparation = GetLaneW(separation, lane);
+                if (laneSeparation > maxSeparation)
+                {
+                    maxIndex1 = i1;
+                    maxIndex2 = 2 * (i * FloatW::N + lane);
+                    maxSeparation = laneSeparation;
+                }
+            }
+        }
+    }
+
+    return {maxIndex1, maxIndex2, maxSeparation};
+}
+
+#if defined(FLOAT_W_DISPATCH_AVX2)
+// HullQueryEdgePairsFloatW() on two blocks at a time, an odd last block is paired with itself.
+FLOAT_W8_TARGET static HullEdgeQuery HullQueryEdgePairsAvx2(
+    const TransformMat& transform1,
+    const TransformMat& transform2,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+)
+{
+    const TransformMat transform{
+        TMul(transform2.mRotation, transform1.mRotation),
+        TMul(transform2.mRotation, transform1.mTranslation - transform2.mTranslation)
+    };
+
+    const Vec3 c1 = Transform(transform, hull1.mCentroid * scale1);
+    const Vec3 inverseScale1 = {1.0f / scale1.X(), 1.0f / scale1.Y(), 1.0f / scale1.Z()};
+    const Vec3W8 scale2W = SplatW8(scale2);
+    const Vec3W8 inverseScale2W
+        = SplatW8(Vec3{1.0f / scale2.X(), 1.0f / scale2.Y(), 1.0f / scale2.Z()});
 
     int maxIndex1 = -1;
     int maxIndex2 = -1;
     f32 maxSeparation = -FLT_MAX;
 
     const int edgeCount1 = hull1.mHalfEdgesCount;
-    const int edgeCount2 = hull2.mHalfEdgesCount;
+    const int blocksCount2 = GetBlocksCountW(hull2.mHalfEdgesCount / 2);
+    const FloatW8 zero = ZeroW8();
     for (int i1 = 0; i1 < edgeCount1; i1 += 2)
     {
-        const ConvexHull::HalfEdge edge1 = hull1.mHalfEdges[i1];
-        const ConvexHull::HalfEdge twin1 = hull1.mHalfEdges[i1 + 1];
+        const ConvexHull::HalfEdge edge1 = hull1.GetHalfEdge(i1);
+        const ConvexHull::HalfEdge twin1 = hull1.GetHalfEdge(i1 + 1);
         assert(edge1.mTwin == i1 + 1 && twin1.mTwin == i1);
 
-        const Vec3 p1 = Transform(transform, hull1.mVertexPositions[edge1.mOrigin]);
-        const Vec3 q1 = Transform(transform, hull1.mVertexPositions[twin1.mOrigin]);
+        const Vec3 p1 = Transform(transform, hull1.mVertexPositions[edge1.mOrigin] * scale1);
+        const Vec3 q1 = Transform(transform, hull1.mVertexPositions[twin1.mOrigin] * scale1);
         const Vec3 e1 = q1 - p1;
 
-        const Vec3 u1 = transform.mRotation * hull1.mFacePlanes[edge1.mFace].mNormal;
-        const Vec3 v1 = transform.mRotation * hull1.mFacePlanes[twin1.mFace].mNormal;
+        const Vec3 u1
+            = transform.mRotation * (hull1.mFacePlanes[edge1.mFace].mNormal * inverseScale1);
+        const Vec3 v1
+            = transform.mRotation * (hull1.mFacePlanes[twin1.mFace].mNormal * inverseScale1);
 
-        for (int i2 = 0; i2 < edgeCount2; i2 += 2)
+        const Vec3W8 p1W = SplatW8(p1);
+        const Vec3W8 e1W = SplatW8(e1);
+        const Vec3W8 u1W = SplatW8(u1);
+        const Vec3W8 v1W = SplatW8(v1);
+        const Vec3W8 p1c1 = SplatW8(p1 - c1);
+        const FloatW8 e1LengthSq = SplatW8(MagnitudeSq(e1));
+
+        for (int i = 0; i < blocksCount2; i += 2)
         {
-            const ConvexHull::HalfEdge edge2 = hull2.mHalfEdges[i2];
-            const ConvexHull::HalfEdge twin2 = hull2.mHalfEdges[i2 + 1];
-            assert(edge2.mTwin == i2 + 1 && twin2.mTwin == i2);
+            const EdgeW& edgesA = hull2.mEdgesW[i];
+            const EdgeW& edgesB = hull2.mEdgesW[Min(i + 1, blocksCount2 - 1)];
+            const Vec3W8 e2 = CombineW8(edgesA.mDirection, edgesB.mDirection) * scale2W;
+            const Vec3W8 normal1 = CombineW8(edgesA.mNormal1, edgesB.mNormal1);
+            const Vec3W8 normal2 = CombineW8(edgesA.mNormal2, edgesB.mNormal2);
+
+            const FloatW8 cba = Dot(normal1 * inverseScale2W, e1W);
+            const FloatW8 dba = Dot(normal2 * inverseScale2W, e1W);
+            const FloatW8 adc = Dot(u1W, e2);
+            const FloatW8 bdc = Dot(v1W, e2);
+            FloatW8 isValid = AndW(
+                AndW(LessW(cba * dba, zero), LessW(adc * bdc, zero)),
+                LessW(cba * bdc, zero)
+            );
 
-            const Vec3 p2 = hull2.mVertexPositions[edge2.mOrigin];
-            const Vec3 q2 = hull2.mVertexPositions[twin2.mOrigin];
-            const Vec3 e2 = q2 - p2;
+            const Vec3W8 crossE1E2 = Cross(e1W, e2);
+            const FloatW8 l = SqrtW(Dot(crossE1E2, crossE1E2));
+            const FloatW8 minL
+                = SplatW8(EDGE_PARALLEL_TOLERANCE) * SqrtW(e1LengthSq * Dot(e2, e2));
+            isValid = AndW(isValid, LessEqualW(minL, l));
+            if (MoveMaskW(isValid) == 0)
+            {
+                continue;
+            }
 
-            const Vec3 u2 = hull2.mFacePlanes[edge2.mFace].mNormal;
-            const Vec3 v2 = hull2.mFacePlanes[twin2.mFace].mNormal;
+            const Vec3W8 n = crossE1E2 * SafeReciprocal(l);
+            const Vec3W8 origin2 = CombineW8(edgesA.mOrigin, edgesB.mOrigin) * scale2W;
+            FloatW8 separation = Dot(n, origin2 - p1W);
+            separation = SelectW(LessW(Dot(n, p1c1), zero), -separation, separation);
+            separation = SelectW(isValid, separation, SplatW8(-FLT_MAX));
 
-            if (IsMinkowskiFace(u1, v1, -e1, -u2, -v2, -e2))
+            if (MoveMaskW(LessW(SplatW8(maxSeparation), separation)) == 0)
             {
-                const f32 separation = Project(p1, e1, p2, e2, c1);
-                if (separation > maxSeparation)
+                continue;
+            }
+            for (int lane = 0; lane < FloatW8::N; ++lane)
+            {
+                const f32 laneSeparation = GetLaneW(separation, lane);
+                if (laneSeparation > maxSeparation)
                 {
                     maxIndex1 = i1;
-                    maxIndex2 = i2;
-                    maxSeparation = separation;
+                    maxIndex2 = 2 * (i * FloatW::N + lane);
+                    maxSeparation = laneSeparation;
                 }
             }
         }
@@ -245,17 +550,229 @@ static HullEdgeQuery HullQueryEdgeDirections(
 
     return {maxIndex1, maxIndex2, maxSeparation};
 }
+#endif
+
+static HullEdgeQuery (*sHullQueryEdgePairs)(
+    const TransformMat& transform1,
+    const TransformMat& transform2,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+) = HullQueryEdgePairsFloatW;
+
+void InitCollideKernels(bool isAvx2)
+{
+#if defined(FLOAT_W_DISPATCH_AVX2)
+    sHullQueryFaces = isAvx2 ? HullQueryFacesAvx2 : HullQueryFacesFloatW;
+    sHullQueryEdgePairs = isAvx2 ? HullQueryEdgePairsAvx2 : HullQueryEdgePairsFloatW;
+#endif
+    InitGeometryKernels(isAvx2);
+}
+
+// Edges of the direction whose arcs hold the axis and its opposite, -1 if there are none. The
+// axis is in the unscaled local space, where the arcs are.
+static void FindArcEdges(
+    const ConvexHull& hull,
+    const EdgeDirection& direction,
+    Vec3 axis,
+    int& plusIndex,
+    int& minusIndex
+)
+{
+    plusIndex = -1;
+    minusIndex = -1;
+    const int lastEdge = direction.mFirstEdge + direction.mEdgesCount;
+    for (int i = direction.mFirstEdge; i < lastEdge && (plusIndex < 0 || minusIndex < 0); ++i)
+    {
+        const DirectionEdge& edge = hull.mDirectionEdges[i];
+        const f32 start = Dot(axis, edge.mArcStart);
+        const f32 end = Dot(axis, edge.mArcEnd);
+        if (plusIndex < 0 && start >= 0.0f && end >= 0.0f)
+        {
+            plusIndex = edge.mEdgeIndex;
+        }
+        else if (minusIndex < 0 && start <= 0.0f && end <= 0.0f)
+        {
+            minusIndex = edge.mEdgeIndex;
+        }
+    }
+}
+
+// Every direction of the first hull with every direction of the second one. The cross product
+// of two directions is the only axis they can build, its two signs are looked up on the Gauss
+// maps, where the second hull is negated, and the edges found are projected like in
+// HullQueryEdgePairsFloatW(). A scale maps the normals, and so the arcs, by its inverse, the axis
+// is mapped back to the unscaled arcs by the scale.
+static HullEdgeQuery HullQueryUniqueEdgeDirections(
+    const TransformMat& transform1,
+    const TransformMat& transform2,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+)
+{
+    // Transform from local space of first to second.
+    const TransformMat transform{
+        TMul(transform2.mRotation, transform1.mRotation),
+        TMul(transform2.mRotation, transform1.mTranslation - transform2.mTranslation)
+    };
+
+    const Vec3 c1 = Transform(transform, hull1.mCentroid * scale1);
+
+    int maxIndex1 = -1;
+    int maxIndex2 = -1;
+    f32 maxSeparation = -FLT_MAX;
+
+    const auto project = [&](int edgeIndex1, int edgeIndex2)
+    {
+        const Vec3 p1 = Transform(transform, hull1.GetOrigin(edgeIndex1) * scale1);
+        const Vec3 q1 = Transform(transform, hull1.GetTarget(edgeIndex1) * scale1);
+        const Vec3 p2 = hull2.GetOrigin(edgeIndex2) * scale2;
+        const Vec3 q2 = hull2.GetTarget(edgeIndex2) * scale2;
+        const f32 separation = Project(p1, q1 - p1, p2, q2 - p2, c1);
+        if (separation > maxSeparation)
+        {
+            maxIndex1 = edgeIndex1;
+            maxIndex2 = edgeIndex2;
+            maxSeparation = separation;
+        }
+    };
+
+    for (int i1 = 0; i1 < hull1.mEdgeDirectionsCount; ++i1)
+    {
+        const EdgeDirection& direction1 = hull1.mEdgeDirections[i1];
+        const Vec3 d1 = transform.mRotation * (direction1.mDirection * scale1);
+        const f32 d1LengthSq = MagnitudeSq(d1);
+        for (int i2 = 0; i2 < hull2.mEdgeDirectionsCount; ++i2)
+        {
+            const EdgeDirection& direction2 = hull2.mEdgeDirections[i2];
+            const Vec3 d2 = direction2.mDirection * scale2;
+
+            // Parallel directions don't define an axis.
+            const Vec3 axis = Cross(d1, d2);
+            const f32 minLengthSq = Square(EDGE_PARALLEL_TOLERANCE) * d1LengthSq * MagnitudeSq(d2);
+            if (MagnitudeSq(axis) < minLengthSq)
+            {
+                continue;
+            }
+
+            int plusIndex1;
+            int minusIndex1;
+            FindArcEdges(
+                hull1,
+                direction1,
+                TMul(transform.mRotation, axis) * scale1,
+                plusIndex1,
+                minusIndex1
+            );
+            if (plusIndex1 < 0 && minusIndex1 < 0)
+            {
+                continue;
+            }
+            int plusIndex2;
+            int minusIndex2;
+            FindArcEdges(hull2, direction2, axis * scale2, plusIndex2, minusIndex2);
+
+            if (plusIndex1 >= 0 && minusIndex2 >= 0)
+            {
+                project(plusIndex1, minusIndex2);
+            }
+            if (minusIndex1 >= 0 && plusIndex2 >= 0)
+            {
+                project(minusIndex1, plusIndex2);
+            }
+        }
+    }
+
+    return {maxIndex1, maxIndex2, maxSeparation};
+}
+
+// Pairs of directions are scalar and pairs of edges FloatW::N at once, so the directions are
+// used when they are fewer, e.g. 9 pairs instead of 144 for two boxes.
+static HullEdgeQuery HullQueryEdgeDirections(
+    const TransformMat& transform1,
+    const TransformMat& transform2,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2
+)
+{
+    const int directionPairsCount = hull1.mEdgeDirectionsCount * hull2.mEdgeDirectionsCount;
+    const int edgePairsCount = (hull1.mHalfEdgesCount / 2) * (hull2.mHalfEdgesCount / 2);
+    if (directionPairsCount * FloatW::N <= edgePairsCount)
+    {
+        return HullQueryUniqueEdgeDirections(transform1, transform2, hull1, hull2, scale1, scale2);
+    }
+    return sHullQueryEdgePairs(transform1, transform2, hull1, hull2, scale1, scale2);
+}
+
+// Separation along the cross product of two edges, -FLT_MAX if they don't build a face of the
+// Minkowski difference.
+static f32 HullQueryEdgeDirection(
+    const TransformMat& transform1,
+    const TransformMat& transform2,
+    const ConvexHull& hull1,
+    const ConvexHull& hull2,
+    Vec3 scale1,
+    Vec3 scale2,
+    int edgeIndex1,
+    int edgeIndex2
+)
+{
+    // Transform from local space of first to second.
+    const TransformMat transform{
+        TMul(transform2.mRotation, transform1.mRotation),
+        TMul(transform2.mRotation, transform1.mTranslation - transform2.mTranslation)
+    };
+
+    assert(edgeIndex1 + 1 < hull1.mHalfEdgesCount);
+    assert(edgeIndex2 + 1 < hull2.mHalfEdgesCount);
+    const ConvexHull::HalfEdge edge1 = hull1.GetHalfEdge(edgeIndex1);
+    const ConvexHull::HalfEdge twin1 = hull1.GetHalfEdge(edgeIndex1 + 1);
+    const ConvexHull::HalfEdge edge2 = hull2.GetHalfEdge(edgeIndex2);
+    const ConvexHull::HalfEdge twin2 = hull2.GetHalfEdge(edgeIndex2 + 1);
+
+    const Vec3 inverseScale1 = {1.0f / scale1.X(), 1.0f / scale1.Y(), 1.0f / scale1.Z()};
+    const Vec3 inverseScale2 = {1.0f / scale2.X(), 1.0f / scale2.Y(), 1.0f / scale2.Z()};
+
+    const Vec3 p1 = Transform(transform, hull1.mVertexPositions[edge1.mOrigin] * scale1);
+    const Vec3 q1 = Transform(transform, hull1.mVertexPositions[twin1.mOrigin] * scale1);
+    const Vec3 e1 = q1 - p1;
+    const Vec3 u1
+        = transform.mRotation * (hull1.mFacePlanes[edge1.mFace].mNormal * inverseScale1);
+    const Vec3 v1
+        = transform.mRotation * (hull1.mFacePlanes[twin1.mFace].mNormal * inverseScale1);
+
+    const Vec3 p2 = hull2.mVertexPositions[edge2.mOrigin] * scale2;
+    const Vec3 q2 = hull2.mVertexPositions[twin2.mOrigin] * scale2;
+    const Vec3 e2 = q2 - p2;
+    const Vec3 u2 = hull2.mFacePlanes[edge2.mFace].mNormal * inverseScale2;
+    const Vec3 v2 = hull2.mFacePlanes[twin2.mFace].mNormal * inverseScale2;
+
+    if (!IsMinkowskiFace(u1, v1, -e1, -u2, -v2, -e2))
+    {
+        return -FLT_MAX;
+    }
+    return Project(p1, e1, p2, e2, Transform(transform, hull1.mCentroid * scale1));
+}
 
+// The output holds outCapacity vertices, at least one more than the input.
 static int ClipPolygon(
-    ClipVertex out[255],
-    const ClipVertex in[255],
+    ClipVertex* out,
+    int outCapacity,
+    const ClipVertex* in,
     int inCount,
     Plane plane,
-    u8 planeEdgeIndex
+    u16 planeEdgeIndex
 )
 {
     assert(out);
     assert(inCount >= 3);
+    assert(inCount < outCapacity);
+    (void)outCapacity;
 
     ClipVertex vertex1 = in[inCount - 1];
     f32 distance1 = Distance(plane, vertex1.mPosition);
@@ -270,13 +787,13 @@ static int ClipPolygon(
         if (distance1 <= 0.0f && distance2 <= 0.0f)
         {
             // Both vertices are behind the plane => keep vertex2.
-            assert(outCount < 255);
+            assert(outCount < outCapacity);
             out[outCount++] = vertex2;
         }
         else if (distance1 <= 0.0f && distance2 > 0.0f)
         {
             // Vertex1 behind, vertex2 in front => intersection point.
-            assert(outCount < 255);
+            assert(outCount < outCapacity);
             out[outCount].mFeatureId.mInHalfEdgeR = FeatureId::EDGE_NULL;
             out[outCount].mFeatureId.mInHalfEdgeI = vertex1.mFeatureId.mOutHalfEdgeI;
             out[outCount].mFeatureId.mOutHalfEdgeR = planeEdgeIndex;
@@ -289,7 +806,7 @@ static int ClipPolygon(
         else if (distance2 <= 0.0f && distance1 > 0.0f)
         {
             // Vertex2 behind, vertex1 in front => intersection and vertex2.
-            assert(outCount < 254);
+            assert(outCount + 1 < outCapacity);
 
             out[outCount].mFeatureId.mInHalfEdgeR = planeEdgeIndex;
             out[outCount].mFeatureId.mInHalfEdgeI = FeatureId::EDGE_NULL;
@@ -311,27 +828,82 @@ static int ClipPolygon(
     return outCount;
 }
 
+// The points of the clipped incident face below the reference face, projected onto it and
+// reduced to ContactManifold::CONTACT_MAX_POINTS. The buffers hold clippedCount elements.
+static int BuildFaceContactPoints(
+    ContactManifold& manifold,
+    const ClipVertex* clipped,
+    int clippedCount,
+    Plane referenceFacePlane,
+    bool flipNormal,
+    f32* separations,
+    Vec3* positions,
+    FeatureId* featureIds
+)
+{
+    int pointsCount = 0;
+    for (int i = 0; i < clippedCount; ++i)
+    {
+        const f32 d = Distance(referenceFacePlane, clipped[i].mPosition);
+        if (d <= 0.0f)
+        {
+            separations[pointsCount] = d;
+            positions[pointsCount] = clipped[i].mPosition - d * referenceFacePlane.mNormal;
+            featureIds[pointsCount] = clipped[i].mFeatureId;
+            ++pointsCount;
+        }
+    }
+
+    const Vec3 normal = flipNormal ? -referenceFacePlane.mNormal : referenceFacePlane.mNormal;
+
+    int indices[ContactManifold::CONTACT_MAX_POINTS]{0, 1, 2, 3};
+    int contactsCount = pointsCount;
+    if (pointsCount > ContactManifold::CONTACT_MAX_POINTS)
+    {
+        contactsCount = ReduceContactPoints(indices, positions, separations, pointsCount, normal);
+    }
+    assert(contactsCount <= ContactManifold::CONTACT_MAX_POINTS);
+
+    manifold.mNormal = normal;
+    for (int i = 0; i < contactsCount; ++i)
+    {
+        ContactPoint& contact = manifold.mContacts[i];
+        contact.mPosition = positions[indices[i]];
+        contact.mSeparation = separations[indices[i]];
+        contact.mFeatureId = featureIds[indices[i]];
+        if (flipNormal)
+        {
+            contact.mFeatureId.Flip();
+        }
+    }
+
+    return contactsCount;
+}
+
 static int HullBuildFaceContact(
     ContactManifold& manifold,
     const TransformMat& transform1,
     const ConvexHull& hull1,
+    Vec3 scale1,
     const TransformMat& transform2,
     const ConvexHull& hull2,
+    Vec3 scale2,
     HullFaceQuery query,
-    bool flipNormal
+    bool flipNormal,
+    Arena& scratch
 )
 {
-    const u8 referenceFaceIndex = static_cast<u8>(query.mFaceIndex);
-    const Plane referenceFacePlane = Transform(transform1, hull1.mFacePlanes[referenceFaceIndex]);
-    const Vec3 referenceFaceNormal
-        = transform1.mRotation * hull1.mFacePlanes[referenceFaceIndex].mNormal;
+    const int referenceFaceIndex = query.mFaceIndex;
+    const Plane referenceFacePlane
+        = Transform(transform1, Scale(hull1.mFacePlanes[referenceFaceIndex], scale1));
+    const Vec3 referenceFaceNormal = referenceFacePlane.mNormal;
 
     const int hullFacesCount2 = hull2.mFacesCount;
     f32 minDotNormals = FLT_MAX;
     int incidentFaceIndex = -1;
     for (int i = 0; i < hullFacesCount2; ++i)
     {
-        const Vec3 normal = transform2.mRotation * hull2.mFacePlanes[i].mNormal;
+        const Vec3 normal = transform2.mRotation * Scale(hull2.mFacePlanes[i], scale2).mNormal;
         const f32 dotNormals = Dot(normal, referenceFaceNormal);
         if (dotNormals < minDotNormals)
         {
@@ -342,25 +914,23 @@ static int HullBuildFaceContact(
 
     assert(incidentFaceIndex > -1);
 
-    Vec3 referenceVertices[255];
-    const int referenceVerticesCount = hull1.GetVertices(referenceVertices, referenceFaceIndex);
+    // Every side plane adds at most one vertex to the clipped polygon.
+    const int sidePlanesCapacity = hull1.mMaxFaceVerticesCount;
+    const int clipCapacity = hull2.mMaxFaceVerticesCount + sidePlanesCapacity;
+    Plane* const referenceSidePlanes
+        = scratch.AllocOrDie<Plane>(sidePlanesCapacity, Arena::FlagNoZero);
+    u16* const referenceSidePlanesEdgeIndices
+        = scratch.AllocOrDie<u16>(sidePlanesCapacity, Arena::FlagNoZero);
+    ClipVertex* clipped = scratch.AllocOrDie<ClipVertex>(clipCapacity, Arena::FlagNoZero);
+    ClipVertex* clipped2 = scratch.AllocOrDie<ClipVertex>(clipCapacity, Arena::FlagNoZero);
 
-    for (int i = 0; i < referenceVerticesCount; ++i)
-    {
-        referenceVertices[i] = Transform(transform1, referenceVertices[i]);
-    }
-
-    ClipVertex incidentVertices[255];
-    const int incidentVerticesCount
-        = hull2.GetClipVertices(incidentVertices, static_cast<u8>(incidentFaceIndex));
+    const int incidentVerticesCount = hull2.GetClipVertices(clipped2, incidentFaceIndex);
 
     for (int i = 0; i < incidentVerticesCount; ++i)
     {
-        incidentVertices[i].mPosition = Transform(transform2, incidentVertices[i].mPosition);
+        clipped2[i].mPosition = Transform(transform2, clipped2[i].mPosition * scale2);
     }
 
-    Plane referenceSidePlanes[255];
-    u8 referenceSidePlanesEdgeIndices[255];
     const int referenceSidePlanesCount = hull1.GetSidePlanes(
         referenceSidePlanes,
         referenceSidePlanesEdgeIndices,
@@ -369,22 +939,16 @@ static int HullBuildFaceContact(
 
     for (int i = 0; i < referenceSidePlanesCount; ++i)
     {
-        referenceSidePlanes[i] = Transform(transform1, referenceSidePlanes[i]);
+        referenceSidePlanes[i] = Transform(transform1, Scale(referenceSidePlanes[i], scale1));
     }
 
-    ClipVertex clipped[255];
-    ClipVertex clipped2[255];
-    static_assert(sizeof(clipped) == sizeof(clipped2));
-
-    static_assert(sizeof(incidentVertices) == sizeof(clipped2));
-    memcpy(clipped2, incidentVertices, sizeof(clipped2));
-
     int clippedCount = incidentVerticesCount;
 
     for (int i = 0; i < referenceSidePlanesCount; ++i)
     {
         clippedCount = ClipPolygon(
             clipped,
+            clipCapacity,
             clipped2,
             clippedCount,
             referenceSidePlanes[i],
@@ -394,82 +958,41 @@ static int HullBuildFaceContact(
         {
             return 0;
         }
-        memcpy(clipped2, clipped, sizeof(clipped2));
-    }
-
-    // Discard clipped points above the reference face.
-    int outCount = 0;
-    f32 separations[255];
-    Vec3 positions[255];
-    FeatureId featureIds[255];
-    for (int i = 0; i < clippedCount; ++i)
-    {
-        const f32 d = Distance(referenceFacePlane, clipped[i].mPosition);
-        if (d <= 0.0f)
-        {
-            separations[outCount] = d;
-            positions[outCount] = clipped[i].mPosition;
-            featureIds[outCount] = clipped[i].mFeatureId;
-            ++outCount;
-        }
-    }
-
-    for (int i = 0; i < outCount; ++i)
-    {
-        positions[i] -= separations[i] * referenceFaceNormal;
-    }
-
-    const Vec3 normal = flipNormal ? -referenceFaceNormal : referenceFaceNormal;
-
-    for (int i = 0; i < outCount; ++i)
-    {
-        clipped[i].mPosition = positions[i];
-        clipped[i].mFeatureId = featureIds[i];
-    }
-
-    if (outCount > ContactManifold::CONTACT_MAX_POINTS)
-    {
-        outCount
-            = ReduceContactPoints(clipped, positions, featureIds, separations, outCount, normal);
-    }
-
-    assert(outCount <= ContactManifold::CONTACT_MAX_POINTS);
-
-    if (flipNormal)
-    {
-        for (int i = 0; i < outCount; ++i)
-        {
-            clipped[i].mFeatureId.Flip();
-        }
+        Swap(clipped, clipped2);
     }
-
-    manifold.mNormal = normal;
-    int contactsCount = 0;
-    for (int i = 0; i < outCount; ++i)
-    {
-        manifold.mContacts[contactsCount].mPosition = clipped[i].mPosition;
-        manifold.mContacts[contactsCount].mSeparation = separations[i];
-        manifold.mContacts[contactsCount].mFeatureId = clipped[i].mFeatureId;
-        ++contactsCount;
-    }
-
-    return contactsCount;
+    // The last output is in clipped2.
+
+    f32* const separations = scratch.AllocOrDie<f32>(clippedCount, Arena::FlagNoZero);
+    Vec3* const positions = scratch.AllocOrDie<Vec3>(clippedCount, Arena::FlagNoZero);
+    FeatureId* const featureIds = scratch.AllocOrDie<FeatureId>(clippedCount, Arena::FlagNoZero);
+    return BuildFaceContactPoints(
+        manifold,
+        clipped2,
+        clippedCount,
+        referenceFacePlane,
+        flipNormal,
+        separations,
+        positions,
+        featureIds
+    );
 }
 
 static int HullBuildEdgeContact(
     ContactManifold& manifold,
     const TransformMat& transform1,
     const ConvexHull& hull1,
+    Vec3 scale1,
     const TransformMat& transform2,
     const ConvexHull& hull2,
+    Vec3 scale2,
     HullEdgeQuery query
 )
 {
-    const Vec3 p1 = Transform(transform1, hull1.GetOrigin(static_cast<u8>(query.mEdgeIndex1)));
-    const Vec3 q1 = Transform(transform1, hull1.GetTarget(static_cast<u8>(query.mEdgeIndex1)));
+    const Vec3 p1 = Transform(transform1, hull1.GetOrigin(query.mEdgeIndex1) * scale1);
+    const Vec3 q1 = Transform(transform1, hull1.GetTarget(query.mEdgeIndex1) * scale1);
 
-    const Vec3 p2 = Transform(transform2, hull2.GetOrigin(static_cast<u8>(query.mEdgeIndex2)));
-    const Vec3 q2 = Transform(transform2, hull2.GetTarget(static_cast<u8>(query.mEdgeIndex2)));
+    const Vec3 p2 = Transform(transform2, hull2.GetOrigin(query.mEdgeIndex2) * scale2);
+    const Vec3 q2 = Transform(transform2, hull2.GetTarget(query.mEdgeIndex2) * scale2);
 
     const Vec3 segment1 = q1 - p1;
     const Vec3 segment2 = q2 - p2;
@@ -498,7 +1021,7 @@ static int HullBuildEdgeContact(
 
     normal = Normalize(normal);
 
-    if (Dot(normal, p1 - Transform(transform1, hull1.mCentroid)) < 0.0f)
+    if (Dot(normal, p1 - Transform(transform1, hull1.mCentroid * scale1)) < 0.0f)
     {
         normal = -normal;
     }
@@ -506,9 +1029,9 @@ static int HullBuildEdgeContact(
     manifold.mNormal = normal;
     manifold.mContacts[0].mPosition = (c1 + c2) / 2.0f;
     manifold.mContacts[0].mSeparation = Dot(normal, p2 - p1);
-    manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u8>(query.mEdgeIndex1);
+    manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u16>(query.mEdgeIndex1);
     manifold.mContacts[0].mFeatureId.mOutHalfEdgeR = FeatureId::EDGE_NULL;
-    manifold.mContacts[0].mFeatureId.mInHalfEdgeI = static_cast<u8>(query.mEdgeIndex2);
+    manifold.mContacts[0].mFeatureId.mInHalfEdgeI = static_cast<u16>(query.mEdgeIndex2);
     manifold.mContacts[0].mFeatureId.mOutHalfEdgeI = FeatureId::EDGE_NULL;
 
     return 1;
@@ -516,12 +1039,16 @@ static int HullBuildEdgeContact(
 
 static void CollideSphereSphere(
     ContactManifold& manifold,
+    SatCache& cache,
     const World& world,
     const Body& sphere1,
-    const Body& sphere2
+    const Body& sphere2,
+    Arena& scratch
 )
 {
+    (void)cache;
     (void)world;
+    (void)scratch;
 
     const f32 sumRadii = sphere1.mRadius + sphere2.mRadius;
     const Vec3 translation = sphere2.mPosition - sphere1.mPosition;
@@ -550,32 +1077,34 @@ static void CollideSphereSphere(
 
 static void CollideSphereConvexHull(
     ContactManifold& manifold,
+    SatCache& cache,
     const World& world,
     const Body& sphere,
-    const Body& hull
+    const Body& hull,
+    Arena& scratch
 )
 {
+    (void)cache;
+    (void)scratch;
+
     const Slice<ConvexHull> convexHulls = world.GetConvexHulls();
     assert(hull.mConvexHull.mId < convexHulls.mCount);
     const ConvexHull& convexHull = convexHulls.mData[hull.mConvexHull.mId];
+    const Vec3 scale = hull.mConvexHull.mScale;
     const TransformMat hullLocalToWorld{ToMat3(hull.mOrientation), hull.mPosition};
     const Vec3 spherePositionHullLocal = InverseTransform(hullLocalToWorld, sphere.mPosition);
     const f32 sphereRadius = sphere.mRadius;
 
     GjkSupport support{};
-    support.mA = convexHull.mVertexPositions[0];
+    support.mA = convexHull.mVertexPositions[0] * scale;
     support.mB = spherePositionHullLocal;
 
     GjkSimplex simplex{};
 
     while (Gjk(simplex, support))
     {
-        support.mIdA = GetSupportPointIndex(
-            convexHull.mVertexPositions,
-            convexHull.mVerticesCount,
-            support.mDirectionA
-        );
-        support.mA = convexHull.mVertexPositions[support.mIdA];
+        support.mIdA = convexHull.GetSupportPointIndex(support.mDirectionA * scale, support.mIdA);
+        support.mA = convexHull.mVertexPositions[support.mIdA] * scale;
     }
 
     GjkResult result{};
@@ -596,7 +1125,7 @@ static void CollideSphereConvexHull(
             manifold.mContacts[0].mSeparation = distance - sphereRadius;
             manifold.mContacts[0].mFeatureId = {};
             // TODO: it seems to uniquely identify the contact but idk.
-            manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u8>(support.mIdA);
+            manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u16>(support.mIdA);
             manifold.mContactsCount = 1;
             return;
         }
@@ -617,7 +1146,7 @@ static void CollideSphereConvexHull(
     Plane minFace{};
     for (int i = 0; i < hullFacesCount; ++i)
     {
-        const Plane plane = Transform(hullLocalToWorld, convexHull.mFacePlanes[i]);
+        const Plane plane = Transform(hullLocalToWorld, Scale(convexHull.mFacePlanes[i], scale));
         const f32 d = Distance(plane, sphere.mPosition);
         if (d > minDistance)
         {
@@ -633,63 +1162,582 @@ static void CollideSphereConvexHull(
     manifold.mContacts[0].mSeparation = minDistance - sphereRadius;
     manifold.mContacts[0].mFeatureId = {};
     // TODO: it seems to uniquely identify the contact but idk.
-    manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u8>(minIndex);
+    manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u16>(minIndex);
+    manifold.mContactsCount = 1;
+}
+
+// Closest point on the box, the nearest face if the center is inside.
+static void CollideSphereBox(
+    ContactManifold& manifold,
+    SatCache& cache,
+    const World& world,
+    const Body& sphere,
+    const Body& box,
+    Arena& scratch
+)
+{
+    (void)cache;
+    (void)world;
+    (void)scratch;
+
+    const TransformMat boxLocalToWorld{ToMat3(box.mOrientation), box.mPosition};
+    const Vec3 center = InverseTransform(boxLocalToWorld, sphere.mPosition);
+    const Vec3 halfExtents = box.mBox.mHalfExtents;
+    const f32 sphereRadius = sphere.mRadius;
+
+    manifold.mContacts[0].mFeatureId = {};
+
+    Vec3 closestPoint = Min(Max(center, -halfExtents), halfExtents);
+    const Vec3 segment = closestPoint - center;
+    const f32 distanceSq = MagnitudeSq(segment);
+    if (distanceSq > 0.0f)
+    {
+        if (distanceSq >= sphereRadius * sphereRadius)
+        {
+            manifold.mContactsCount = 0;
+            return;
+        }
+        const f32 distance = sqrtf(distanceSq);
+        manifold.mNormal = boxLocalToWorld.mRotation * (segment / distance);
+        manifold.mContacts[0].mPosition = Transform(boxLocalToWorld, closestPoint);
+        manifold.mContacts[0].mSeparation = distance - sphereRadius;
+        manifold.mContactsCount = 1;
+        return;
+    }
+
+    // Deep contact.
+    int axis = 0;
+    f32 maxDistance = -FLT_MAX;
+    for (int i = 0; i < 3; ++i)
+    {
+        const f32 d = Abs(center[i]) - halfExtents[i];
+        if (d > maxDistance)
+        {
+            axis = i;
+            maxDistance = d;
+        }
+    }
+    const f32 sign = center[axis] < 0.0f ? -1.0f : 1.0f;
+    closestPoint[axis] = sign * halfExtents[axis];
+
+    manifold.mNormal = boxLocalToWorld.mRotation.mCol[axis] * -sign;
+    manifold.mContacts[0].mPosition = Transform(boxLocalToWorld, closestPoint);
+    manifold.mContacts[0].mSeparation = maxDistance - sphereRadius;
     manifold.mContactsCount = 1;
 }
 
+// Faces of a box are 2 * axis + (1 for the negative side), the edges of a face are
+// 4 * face + (0..3) and those parallel to an axis are 4 * axis + (0..3), so the feature ids of
+// the contacts stay the same while the boxes touch by the same features.
+static int BoxBuildFaceContact(
+    ContactManifold& manifold,
+    const TransformMat& transform1,
+    Vec3 halfExtents1,
+    const TransformMat& transform2,
+    Vec3 halfExtents2,
+    int referenceAxis,
+    bool flipNormal
+)
+{
+    const Vec3 translation = transform2.mTranslation - transform1.mTranslation;
+    const bool isReferenceNegative
+        = Dot(transform1.mRotation.mCol[referenceAxis], translation) < 0.0f;
+    const f32 referenceSign = isReferenceNegative ? -1.0f : 1.0f;
+    const Vec3 referenceNormal = transform1.mRotation.mCol[referenceAxis] * referenceSign;
+    const int referenceFace = 2 * referenceAxis + isReferenceNegative;
+
+    // The most anti-parallel face of the second box.
+    int incidentAxis = 0;
+    f32 maxDot = -1.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        const f32 dot = Abs(Dot(transform2.mRotation.mCol[i], referenceNormal));
+        if (dot > maxDot)
+        {
+            incidentAxis = i;
+            maxDot = dot;
+        }
+    }
+    const bool isIncidentNegative
+        = Dot(transform2.mRotation.mCol[incidentAxis], referenceNormal) > 0.0f;
+    const f32 incidentSign = isIncidentNegative ? -1.0f : 1.0f;
+    const int incidentFace = 2 * incidentAxis + isIncidentNegative;
+
+    const int u2 = (incidentAxis + 1) % 3;
+    const int v2 = (incidentAxis + 2) % 3;
+    const Vec3 center = transform2.mTranslation
+                        + transform2.mRotation.mCol[incidentAxis]
+                              * (incidentSign * halfExtents2[incidentAxis]);
+    const Vec3 u = transform2.mRotation.mCol[u2] * halfExtents2[u2];
+    const Vec3 v = transform2.mRotation.mCol[v2] * halfExtents2[v2];
+
+    // A quad clipped by 4 planes.
+    constexpr int CLIP_CAPACITY = 8;
+    ClipVertex buffer1[CLIP_CAPACITY];
+    ClipVertex buffer2[CLIP_CAPACITY];
+    ClipVertex* clipped = buffer1;
+    ClipVertex* clipped2 = buffer2;
+    clipped2[0].mPosition = center + u + v;
+    clipped2[1].mPosition = center - u + v;
+    clipped2[2].mPosition = center - u - v;
+    clipped2[3].mPosition = center + u - v;
+    for (int i = 0; i < 4; ++i)
+    {
+        clipped2[i].mFeatureId = {
+            FeatureId::EDGE_NULL,
+            FeatureId::EDGE_NULL,
+            static_cast<u16>(4 * incidentFace + (i + 3) % 4),
+            static_cast<u16>(4 * incidentFace + i),
+        };
+    }
+
+    int clippedCount = 4;
+    for (int i = 0; i < 4; ++i)
+    {
+        const int axis = (referenceAxis + 1 + i / 2) % 3;
+        const f32 sign = i % 2 == 0 ? 1.0f : -1.0f;
+        const Vec3 normal = transform1.mRotation.mCol[axis] * sign;
+        const Plane sidePlane{
+            normal,
+            Dot(normal, transform1.mTranslation) + halfExtents1[axis],
+        };
+        clippedCount = ClipPolygon(
+            clipped,
+            CLIP_CAPACITY,
+            clipped2,
+            clippedCount,
+            sidePlane,
+            static_cast<u16>(4 * referenceFace + i)
+        );
+        if (clippedCount == 0)
+        {
+            return 0;
+        }
+        Swap(clipped, clipped2);
+    }
+
+    const Plane referenceFacePlane{
+        referenceNormal,
+        Dot(referenceNormal, transform1.mTranslation) + halfExtents1[referenceAxis],
+    };
+    f32 separations[CLIP_CAPACITY];
+    Vec3 positions[CLIP_CAPACITY];
+    FeatureId featureIds[CLIP_CAPACITY];
+    return BuildFaceContactPoints(
+        manifold,
+        clipped2,
+        clippedCount,
+        referenceFacePlane,
+        flipNormal,
+        separations,
+        positions,
+        featureIds
+    );
+}
+
+// The edges are on the supports of the boxes along the normal.
+static int BoxBuildEdgeContact(
+    ContactManifold& manifold,
+    const TransformMat& transform1,
+    Vec3 halfExtents1,
+    const TransformMat& transform2,
+    Vec3 halfExtents2,
+    int axis1,
+    int axis2
+)
+{
+    const Vec3 direction1 = transform1.mRotation.mCol[axis1];
+    const Vec3 direction2 = transform2.mRotation.mCol[axis2];
+    Vec3 normal = Normalize(Cross(direction1, direction2));
+    if (Dot(normal, transform2.mTranslation - transform1.mTranslation) < 0.0f)
+    {
+        normal = -normal;
+    }
+
+    Vec3 p1 = transform1.mTranslation;
+    Vec3 p2 = transform2.mTranslation;
+    int edge1 = 4 * axis1;
+    int edge2 = 4 * axis2;
+    for (int i = 1; i < 3; ++i)
+    {
+        const int k1 = (axis1 + i) % 3;
+        const Vec3 axisK1 = transform1.mRotation.mCol[k1];
+        const bool isPositive1 = Dot(axisK1, normal) > 0.0f;
+        p1 += axisK1 * (isPositive1 ? halfExtents1[k1] : -halfExtents1[k1]);
+        edge1 += isPositive1 << (i - 1);
+
+        const int k2 = (axis2 + i) % 3;
+        const Vec3 axisK2 = transform2.mRotation.mCol[k2];
+        const bool isPositive2 = Dot(axisK2, normal) < 0.0f;
+        p2 += axisK2 * (isPositive2 ? halfExtents2[k2] : -halfExtents2[k2]);
+        edge2 += isPositive2 << (i - 1);
+    }
+
+    // Closest points of the lines, the directions are unit and not parallel.
+    const Vec3 r = p1 - p2;
+    const f32 b = Dot(direction1, direction2);
+    const f32 c = Dot(direction1, r);
+    const f32 f = Dot(direction2, r);
+    const f32 s = Clamp((b * f - c) / (1.0f - b * b), -halfExtents1[axis1], halfExtents1[axis1]);
+    const f32 t = Clamp(b * s + f, -halfExtents2[axis2], halfExtents2[axis2]);
+    const Vec3 c1 = p1 + direction1 * s;
+    const Vec3 c2 = p2 + direction2 * t;
+
+    manifold.mNormal = normal;
+    manifold.mContacts[0].mPosition = (c1 + c2) / 2.0f;
+    manifold.mContacts[0].mSeparation = Dot(normal, p2 - p1);
+    manifold.mContacts[0].mFeatureId.mInHalfEdgeR = static_cast<u16>(edge1);
+    manifold.mContacts[0].mFeatureId.mOutHalfEdgeR = FeatureId::EDGE_NULL;
+    manifold.mContacts[0].mFeatureId.mInHalfEdgeI = static_cast<u16>(edge2);
+    manifold.mContacts[0].mFeatureId.mOutHalfEdgeI = FeatureId::EDGE_NULL;
+
+    return 1;
+}
+
+// The 15 axes of the OBB test in the local space of the first box, the axis is picked with the
+// tolerances of the hull SAT. Cheap enough that the SAT cache isn't used.
+// Real-Time Collision Detection, Christer Ericson, 4.4.1.
+static void CollideBoxBox(
+    ContactManifold& manifold,
+    SatCache& cache,
+    const World& world,
+    const Body& box1,
+    const Body& box2,
+    Arena& scratch
+)
+{
+    (void)cache;
+    (void)world;
+    (void)scratch;
+
+    const TransformMat transform1 = {ToMat3(box1.mOrientation), box1.mPosition};
+    const TransformMat transform2 = {ToMat3(box2.mOrientation), box2.mPosition};
+    const Vec3 h1 = box1.mBox.mHalfExtents;
+    const Vec3 h2 = box2.mBox.mHalfExtents;
+
+    // Axes of the second box and its center in the local space of the first one.
+    const Mat3 c = TMul(transform1.mRotation, transform2.mRotation);
+    const Vec3 d = TMul(transform1.mRotation, transform2.mTranslation - transform1.mTranslation);
+    Mat3 absC{};
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            absC(i, j) = Abs(c(i, j));
+        }
+    }
+
+    const auto noContact = [&manifold]() { manifold.mContactsCount = 0; };
+
+    int faceAxis1 = -1;
+    f32 faceSeparation1 = -FLT_MAX;
+    for (int i = 0; i < 3; ++i)
+    {
+        const f32 radius = h1[i] + h2.X() * absC(i, 0) + h2.Y() * absC(i, 1) + h2.Z() * absC(i, 2);
+        const f32 separation = Abs(d[i]) - radius;
+        if (separation > faceSeparation1)
+        {
+            faceAxis1 = i;
+            faceSeparation1 = separation;
+        }
+    }
+    if (faceSeparation1 > 0.0f)
+    {
+        return noContact();
+    }
+
+    int faceAxis2 = -1;
+    f32 faceSeparation2 = -FLT_MAX;
+    for (int j = 0; j < 3; ++j)
+    {
+        const f32 radius = h2[j] + h1.X() * absC(0, j) + h1.Y() * absC(1, j) + h1.Z() * absC(2, j);
+        const f32 projection = d.X() * c(0, j) + d.Y() * c(1, j) + d.Z() * c(2, j);
+        const f32 separation = Abs(projection) - radius;
+        if (separation > faceSeparation2)
+        {
+            faceAxis2 = j;
+            faceSeparation2 = separation;
+        }
+    }
+    if (faceSeparation2 > 0.0f)
+    {
+        return noContact();
+    }
+
+    int edgeAxis1 = -1;
+    int edgeAxis2 = -1;
+    f32 edgeSeparation = -FLT_MAX;
+    for (int i = 0; i < 3; ++i)
+    {
+        const int i1 = (i + 1) % 3;
+        const int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; ++j)
+        {
+            // Parallel edges don't define an axis.
+            const f32 lengthSq = 1.0f - c(i, j) * c(i, j);
+            if (lengthSq < Square(EDGE_PARALLEL_TOLERANCE))
+            {
+                continue;
+            }
+            const int j1 = (j + 1) % 3;
+            const int j2 = (j + 2) % 3;
+            const f32 radius1 = h1[i1] * absC(i2, j) + h1[i2] * absC(i1, j);
+            const f32 radius2 = h2[j1] * absC(i, j2) + h2[j2] * absC(i, j1);
+            const f32 projection = d[i2] * c(i1, j) - d[i1] * c(i2, j);
+            const f32 separation = (Abs(projection) - radius1 - radius2) / sqrtf(lengthSq);
+            if (separation > edgeSeparation)
+            {
+                edgeAxis1 = i;
+                edgeAxis2 = j;
+                edgeSeparation = separation;
+            }
+        }
+    }
+    if (edgeSeparation > 0.0f)
+    {
+        return noContact();
+    }
+
+    const f32 maxFaceSeparation = Max(faceSeparation1, faceSeparation2);
+    if (edgeSeparation > RELATIVE_EDGE_TOLERANCE * maxFaceSeparation + ABSOLUTE_TOLERANCE)
+    {
+        manifold.mContactsCount
+            = BoxBuildEdgeContact(manifold, transform1, h1, transform2, h2, edgeAxis1, edgeAxis2);
+    }
+    else if (faceSeparation2 > RELATIVE_FACE_TOLERANCE * faceSeparation1 + ABSOLUTE_TOLERANCE)
+    {
+        manifold.mContactsCount
+            = BoxBuildFaceContact(manifold, transform2, h2, transform1, h1, faceAxis2, true);
+    }
+    else
+    {
+        manifold.mContactsCount
+            = BoxBuildFaceContact(manifold, transform1, h1, transform2, h2, faceAxis1, false);
+    }
+}
+
+// Tests the cached axis, returns false if it's stale and the full SAT is needed. The scratch is
+// a copy, the full SAT can need all of it again after a contact that came out empty.
+static bool HullCollideCached(
+    ContactManifold& manifold,
+    SatCache& cache,
+    const TransformMat& transform1,
+    const ConvexHull& hull1,
+    Vec3 scale1,
+    const TransformMat& transform2,
+    const ConvexHull& hull2,
+    Vec3 scale2,
+    Arena scratch
+)
+{
+    f32 separation = -FLT_MAX;
+    switch (cache.mType)
+    {
+    case SatCache::Face1:
+        separation = HullQueryFaceDirection(
+            transform1,
+            transform2,
+            hull1,
+            hull2,
+            scale1,
+            scale2,
+            cache.mIndex1,
+            cache.mSupportIndex2
+        );
+        break;
+    case SatCache::Face2:
+        separation = HullQueryFaceDirection(
+            transform2,
+            transform1,
+            hull2,
+            hull1,
+            scale2,
+            scale1,
+            cache.mIndex2,
+            cache.mSupportIndex1
+        );
+        break;
+    case SatCache::Edges:
+        separation = HullQueryEdgeDirection(
+            transform1,
+            transform2,
+            hull1,
+            hull2,
+            scale1,
+            scale2,
+            cache.mIndex1,
+            cache.mIndex2
+        );
+        break;
+    default:
+        return false;
+    }
+
+    // Any separating axis will do.
+    if (separation > 0.0f)
+    {
+        cache.mSeparation = separation;
+        manifold.mContactsCount = 0;
+        return true;
+    }
+
+    // The axis of minimum penetration is kept while the bodies barely move along it. Only the
+    // full SAT refreshes a penetrating separation, so slow drift doesn't pile up.
+    if (cache.mSeparation > 0.0f || Abs(separation - cache.mSeparation) > LINEAR_SLOP)
+    {
+        return false;
+    }
+
+    switch (cache.mType)
+    {
+    case SatCache::Face1:
+        manifold.mContactsCount = HullBuildFaceContact(
+            manifold,
+            transform1,
+            hull1,
+            scale1,
+            transform2,
+            hull2,
+            scale2,
+            {cache.mIndex1, separation},
+            false,
+            scratch
+        );
+        break;
+    case SatCache::Face2:
+        manifold.mContactsCount = HullBuildFaceContact(
+            manifold,
+            transform2,
+            hull2,
+            scale2,
+            transform1,
+            hull1,
+            scale1,
+            {cache.mIndex2, separation},
+            true,
+            scratch
+        );
+        break;
+    default:
+        manifold.mContactsCount = HullBuildEdgeContact(
+            manifold,
+            transform1,
+            hull1,
+            scale1,
+            transform2,
+            hull2,
+            scale2,
+            {cache.mIndex1, cache.mIndex2, separation}
+        );
+        break;
+    }
+    return manifold.mContactsCount > 0;
+}
+
 void CollideConvexHullConvexHull(
     ContactManifold& manifold,
+    SatCache& cache,
     const World& world,
     const Body& body1,
-    const Body& body2
+    const Body& body2,
+    Arena& scratch
 )
 {
     const TransformMat transform1 = {ToMat3(body1.mOrientation), body1.mPosition};
     const TransformMat transform2 = {ToMat3(body2.mOrientation), body2.mPosition};
 
-    const Slice<ConvexHull> convexHulls = world.GetConvexHulls();
-
-    assert(body1.mConvexHull.mId < convexHulls.mCount);
-    assert(body2.mConvexHull.mId < convexHulls.mCount);
-
-    const ConvexHull& hull1 = convexHulls.mData[body1.mConvexHull.mId];
-    const ConvexHull& hull2 = convexHulls.mData[body2.mConvexHull.mId];
+    // Also boxes with hulls.
+    Vec3 scale1{};
+    Vec3 scale2{};
+    const ConvexHull& hull1 = world.GetBodyHull(body1, scale1);
+    const ConvexHull& hull2 = world.GetBodyHull(body2, scale2);
+
+    if (HullCollideCached(
+            manifold,
+            cache,
+            transform1,
+            hull1,
+            scale1,
+            transform2,
+            hull2,
+            scale2,
+            scratch
+        ))
+    {
+        return;
+    }
 
-    const HullFaceQuery faceQuery1 = HullQueryFaceDirections(transform1, transform2, hull1, hull2);
+    const HullFaceQuery faceQuery1 = HullQueryFaceDirections(
+        transform1,
+        transform2,
+        hull1,
+        hull2,
+        scale1,
+        scale2,
+        cache.mSupportIndex2
+    );
 
     if (faceQuery1.mSeparation > 0.0f)
     {
+        SatCacheSetAxis(cache, SatCache::Face1, faceQuery1.mFaceIndex, 0, faceQuery1.mSeparation);
         manifold.mContactsCount = 0;
         return;
     }
 
-    const HullFaceQuery faceQuery2 = HullQueryFaceDirections(transform2, transform1, hull2, hull1);
+    const HullFaceQuery faceQuery2 = HullQueryFaceDirections(
+        transform2,
+        transform1,
+        hull2,
+        hull1,
+        scale2,
+        scale1,
+        cache.mSupportIndex1
+    );
 
     if (faceQuery2.mSeparation > 0.0f)
     {
+        SatCacheSetAxis(cache, SatCache::Face2, 0, faceQuery2.mFaceIndex, faceQuery2.mSeparation);
         manifold.mContactsCount = 0;
         return;
     }
 
-    const HullEdgeQuery edgeQuery = HullQueryEdgeDirections(transform1, transform2, hull1, hull2);
+    const HullEdgeQuery edgeQuery
+        = HullQueryEdgeDirections(transform1, transform2, hull1, hull2, scale1, scale2);
 
     if (edgeQuery.mSeparation > 0.0f)
     {
+        SatCacheSetAxis(
+            cache,
+            SatCache::Edges,
+            edgeQuery.mEdgeIndex1,
+            edgeQuery.mEdgeIndex2,
+            edgeQuery.mSeparation
+        );
         manifold.mContactsCount = 0;
         return;
     }
 
-    constexpr f32 LINEAR_SLOP = 0.005f;
-    constexpr f32 RELATIVE_EDGE_TOLERANCE = 0.90f;
-    constexpr f32 RELATIVE_FACE_TOLERANCE = 0.98f;
-    constexpr f32 ABSOLUTE_TOLERANCE = 0.5f * LINEAR_SLOP;
-
     const f32 maxFaceSeparation = Max(faceQuery1.mSeparation, faceQuery2.mSeparation);
 
     if (edgeQuery.mSeparation > RELATIVE_EDGE_TOLERANCE * maxFaceSeparation + ABSOLUTE_TOLERANCE)
     {
-        manifold.mContactsCount
-            = HullBuildEdgeContact(manifold, transform1, hull1, transform2, hull2, edgeQuery);
+        SatCacheSetAxis(
+            cache,
+            SatCache::Edges,
+            edgeQuery.mEdgeIndex1,
+            edgeQuery.mEdgeIndex2,
+            edgeQuery.mSeparation
+        );
+        manifold.mContactsCount = HullBuildEdgeContact(
+            manifold,
+            transform1,
+            hull1,
+            scale1,
+            transform2,
+            hull2,
+            scale2,
+            edgeQuery
+        );
     }
     else
     {
@@ -697,33 +1745,73 @@ void CollideConvexHullConvexHull(
             > RELATIVE_FACE_TOLERANCE * faceQuery1.mSeparation + ABSOLUTE_TOLERANCE)
         {
             // Face contact 2.
+            SatCacheSetAxis(
+                cache,
+                SatCache::Face2,
+                0,
+                faceQuery2.mFaceIndex,
+                faceQuery2.mSeparation
+            );
             manifold.mContactsCount = HullBuildFaceContact(
                 manifold,
                 transform2,
                 hull2,
+                scale2,
                 transform1,
                 hull1,
+                scale1,
                 faceQuery2,
-                true
+                true,
+                scratch
             );
         }
         else
         {
             // Face contact 1.
+            SatCacheSetAxis(
+                cache,
+                SatCache::Face1,
+                faceQuery1.mFaceIndex,
+                0,
+                faceQuery1.mSeparation
+            );
             manifold.mContactsCount = HullBuildFaceContact(
                 manifold,
                 transform1,
                 hull1,
+                scale1,
                 transform2,
                 hull2,
+                scale2,
                 faceQuery1,
-                false
+                false,
+                scratch
             );
         }
     }
 }
 
-void Collide(ContactManifold& manifold, const World& world, const Body& body1, const Body& body2)
+ptrdiff_t GetCollideScratchSize(int maxFaceVerticesCount)
+{
+    // See HullBuildFaceContact(), plus the alignment padding of every allocation.
+    const ptrdiff_t sidePlanesCount = maxFaceVerticesCount;
+    const ptrdiff_t clipCount = 2 * sidePlanesCount;
+    return sidePlanesCount * static_cast<ptrdiff_t>(sizeof(Plane) + sizeof(u16))
+           + clipCount
+                 * static_cast<ptrdiff_t>(
+                     2 * sizeof(ClipVertex) + sizeof(f32) + sizeof(Vec3) + sizeof(FeatureId)
+                 )
+           + 7 * 16;
+}
+
+void Collide(
+    ContactManifold& manifold,
+    SatCache& cache,
+    const World& world,
+    const Body& body1,
+    const Body& body2,
+    Arena scratch
+)
 {
     // Robust Contact Creation for Physics Simulation, Dirk Gregorius
     // https://www.gdcvault.com/play/1022193/Physics-for-Game-Programmers-Robust
@@ -732,7 +1820,14 @@ void Collide(ContactManifold& manifold, const World& world, const Body& body1, c
     // The Separating Axis Test between Convex Polyhedra, Dirk Gregorius
     // https://media.gdcvault.com/gdc2013/slides/822403Gregorius_Dirk_TheSeparatingAxisTest.pdf
 
-    using CollideFunction = void (*const)(ContactManifold&, const World&, const Body&, const Body&);
+    using CollideFunction = void (*const)(
+        ContactManifold&,
+        SatCache&,
+        const World&,
+        const Body&,
+        const Body&,
+        Arena&
+    );
 
     // TODO: capsule and triangle mesh.
     // This is an upper triangular collision functions matrix, since we swap bodies if:
@@ -740,8 +1835,9 @@ void Collide(ContactManifold& manifold, const World& world, const Body& body1, c
     // clang-format off
     static constexpr CollideFunction sCollisionMatrix[Body::Shape::Count][Body::Shape::Count] =
     {
-        {CollideSphereSphere, CollideSphereConvexHull},
-        {nullptr,             CollideConvexHullConvexHull},
+        {CollideSphereSphere, CollideSphereBox, CollideSphereConvexHull},
+        {nullptr,             CollideBoxBox,    CollideConvexHullConvexHull},
+        {nullptr,             nullptr,          CollideConvexHullConvexHull},
     };
     // clang-format on
 
@@ -756,7 +1852,7 @@ void Collide(ContactManifold& manifold, const World& world, const Body& body1, c
 
     assert(function);
 
-    function(manifold, world, b1, b2);
+    function(manifold, cache, world, b1, b2, scratch);
 
     if (manifold.mContactsCount > 0)
     {
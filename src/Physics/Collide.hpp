@@ -3,4 +3,23 @@
 #include "Config.hpp"
 #include "World.hpp"
 
-void Collide(ContactManifold& manifold, const World& world, const Body& body1, const Body& body2);
+struct Arena;
+
+// The cache is read and updated by hull pairs only, a zeroed one is empty. The clipping buffers
+// are allocated from scratch, see GetCollideScratchSize().
+void Collide(
+    ContactManifold& manifold,
+    SatCache& cache,
+    const World& world,
+    const Body& body1,
+    const Body& body2,
+    Arena scratch
+);
+
+// Picks the SIMD kernels of the hull queries, AVX2 ones if the build targets SSE2 and isAvx2 is
+// set (see FloatW8.hpp), the FloatW ones otherwise. World::Init picks them for the CPU.
+void InitCollideKernels(bool isAvx2);
+
+// Scratch memory needed by Collide() for hulls with at most maxFaceVerticesCount vertices
+// per face.
+ptrdiff_t GetCollideScratchSize(int maxFaceVerticesCount);
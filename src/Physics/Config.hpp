@@ -1,10 +1,57 @@
 #pragma once
 
+#include "../Common.hpp"
+
+// Debug drawing and UI need the renderer, which isn't linked into headless builds.
+#ifndef DEMO_HEADLESS
 #define PHYSICS_DEBUG
+#endif
 // #define PHYSICS_COLLIDE_ONLY
 // #define PHYSICS_NO_BROADPHASE
 
-static constexpr int PHYSICS_MAX_BODIES = 256;
-static constexpr int PHYSICS_MAX_CONVEX_HULLS = 128;
-// NOTE: arbitrary choice, 4 manifolds per body, *2 to reduce hash table load.
-static constexpr int PHYSICS_MAX_CONTACT_MANIFOLDS = PHYSICS_MAX_BODIES * 4 * 2;
+// Initial capacities, used when WorldDesc leaves them at 0. Storage grows past them when needed.
+static constexpr int PHYSICS_DEFAULT_BODIES_CAPACITY = 256;
+static constexpr int PHYSICS_DEFAULT_CONVEX_HULLS_CAPACITY = 128;
+static constexpr int PHYSICS_DEFAULT_STATIC_BODIES_CAPACITY = 64; // Not in WorldDesc.
+// NOTE: arbitrary choice, 4 manifolds per body.
+static constexpr int PHYSICS_CONTACT_MANIFOLDS_PER_BODY = 4;
+
+static constexpr f32 PHYSICS_ALLOWED_PENETRATION = 0.05f;
+static constexpr f32 PHYSICS_BIAS_FACTOR = 0.2f; // For Baumgarte stabilization.
+
+// ContactSolverType::SoftStep (values from box2d), the stiffness is limited to a quarter of the
+// sub-step rate, contacts with static bodies are twice as stiff.
+static constexpr int PHYSICS_DEFAULT_SUB_STEPS_COUNT = 4;
+static constexpr f32 PHYSICS_CONTACT_HERTZ = 30.0f;
+static constexpr f32 PHYSICS_CONTACT_DAMPING_RATIO = 10.0f;
+static constexpr f32 PHYSICS_CONTACT_PUSH_MAX_VELOCITY = 3.0f; // Separating overlapping bodies.
+
+// Colors of the constraint graph for the wide and multithreaded solvers, manifolds which
+// don't fit are solved serially.
+static constexpr int PHYSICS_SOLVER_COLORS_COUNT = 16;
+// Smallest number of manifolds handed to a worker thread at once.
+static constexpr int PHYSICS_SOLVER_MIN_BATCH = 32;
+// Smallest number of pairs collided by a worker thread at once, hull pairs are expensive.
+static constexpr int PHYSICS_NARROW_PHASE_MIN_BATCH = 8;
+
+// A body is at rest below these velocities, an island falls asleep when all of its bodies have
+// been at rest for PHYSICS_TIME_TO_SLEEP (values from box2d).
+static constexpr f32 PHYSICS_SLEEP_LINEAR_VELOCITY = 0.05f;
+static constexpr f32 PHYSICS_SLEEP_ANGULAR_VELOCITY = 0.035f; // ~2 degrees/s.
+static constexpr f32 PHYSICS_TIME_TO_SLEEP = 0.5f;
+
+// Hulls with fewer vertices are searched for the support point by a (wide) linear scan, the
+// hill climbing jumps around the half-edges.
+static constexpr int PHYSICS_HULL_HILL_CLIMBING_MIN_VERTICES = 32;
+// Sine of the angle below which hull edges share a direction in the edge x edge SAT.
+static constexpr f32 PHYSICS_HULL_EDGE_DIRECTION_TOLERANCE = 1e-4f;
+
+// Dynamic AABB tree proxies are enlarged by this, so slow bodies don't get reinserted.
+static constexpr f32 PHYSICS_AABB_MARGIN = 0.1f;
+
+// Continuous collision detection of bullets, the ones moving more than this fraction of their
+// smallest extent in a step are stopped at the first time of impact.
+static constexpr f32 PHYSICS_CCD_MOTION_FRACTION = 0.5f;
+static constexpr int PHYSICS_CCD_MAX_ITERATIONS = 20;
+// Less than PHYSICS_ALLOWED_PENETRATION, so the contact stops the body without a bias.
+static constexpr f32 PHYSICS_CCD_PENETRATION = 0.02f;
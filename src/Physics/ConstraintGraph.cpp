@@ -0,0 +1,83 @@
+#include "ConstraintGraph.hpp"
+
+#include "../Arena.hpp"
+
+void ConstraintGraph::Build(
+    Arena& arena,
+    const SolverBody* solverBodies,
+    int bodiesCount,
+    const ContactManifold::Key* keys,
+    const int* manifoldsIndices,
+    int manifoldsCount
+)
+{
+    constexpr int COLORS_COUNT = PHYSICS_SOLVER_COLORS_COUNT;
+
+    // A bit set of used dynamic bodies per color.
+    const int wordsCount = (bodiesCount + 63) / 64;
+    u64* const colorsBodies = arena.AllocOrDie<u64>(COLORS_COUNT * wordsCount);
+    int* const manifoldsColors = arena.AllocOrDie<int>(manifoldsCount, Arena::FlagNoZero);
+    int colorsCounts[COLORS_COUNT] = {};
+
+    mOverflowManifolds = arena.AllocOrDie<int>(manifoldsCount, Arena::FlagNoZero);
+    mOverflowCount = 0;
+
+    for (int i = 0; i < manifoldsCount; ++i)
+    {
+        const ContactManifold::Key key = keys[manifoldsIndices[i]];
+        const bool isDynamic1 = solverBodies[key.mBodyId1].mInverseMass != 0.0f;
+        const bool isDynamic2 = solverBodies[key.mBodyId2].mInverseMass != 0.0f;
+        const int word1 = key.mBodyId1 / 64;
+        const int word2 = key.mBodyId2 / 64;
+        const u64 bit1 = 1ULL << (key.mBodyId1 % 64);
+        const u64 bit2 = 1ULL << (key.mBodyId2 % 64);
+
+        int color = -1;
+        for (int c = 0; c < COLORS_COUNT; ++c)
+        {
+            u64* const usedBodies = colorsBodies + c * wordsCount;
+            if ((isDynamic1 && (usedBodies[word1] & bit1))
+                || (isDynamic2 && (usedBodies[word2] & bit2)))
+            {
+                continue;
+            }
+            if (isDynamic1)
+            {
+                usedBodies[word1] |= bit1;
+            }
+            if (isDynamic2)
+            {
+                usedBodies[word2] |= bit2;
+            }
+            color = c;
+            break;
+        }
+
+        manifoldsColors[i] = color;
+        if (color == -1)
+        {
+            mOverflowManifolds[mOverflowCount++] = manifoldsIndices[i];
+        }
+        else
+        {
+            ++colorsCounts[color];
+        }
+    }
+
+    mColorsStart[0] = 0;
+    for (int c = 0; c < COLORS_COUNT; ++c)
+    {
+        mColorsStart[c + 1] = mColorsStart[c] + colorsCounts[c];
+    }
+
+    mManifolds = arena.AllocOrDie<int>(mColorsStart[COLORS_COUNT], Arena::FlagNoZero);
+    int colorsFilled[COLORS_COUNT] = {};
+    for (int i = 0; i < manifoldsCount; ++i)
+    {
+        const int color = manifoldsColors[i];
+        if (color != -1)
+        {
+            mManifolds[mColorsStart[color] + colorsFilled[color]++] = manifoldsIndices[i];
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../Common.hpp"
+
+#include "Config.hpp"
+#include "World.hpp"
+
+struct Arena;
+
+// Manifolds split into colors: no dynamic body appears twice in a color, so the manifolds
+// of one color can be solved in any order, in parallel or in SIMD lanes. Static bodies are
+// only read by the solver, they don't constrain the coloring. Greedy, manifolds that don't
+// fit into any color go to the overflow, which has to be solved serially.
+struct ConstraintGraph
+{
+    int* mManifolds; // Manifold indices grouped by color.
+    // Manifolds of color i are mManifolds[mColorsStart[i]..mColorsStart[i + 1]).
+    int mColorsStart[PHYSICS_SOLVER_COLORS_COUNT + 1];
+
+    int* mOverflowManifolds;
+    int mOverflowCount;
+
+    void Build(
+        Arena& arena,
+        const SolverBody* solverBodies,
+        int bodiesCount,
+        const ContactManifold::Key* keys,
+        const int* manifoldsIndices,
+        int manifoldsCount
+    );
+};
@@ -0,0 +1,335 @@
+#include "ContactSolverWide.hpp"
+
+#include "ConstraintGraph.hpp"
+#include "../Arena.hpp"
+#include "../Math/Vec3.hpp"
+#include "../Math/Mat3.hpp"
+#include "../Math/Utils.hpp"
+
+static constexpr int WIDTH = FLOAT_W_WIDTH;
+
+static void GatherVelocities(
+    const SolverBody* solverBodies,
+    const int* bodyIds,
+    Vec3W& velocity,
+    Vec3W& angularVelocity
+)
+{
+    alignas(FloatW) f32 lanes[6][WIDTH];
+    for (int lane = 0; lane < WIDTH; ++lane)
+    {
+        const int id = bodyIds[lane];
+        const Vec3 v = id < 0 ? Vec3{0.0f} : solverBodies[id].mVelocity;
+        const Vec3 w = id < 0 ? Vec3{0.0f} : solverBodies[id].mAngularVelocity;
+        for (int i = 0; i < 3; ++i)
+        {
+            lanes[i][lane] = v[i];
+            lanes[3 + i][lane] = w[i];
+        }
+    }
+    velocity = {LoadW(lanes[0]), LoadW(lanes[1]), LoadW(lanes[2])};
+    angularVelocity = {LoadW(lanes[3]), LoadW(lanes[4]), LoadW(lanes[5])};
+}
+
+// Static bodies are skipped, several lanes may point to the same one.
+static void ScatterVelocities(
+    SolverBody* solverBodies,
+    const int* bodyIds,
+    const Vec3W& velocity,
+    const Vec3W& angularVelocity
+)
+{
+    alignas(FloatW) f32 lanes[6][WIDTH];
+    StoreW(lanes[0], velocity.mX);
+    StoreW(lanes[1], velocity.mY);
+    StoreW(lanes[2], velocity.mZ);
+    StoreW(lanes[3], angularVelocity.mX);
+    StoreW(lanes[4], angularVelocity.mY);
+    StoreW(lanes[5], angularVelocity.mZ);
+    for (int lane = 0; lane < WIDTH; ++lane)
+    {
+        const int id = bodyIds[lane];
+        if (id < 0 || solverBodies[id].mInverseMass == 0.0f)
+        {
+            continue;
+        }
+        SolverBody& sb = solverBodies[id];
+        sb.mVelocity = {lanes[0][lane], lanes[1][lane], lanes[2][lane]};
+        sb.mAngularVelocity = {lanes[3][lane], lanes[4][lane], lanes[5][lane]};
+    }
+}
+
+static void SetLaneW(Vec3W& x, int lane, Vec3 value)
+{
+    SetLaneW(x.mX, lane, value.X());
+    SetLaneW(x.mY, lane, value.Y());
+    SetLaneW(x.mZ, lane, value.Z());
+}
+
+static void SetLaneW(SymMat3W& x, int lane, const Mat3& value)
+{
+    SetLaneW(x.mXX, lane, value(0, 0));
+    SetLaneW(x.mXY, lane, value(0, 1));
+    SetLaneW(x.mXZ, lane, value(0, 2));
+    SetLaneW(x.mYY, lane, value(1, 1));
+    SetLaneW(x.mYZ, lane, value(1, 2));
+    SetLaneW(x.mZZ, lane, value(2, 2));
+}
+
+static void BundleSetLane(
+    ContactSolverWide::Bundle& bundle,
+    int lane,
+    const Body* bodies,
+    const SolverBody* solverBodies,
+    const ContactManifold& manifold,
+    ContactManifold::Key key,
+    int manifoldIndex
+)
+{
+    const SolverBody& sb1 = solverBodies[key.mBodyId1];
+    const SolverBody& sb2 = solverBodies[key.mBodyId2];
+    const Vec3 position1 = bodies[key.mBodyId1].mPosition;
+    const Vec3 position2 = bodies[key.mBodyId2].mPosition;
+
+    bundle.mBodyIds1[lane] = key.mBodyId1;
+    bundle.mBodyIds2[lane] = key.mBodyId2;
+    bundle.mManifoldIndices[lane] = manifoldIndex;
+    bundle.mPointsCount = Max(bundle.mPointsCount, manifold.mContactsCount);
+
+    SetLaneW(bundle.mNormal, lane, manifold.mNormal);
+    SetLaneW(bundle.mTangents[0], lane, manifold.mTangents[0]);
+    SetLaneW(bundle.mTangents[1], lane, manifold.mTangents[1]);
+    SetLaneW(bundle.mInverseInertia1, lane, sb1.mInverseInertia);
+    SetLaneW(bundle.mInverseInertia2, lane, sb2.mInverseInertia);
+    SetLaneW(bundle.mInverseMass1, lane, sb1.mInverseMass);
+    SetLaneW(bundle.mInverseMass2, lane, sb2.mInverseMass);
+    SetLaneW(bundle.mFriction, lane, manifold.mFriction);
+
+    for (int i = 0; i < manifold.mContactsCount; ++i)
+    {
+        const ContactPoint& c = manifold.mContacts[i];
+        ContactSolverWide::Point& p = bundle.mPoints[i];
+        SetLaneW(p.mBody1ToPosition, lane, c.mPosition - position1);
+        SetLaneW(p.mBody2ToPosition, lane, c.mPosition - position2);
+        SetLaneW(p.mImpulseNormal, lane, c.mImpulseNormal);
+        SetLaneW(p.mImpulseTangent[0], lane, c.mImpulseTangent[0]);
+        SetLaneW(p.mImpulseTangent[1], lane, c.mImpulseTangent[1]);
+        // Temporarily, until the wide prestep: the mass marks points that exist,
+        // the bias holds the separation.
+        SetLaneW(p.mMassNormal, lane, 1.0f);
+        SetLaneW(p.mBias, lane, c.mSeparation);
+    }
+}
+
+void ContactSolverWide::Prepare(
+    Arena& arena,
+    const ConstraintGraph& graph,
+    const Body* bodies,
+    const SolverBody* solverBodies,
+    const ContactManifold* manifolds,
+    const ContactManifold::Key* keys
+)
+{
+    constexpr int COLORS_COUNT = PHYSICS_SOLVER_COLORS_COUNT;
+
+    mBundlesCount = 0;
+    for (int c = 0; c < COLORS_COUNT; ++c)
+    {
+        mColorsBundlesStart[c] = mBundlesCount;
+        const int colorCount = graph.mColorsStart[c + 1] - graph.mColorsStart[c];
+        mBundlesCount += (colorCount + WIDTH - 1) / WIDTH;
+    }
+    mColorsBundlesStart[COLORS_COUNT] = mBundlesCount;
+
+    mBundles = arena.AllocOrDie<Bundle>(mBundlesCount);
+    for (int i = 0; i < mBundlesCount; ++i)
+    {
+        for (int lane = 0; lane < WIDTH; ++lane)
+        {
+            mBundles[i].mBodyIds1[lane] = -1;
+            mBundles[i].mBodyIds2[lane] = -1;
+            mBundles[i].mManifoldIndices[lane] = -1;
+        }
+    }
+
+    for (int c = 0; c < COLORS_COUNT; ++c)
+    {
+        for (int i = graph.mColorsStart[c]; i < graph.mColorsStart[c + 1]; ++i)
+        {
+            const int slot = i - graph.mColorsStart[c];
+            const int index = graph.mManifolds[i];
+            BundleSetLane(
+                mBundles[mColorsBundlesStart[c] + slot / WIDTH],
+                slot % WIDTH,
+                bodies,
+                solverBodies,
+                manifolds[index],
+                keys[index],
+                index
+            );
+        }
+    }
+}
+
+// Same as World::ManifoldPrestep, without the warm starting.
+void ContactSolverWide::Prestep(int begin, int end, f32 inverseTimeStep)
+{
+    assert(inverseTimeStep > 0.0f);
+
+    const FloatW zero = ZeroW();
+    const FloatW allowedPenetration = SplatW(PHYSICS_ALLOWED_PENETRATION);
+    const FloatW biasFactor = SplatW(-PHYSICS_BIAS_FACTOR * inverseTimeStep);
+    for (int i = begin; i < end; ++i)
+    {
+        Bundle& b = mBundles[i];
+        const FloatW sumInvMass = b.mInverseMass1 + b.mInverseMass2;
+
+        for (int j = 0; j < b.mPointsCount; ++j)
+        {
+            Point& p = b.mPoints[j];
+            const FloatW exists = p.mMassNormal;
+
+            const Vec3W crossR1Normal = Cross(p.mBody1ToPosition, b.mNormal);
+            const Vec3W crossR2Normal = Cross(p.mBody2ToPosition, b.mNormal);
+            const FloatW kNormal = sumInvMass
+                + Dot(crossR1Normal, b.mInverseInertia1 * crossR1Normal)
+                + Dot(crossR2Normal, b.mInverseInertia2 * crossR2Normal);
+            p.mMassNormal = SafeReciprocal(kNormal) * exists;
+
+            for (int k = 0; k < 2; ++k)
+            {
+                const Vec3W crossR1Tangent = Cross(p.mBody1ToPosition, b.mTangents[k]);
+                const Vec3W crossR2Tangent = Cross(p.mBody2ToPosition, b.mTangents[k]);
+                const FloatW kTangent = sumInvMass
+                    + Dot(crossR1Tangent, b.mInverseInertia1 * crossR1Tangent)
+                    + Dot(crossR2Tangent, b.mInverseInertia2 * crossR2Tangent);
+                p.mMassTangent[k] = SafeReciprocal(kTangent) * exists;
+            }
+
+            p.mBias = biasFactor * Min(zero, p.mBias + allowedPenetration);
+        }
+    }
+}
+
+void ContactSolverWide::WarmStart(SolverBody* solverBodies, int begin, int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        const Bundle& b = mBundles[i];
+
+        Vec3W v1;
+        Vec3W w1;
+        Vec3W v2;
+        Vec3W w2;
+        GatherVelocities(solverBodies, b.mBodyIds1, v1, w1);
+        GatherVelocities(solverBodies, b.mBodyIds2, v2, w2);
+
+        for (int j = 0; j < b.mPointsCount; ++j)
+        {
+            const Point& p = b.mPoints[j];
+            const Vec3W impulse = b.mNormal * p.mImpulseNormal
+                + b.mTangents[0] * p.mImpulseTangent[0] + b.mTangents[1] * p.mImpulseTangent[1];
+
+            v1 -= impulse * b.mInverseMass1;
+            w1 -= b.mInverseInertia1 * Cross(p.mBody1ToPosition, impulse);
+
+            v2 += impulse * b.mInverseMass2;
+            w2 += b.mInverseInertia2 * Cross(p.mBody2ToPosition, impulse);
+        }
+
+        ScatterVelocities(solverBodies, b.mBodyIds1, v1, w1);
+        ScatterVelocities(solverBodies, b.mBodyIds2, v2, w2);
+    }
+}
+
+void ContactSolverWide::ApplyImpulses(SolverBody* solverBodies, int begin, int end)
+{
+    const FloatW zero = ZeroW();
+
+    for (int i = begin; i < end; ++i)
+    {
+        Bundle& b = mBundles[i];
+
+        Vec3W v1;
+        Vec3W w1;
+        Vec3W v2;
+        Vec3W w2;
+        GatherVelocities(solverBodies, b.mBodyIds1, v1, w1);
+        GatherVelocities(solverBodies, b.mBodyIds2, v2, w2);
+
+        for (int j = 0; j < b.mPointsCount; ++j)
+        {
+            Point& p = b.mPoints[j];
+            const Vec3W& r1 = p.mBody1ToPosition;
+            const Vec3W& r2 = p.mBody2ToPosition;
+
+            Vec3W relativeVelocity = v2 + Cross(w2, r2) - v1 - Cross(w1, r1);
+
+            FloatW impulseNormalMag
+                = p.mMassNormal * (p.mBias - Dot(relativeVelocity, b.mNormal));
+            const FloatW impulseNormalMag0 = p.mImpulseNormal;
+            p.mImpulseNormal = Max(impulseNormalMag0 + impulseNormalMag, zero);
+            impulseNormalMag = p.mImpulseNormal - impulseNormalMag0;
+
+            const Vec3W impulseNormal = b.mNormal * impulseNormalMag;
+
+            v1 -= impulseNormal * b.mInverseMass1;
+            w1 -= b.mInverseInertia1 * Cross(r1, impulseNormal);
+
+            v2 += impulseNormal * b.mInverseMass2;
+            w2 += b.mInverseInertia2 * Cross(r2, impulseNormal);
+
+            relativeVelocity = v2 + Cross(w2, r2) - v1 - Cross(w1, r1);
+
+            const FloatW maxImpulseTangent = b.mFriction * p.mImpulseNormal;
+            for (int k = 0; k < 2; ++k)
+            {
+                FloatW impulseTangentMag
+                    = -(p.mMassTangent[k] * Dot(relativeVelocity, b.mTangents[k]));
+                const FloatW oldImpulseTangent = p.mImpulseTangent[k];
+                p.mImpulseTangent[k] = Clamp(
+                    oldImpulseTangent + impulseTangentMag,
+                    -maxImpulseTangent,
+                    maxImpulseTangent
+                );
+                impulseTangentMag = p.mImpulseTangent[k] - oldImpulseTangent;
+
+                const Vec3W impulseTangent = b.mTangents[k] * impulseTangentMag;
+
+                v1 -= impulseTangent * b.mInverseMass1;
+                w1 -= b.mInverseInertia1 * Cross(r1, impulseTangent);
+
+                v2 += impulseTangent * b.mInverseMass2;
+                w2 += b.mInverseInertia2 * Cross(r2, impulseTangent);
+            }
+        }
+
+        ScatterVelocities(solverBodies, b.mBodyIds1, v1, w1);
+        ScatterVelocities(solverBodies, b.mBodyIds2, v2, w2);
+    }
+}
+
+void ContactSolverWide::StoreImpulses(ContactManifold* manifolds, int begin, int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        const Bundle& b = mBundles[i];
+        for (int lane = 0; lane < WIDTH; ++lane)
+        {
+            const int index = b.mManifoldIndices[lane];
+            if (index < 0)
+            {
+                continue;
+            }
+            ContactManifold& manifold = manifolds[index];
+            for (int j = 0; j < manifold.mContactsCount; ++j)
+            {
+                const Point& p = b.mPoints[j];
+                ContactPoint& c = manifold.mContacts[j];
+                c.mImpulseNormal = GetLaneW(p.mImpulseNormal, lane);
+                c.mImpulseTangent[0] = GetLaneW(p.mImpulseTangent[0], lane);
+                c.mImpulseTangent[1] = GetLaneW(p.mImpulseTangent[1], lane);
+            }
+        }
+    }
+}
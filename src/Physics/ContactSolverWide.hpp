@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../Common.hpp"
+#include "../Math/FloatW.hpp"
+
+#include "Config.hpp"
+#include "World.hpp"
+
+struct Arena;
+struct ConstraintGraph;
+
+// Contact solver working on FLOAT_W_WIDTH manifolds at once, one manifold per SIMD lane.
+//
+// Lanes of a bundle must not share a dynamic body, otherwise velocity scatters would
+// overwrite each other. So every color of the ConstraintGraph is cut into bundles,
+// bundles of one color are also independent of each other. The graph overflow is left
+// for the sequential solver.
+//
+// Solving Box2D with SIMD, Erin Catto.
+// https://box2d.org/posts/2024/08/simd-matters/
+struct ContactSolverWide
+{
+    struct Point
+    {
+        Vec3W mBody1ToPosition;
+        Vec3W mBody2ToPosition;
+        FloatW mMassNormal;
+        FloatW mMassTangent[2];
+        FloatW mBias;
+        FloatW mImpulseNormal;
+        FloatW mImpulseTangent[2];
+    };
+
+    struct Bundle
+    {
+        Point mPoints[ContactManifold::CONTACT_MAX_POINTS];
+        Vec3W mNormal;
+        Vec3W mTangents[2];
+        SymMat3W mInverseInertia1;
+        SymMat3W mInverseInertia2;
+        FloatW mInverseMass1;
+        FloatW mInverseMass2;
+        FloatW mFriction;
+        int mBodyIds1[FLOAT_W_WIDTH]; // -1 in padding lanes.
+        int mBodyIds2[FLOAT_W_WIDTH];
+        int mManifoldIndices[FLOAT_W_WIDTH];
+        int mPointsCount; // Max of the lanes, the missing points have zero masses.
+    };
+
+    Bundle* mBundles;
+    int mBundlesCount;
+    // Bundles of color i are [mColorsBundlesStart[i], mColorsBundlesStart[i + 1]).
+    int mColorsBundlesStart[PHYSICS_SOLVER_COLORS_COUNT + 1];
+
+    // Packs the colored manifolds into bundles (in arena).
+    void Prepare(
+        Arena& arena,
+        const ConstraintGraph& graph,
+        const Body* bodies,
+        const SolverBody* solverBodies,
+        const ContactManifold* manifolds,
+        const ContactManifold::Key* keys
+    );
+
+    // The rest works on bundles [begin, end), bundles of one color can go in parallel.
+    void Prestep(int begin, int end, f32 inverseTimeStep); // Masses and biases.
+    void WarmStart(SolverBody* solverBodies, int begin, int end) const;
+    void ApplyImpulses(SolverBody* solverBodies, int begin, int end); // One iteration.
+    // Writes accumulated impulses back for warm starting on the next step.
+    void StoreImpulses(ContactManifold* manifolds, int begin, int end) const;
+};
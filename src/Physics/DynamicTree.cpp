@@ -0,0 +1,389 @@
+#include "DynamicTree.hpp"
+
+#include "../Arena.hpp"
+#include "Config.hpp"
+
+void DynamicTree::Init(int capacity)
+{
+    assert(capacity > 0);
+
+    *this = {};
+    mRoot = NODE_NULL;
+    mNodesCapacity = capacity;
+    mNodes = gArenaReset.AllocOrDie<Node>(mNodesCapacity);
+    LinkFreeNodes(0);
+}
+
+void DynamicTree::LinkFreeNodes(int begin)
+{
+    for (int i = begin; i < mNodesCapacity - 1; ++i)
+    {
+        mNodes[i].mNext = i + 1;
+        mNodes[i].mHeight = -1;
+    }
+    mNodes[mNodesCapacity - 1].mNext = NODE_NULL;
+    mNodes[mNodesCapacity - 1].mHeight = -1;
+    mFreeList = begin;
+}
+
+int DynamicTree::AllocateNode()
+{
+    if (mFreeList == NODE_NULL)
+    {
+        assert(mNodesCount == mNodesCapacity);
+
+        // Links are indices, so the nodes can move. The old array stays in the arena
+        // until the world is reset.
+        const int newCapacity = mNodesCapacity * 2;
+        mNodes = gArenaReset.ReallocOrDie(mNodes, mNodesCapacity, newCapacity);
+        mNodesCapacity = newCapacity;
+        LinkFreeNodes(mNodesCount);
+    }
+
+    const int nodeId = mFreeList;
+    Node& node = mNodes[nodeId];
+    mFreeList = node.mNext;
+    node.mParent = NODE_NULL;
+    node.mChild1 = NODE_NULL;
+    node.mChild2 = NODE_NULL;
+    node.mHeight = 0;
+    node.mUserData = -1;
+    ++mNodesCount;
+    return nodeId;
+}
+
+void DynamicTree::FreeNode(int nodeId)
+{
+    assert(nodeId >= 0 && nodeId < mNodesCapacity);
+    assert(mNodesCount > 0);
+
+    mNodes[nodeId].mNext = mFreeList;
+    mNodes[nodeId].mHeight = -1;
+    mFreeList = nodeId;
+    --mNodesCount;
+}
+
+int DynamicTree::CreateProxy(const Aabb& aabb, int userData)
+{
+    const int proxyId = AllocateNode();
+    Node& node = mNodes[proxyId];
+    const Vec3 margin{PHYSICS_AABB_MARGIN};
+    node.mAabb = {aabb.mMin - margin, aabb.mMax + margin};
+    node.mUserData = userData;
+    InsertLeaf(proxyId);
+    return proxyId;
+}
+
+void DynamicTree::DestroyProxy(int proxyId)
+{
+    assert(proxyId >= 0 && proxyId < mNodesCapacity);
+    assert(mNodes[proxyId].IsLeaf());
+
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+}
+
+bool DynamicTree::MoveProxy(int proxyId, const Aabb& aabb)
+{
+    assert(proxyId >= 0 && proxyId < mNodesCapacity);
+    assert(mNodes[proxyId].IsLeaf());
+
+    if (Contains(mNodes[proxyId].mAabb, aabb))
+    {
+        return false;
+    }
+
+    RemoveLeaf(proxyId);
+    const Vec3 margin{PHYSICS_AABB_MARGIN};
+    mNodes[proxyId].mAabb = {aabb.mMin - margin, aabb.mMax + margin};
+    InsertLeaf(proxyId);
+    return true;
+}
+
+const Aabb& DynamicTree::GetFatAabb(int proxyId) const
+{
+    assert(proxyId >= 0 && proxyId < mNodesCapacity);
+    return mNodes[proxyId].mAabb;
+}
+
+int DynamicTree::GetUserData(int proxyId) const
+{
+    assert(proxyId >= 0 && proxyId < mNodesCapacity);
+    return mNodes[proxyId].mUserData;
+}
+
+int DynamicTree::GetHeight() const
+{
+    return mRoot == NODE_NULL ? 0 : mNodes[mRoot].mHeight;
+}
+
+void DynamicTree::InsertLeaf(int leaf)
+{
+    if (mRoot == NODE_NULL)
+    {
+        mRoot = leaf;
+        mNodes[leaf].mParent = NODE_NULL;
+        return;
+    }
+
+    // Find the best sibling: descend while the cost of pushing the leaf down is lower than
+    // making it a sibling of the current node. The cost is the area of the new parent plus
+    // the area the ancestors grow by.
+    const Aabb leafAabb = mNodes[leaf].mAabb;
+    int index = mRoot;
+    while (!mNodes[index].IsLeaf())
+    {
+        const int child1 = mNodes[index].mChild1;
+        const int child2 = mNodes[index].mChild2;
+
+        const f32 area = HalfArea(mNodes[index].mAabb);
+        const f32 combinedArea = HalfArea(Union(mNodes[index].mAabb, leafAabb));
+
+        const f32 cost = 2.0f * combinedArea;
+        const f32 inheritanceCost = 2.0f * (combinedArea - area);
+
+        f32 childCosts[2];
+        const int children[2] = {child1, child2};
+        for (int i = 0; i < 2; ++i)
+        {
+            const Node& child = mNodes[children[i]];
+            const f32 newArea = HalfArea(Union(leafAabb, child.mAabb));
+            childCosts[i] = child.IsLeaf() ? newArea + inheritanceCost
+                                           : newArea - HalfArea(child.mAabb) + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+        index = childCosts[0] < childCosts[1] ? child1 : child2;
+    }
+    const int sibling = index;
+
+    const int oldParent = mNodes[sibling].mParent;
+    const int newParent = AllocateNode();
+    mNodes[newParent].mParent = oldParent;
+    mNodes[newParent].mAabb = Union(leafAabb, mNodes[sibling].mAabb);
+    mNodes[newParent].mHeight = mNodes[sibling].mHeight + 1;
+    mNodes[newParent].mChild1 = sibling;
+    mNodes[newParent].mChild2 = leaf;
+    mNodes[sibling].mParent = newParent;
+    mNodes[leaf].mParent = newParent;
+
+    if (oldParent != NODE_NULL)
+    {
+        if (mNodes[oldParent].mChild1 == sibling)
+        {
+            mNodes[oldParent].mChild1 = newParent;
+        }
+        else
+        {
+            mNodes[oldParent].mChild2 = newParent;
+        }
+    }
+    else
+    {
+        mRoot = newParent;
+    }
+
+    // Refit the ancestors, rotating where unbalanced.
+    index = mNodes[leaf].mParent;
+    while (index != NODE_NULL)
+    {
+        index = Balance(index);
+
+        const int child1 = mNodes[index].mChild1;
+        const int child2 = mNodes[index].mChild2;
+        assert(child1 != NODE_NULL && child2 != NODE_NULL);
+
+        mNodes[index].mHeight = 1 + Max(mNodes[child1].mHeight, mNodes[child2].mHeight);
+        mNodes[index].mAabb = Union(mNodes[child1].mAabb, mNodes[child2].mAabb);
+
+        index = mNodes[index].mParent;
+    }
+}
+
+void DynamicTree::RemoveLeaf(int leaf)
+{
+    if (leaf == mRoot)
+    {
+        mRoot = NODE_NULL;
+        return;
+    }
+
+    const int parent = mNodes[leaf].mParent;
+    const int grandParent = mNodes[parent].mParent;
+    const int sibling
+        = mNodes[parent].mChild1 == leaf ? mNodes[parent].mChild2 : mNodes[parent].mChild1;
+
+    if (grandParent == NODE_NULL)
+    {
+        mRoot = sibling;
+        mNodes[sibling].mParent = NODE_NULL;
+        FreeNode(parent);
+        return;
+    }
+
+    // Connect the sibling to the grand parent and refit.
+    if (mNodes[grandParent].mChild1 == parent)
+    {
+        mNodes[grandParent].mChild1 = sibling;
+    }
+    else
+    {
+        mNodes[grandParent].mChild2 = sibling;
+    }
+    mNodes[sibling].mParent = grandParent;
+    FreeNode(parent);
+
+    int index = grandParent;
+    while (index != NODE_NULL)
+    {
+        index = Balance(index);
+
+        const int child1 = mNodes[index].mChild1;
+        const int child2 = mNodes[index].mChild2;
+        mNodes[index].mAabb = Union(mNodes[child1].mAabb, mNodes[child2].mAabb);
+        mNodes[index].mHeight = 1 + Max(mNodes[child1].mHeight, mNodes[child2].mHeight);
+
+        index = mNodes[index].mParent;
+    }
+}
+
+// Rotates A up if one of its subtrees is taller than the other by more than one level,
+// returns the new root of the subtree.
+int DynamicTree::Balance(int iA)
+{
+    assert(iA != NODE_NULL);
+
+    Node* const A = mNodes + iA;
+    if (A->IsLeaf() || A->mHeight < 2)
+    {
+        return iA;
+    }
+
+    const int iB = A->mChild1;
+    const int iC = A->mChild2;
+    Node* const B = mNodes + iB;
+    Node* const C = mNodes + iC;
+
+    const int balance = C->mHeight - B->mHeight;
+
+    // Rotate C up.
+    if (balance > 1)
+    {
+        const int iF = C->mChild1;
+        const int iG = C->mChild2;
+        Node* const F = mNodes + iF;
+        Node* const G = mNodes + iG;
+
+        // Swap A and C.
+        C->mChild1 = iA;
+        C->mParent = A->mParent;
+        A->mParent = iC;
+
+        // A's old parent should point to C.
+        if (C->mParent != NODE_NULL)
+        {
+            if (mNodes[C->mParent].mChild1 == iA)
+            {
+                mNodes[C->mParent].mChild1 = iC;
+            }
+            else
+            {
+                assert(mNodes[C->mParent].mChild2 == iA);
+                mNodes[C->mParent].mChild2 = iC;
+            }
+        }
+        else
+        {
+            mRoot = iC;
+        }
+
+        // Rotate.
+        if (F->mHeight > G->mHeight)
+        {
+            C->mChild2 = iF;
+            A->mChild2 = iG;
+            G->mParent = iA;
+            A->mAabb = Union(B->mAabb, G->mAabb);
+            C->mAabb = Union(A->mAabb, F->mAabb);
+
+            A->mHeight = 1 + Max(B->mHeight, G->mHeight);
+            C->mHeight = 1 + Max(A->mHeight, F->mHeight);
+        }
+        else
+        {
+            C->mChild2 = iG;
+            A->mChild2 = iF;
+            F->mParent = iA;
+            A->mAabb = Union(B->mAabb, F->mAabb);
+            C->mAabb = Union(A->mAabb, G->mAabb);
+
+            A->mHeight = 1 + Max(B->mHeight, F->mHeight);
+            C->mHeight = 1 + Max(A->mHeight, G->mHeight);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up.
+    if (balance < -1)
+    {
+        const int iD = B->mChild1;
+        const int iE = B->mChild2;
+        Node* const D = mNodes + iD;
+        Node* const E = mNodes + iE;
+
+        // Swap A and B.
+        B->mChild1 = iA;
+        B->mParent = A->mParent;
+        A->mParent = iB;
+
+        // A's old parent should point to B.
+        if (B->mParent != NODE_NULL)
+        {
+            if (mNodes[B->mParent].mChild1 == iA)
+            {
+                mNodes[B->mParent].mChild1 = iB;
+            }
+            else
+            {
+                assert(mNodes[B->mParent].mChild2 == iA);
+                mNodes[B->mParent].mChild2 = iB;
+            }
+        }
+        else
+        {
+            mRoot = iB;
+        }
+
+        // Rotate.
+        if (D->mHeight > E->mHeight)
+        {
+            B->mChild2 = iD;
+            A->mChild1 = iE;
+            E->mParent = iA;
+            A->mAabb = Union(C->mAabb, E->mAabb);
+            B->mAabb = Union(A->mAabb, D->mAabb);
+
+            A->mHeight = 1 + Max(C->mHeight, E->mHeight);
+            B->mHeight = 1 + Max(A->mHeight, D->mHeight);
+        }
+        else
+        {
+            B->mChild2 = iE;
+            A->mChild1 = iD;
+            D->mParent = iA;
+            A->mAabb = Union(C->mAabb, D->mAabb);
+            B->mAabb = Union(A->mAabb, E->mAabb);
+
+            A->mHeight = 1 + Max(C->mHeight, D->mHeight);
+            B->mHeight = 1 + Max(A->mHeight, E->mHeight);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../Common.hpp"
+
+#include "Geometry.hpp"
+
+// Dynamic AABB tree, leaves are proxies with enlarged ("fat") AABBs, so a body moving a
+// little stays inside its leaf and the tree isn't touched. Insertion picks the sibling
+// with the surface area heuristic, rotations keep the tree balanced.
+//
+// Dynamic AABB tree, Erin Catto (box2d b2DynamicTree).
+// Dynamic Bounding Volume Hierarchies, Erin Catto, GDC 2019.
+// https://box2d.org/files/ErinCatto_DynamicBVH_GDC2019.pdf
+struct DynamicTree
+{
+    static constexpr int NODE_NULL = -1;
+
+    struct Node
+    {
+        Aabb mAabb; // Fat for leaves.
+        union
+        {
+            int mParent;
+            int mNext; // Free list.
+        };
+        int mChild1;
+        int mChild2;
+        int mHeight; // Leaf 0, free -1.
+        int mUserData; // Leaves only.
+
+        bool IsLeaf() const;
+    };
+
+    Node* mNodes; // In gArenaReset.
+    int mNodesCount;
+    int mNodesCapacity;
+    int mRoot;
+    int mFreeList;
+
+    void Init(int capacity);
+
+    // Returns the proxy id (a leaf node), aabb is the tight one.
+    int CreateProxy(const Aabb& aabb, int userData);
+    void DestroyProxy(int proxyId);
+    // Reinserts the proxy if aabb left its fat AABB, returns true then.
+    bool MoveProxy(int proxyId, const Aabb& aabb);
+
+    const Aabb& GetFatAabb(int proxyId) const;
+    int GetUserData(int proxyId) const;
+    int GetHeight() const;
+
+    // callback(proxyId) for all the proxies overlapping aabb, stops if it returns false.
+    template <typename F>
+    void Query(const Aabb& aabb, const F& callback) const;
+
+private:
+    void LinkFreeNodes(int begin); // [begin, mNodesCapacity) to the free list.
+    int AllocateNode();
+    void FreeNode(int node);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+};
+
+inline bool DynamicTree::Node::IsLeaf() const
+{
+    return mChild1 == NODE_NULL;
+}
+
+template <typename F>
+void DynamicTree::Query(const Aabb& aabb, const F& callback) const
+{
+    // A balanced tree of 2^31 leaves is shallower than this.
+    constexpr int STACK_CAPACITY = 256;
+    int stack[STACK_CAPACITY];
+    int stackCount = 0;
+    stack[stackCount++] = mRoot;
+
+    while (stackCount > 0)
+    {
+        const int nodeId = stack[--stackCount];
+        if (nodeId == NODE_NULL)
+        {
+            continue;
+        }
+
+        const Node& node = mNodes[nodeId];
+        if (!Overlap(node.mAabb, aabb))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (!callback(nodeId))
+            {
+                return;
+            }
+        }
+        else
+        {
+            assert(stackCount + 2 <= STACK_CAPACITY);
+            stack[stackCount++] = node.mChild1;
+            stack[stackCount++] = node.mChild2;
+        }
+    }
+}
@@ -6,11 +6,16 @@
 #include "../Math/Vec3.hpp"
 #include "../Math/Mat3.hpp"
 #include "../Math/Quat.hpp"
-#include "../Renderer/Renderer.hpp"
+#include "../Math/FloatW8.hpp"
 #include "../Renderer/Meshes.hpp"
 
+#ifdef PHYSICS_DEBUG
+#include "../Renderer/Renderer.hpp"
+#endif
+
 #include <float.h>
 #include <stdio.h>
+#include <string.h>
 
 void FeatureId::Flip()
 {
@@ -41,6 +46,108 @@ int GetSupportPointIndex(const Vec3* vertices, int verticesCount, Vec3 direction
     return maxIndex;
 }
 
+static int GetSupportPointIndexFloatW(const Vec3W* vertices, int verticesCount, Vec3 direction)
+{
+    assert(vertices);
+    assert(verticesCount > 0);
+
+    const int blocksCount = GetBlocksCountW(verticesCount);
+    const Vec3W directionW = SplatW(direction);
+
+    FloatW maxProjectionW = SplatW(-FLT_MAX);
+    for (int i = 0; i < blocksCount; ++i)
+    {
+        maxProjectionW = Max(maxProjectionW, Dot(directionW, vertices[i]));
+    }
+    f32 maxProjection = -FLT_MAX;
+    for (int lane = 0; lane < FloatW::N; ++lane)
+    {
+        maxProjection = Max(maxProjection, GetLaneW(maxProjectionW, lane));
+    }
+
+    // The first lane reaching the maximum, the padding lanes are after the real ones.
+    const FloatW maxW = SplatW(maxProjection);
+    for (int i = 0; i < blocksCount; ++i)
+    {
+        const int mask = MoveMaskW(LessEqualW(maxW, Dot(directionW, vertices[i])));
+        if (mask != 0)
+        {
+            int lane = 0;
+            while (!(mask & (1 << lane)))
+            {
+                ++lane;
+            }
+            return i * FloatW::N + lane;
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+
+#if defined(FLOAT_W_DISPATCH_AVX2)
+// Two blocks at a time, an odd last block is paired with itself.
+FLOAT_W8_TARGET static int GetSupportPointIndexAvx2(
+    const Vec3W* vertices,
+    int verticesCount,
+    Vec3 direction
+)
+{
+    assert(vertices);
+    assert(verticesCount > 0);
+
+    const int blocksCount = GetBlocksCountW(verticesCount);
+    const Vec3W8 directionW = SplatW8(direction);
+
+    FloatW8 maxProjectionW = SplatW8(-FLT_MAX);
+    for (int i = 0; i < blocksCount; i += 2)
+    {
+        const Vec3W8 block = CombineW8(vertices[i], vertices[Min(i + 1, blocksCount - 1)]);
+        maxProjectionW = Max(maxProjectionW, Dot(directionW, block));
+    }
+    f32 maxProjection = -FLT_MAX;
+    for (int lane = 0; lane < FloatW8::N; ++lane)
+    {
+        maxProjection = Max(maxProjection, GetLaneW(maxProjectionW, lane));
+    }
+
+    const FloatW8 maxW = SplatW8(maxProjection);
+    for (int i = 0; i < blocksCount; i += 2)
+    {
+        const Vec3W8 block = CombineW8(vertices[i], vertices[Min(i + 1, blocksCount - 1)]);
+        const int mask = MoveMaskW(LessEqualW(maxW, Dot(directionW, block)));
+        if (mask != 0)
+        {
+            int lane = 0;
+            while (!(mask & (1 << lane)))
+            {
+                ++lane;
+            }
+            return i * FloatW::N + lane;
+        }
+    }
+
+    assert(false);
+    return 0;
+}
+#endif
+
+static int (*sGetSupportPointIndexW)(const Vec3W*, int, Vec3) = GetSupportPointIndexFloatW;
+
+void InitGeometryKernels(bool isAvx2)
+{
+#if defined(FLOAT_W_DISPATCH_AVX2)
+    sGetSupportPointIndexW = isAvx2 ? GetSupportPointIndexAvx2 : GetSupportPointIndexFloatW;
+#else
+    (void)isAvx2;
+#endif
+}
+
+int GetSupportPointIndex(const Vec3W* vertices, int verticesCount, Vec3 direction)
+{
+    return sGetSupportPointIndexW(vertices, verticesCount, direction);
+}
+
 Vec3 GetSupportPoint(const Vec3* vertices, int verticesCount, Vec3 direction)
 {
     assert(vertices);
@@ -86,6 +193,14 @@ Plane Transform(const TransformMat& transform, Plane plane)
     return Plane{normal, plane.mOffset + Dot(normal, transform.mTranslation)};
 }
 
+Plane Scale(Plane plane, Vec3 scale)
+{
+    const Vec3 normal
+        = plane.mNormal * Vec3{1.0f / scale.X(), 1.0f / scale.Y(), 1.0f / scale.Z()};
+    const f32 inverseLength = 1.0f / Magnitude(normal);
+    return Plane{normal * inverseLength, plane.mOffset * inverseLength};
+}
+
 Vec3 Transform(const TransformMat& transform, Vec3 v)
 {
     return transform.mRotation * v + transform.mTranslation;
@@ -96,16 +211,6 @@ Vec3 InverseTransform(const TransformMat& transform, Vec3 v)
     return TMul(transform.mRotation, v - transform.mTranslation);
 }
 
-ConvexHull::HalfEdge Null()
-{
-    return {
-        ConvexHull::PRIMITIVE_NULL,
-        ConvexHull::PRIMITIVE_NULL,
-        ConvexHull::PRIMITIVE_NULL,
-        ConvexHull::PRIMITIVE_NULL
-    };
-}
-
 /*
  * Half-edges:
  * < left     > right     ^ away     v towards
@@ -116,8 +221,6 @@ ConvexHull::HalfEdge Null()
  * Faces:
  * A number, on the right box.
  *
- * TODO: ahem, quickhull.
- *
  *             (7)     >12
  *             ,+--------------------+(6)            ,+--------------------+
  *           ,' |      <13         ,'|             ,' |        5 (back)  ,'|
@@ -165,33 +268,34 @@ void ConvexHull::InitBox(Vec3 scale)
     // clang-format on
     mCentroid = {0.0f, 0.0f, 0.0f};
 
-    mHalfEdges = gArenaReset.AllocOrDie<HalfEdge>(mHalfEdgesCount);
+    HalfEdge halfEdges[12 * 2];
     // clang-format off
-    mHalfEdges[0]  = {17, 1,  1, 4};
-    mHalfEdges[1]  = {3,  0,  0, 0};
-    mHalfEdges[2]  = {18, 3,  2, 1};
-    mHalfEdges[3]  = {5,  2,  1, 0};
-    mHalfEdges[4]  = {21, 5,  3, 5};
-    mHalfEdges[5]  = {7,  4,  2, 0};
-    mHalfEdges[6]  = {23, 7,  0, 3};
-    mHalfEdges[7]  = {1,  6,  3, 0};
-    mHalfEdges[8]  = {14, 9,  5, 2};
-    mHalfEdges[9]  = {19, 8,  4, 4};
-    mHalfEdges[10] = {8,  11, 6, 2};
-    mHalfEdges[11] = {20, 10, 5, 1};
-    mHalfEdges[12] = {10, 13, 7, 2};
-    mHalfEdges[13] = {22, 12, 6, 5};
-    mHalfEdges[14] = {12, 15, 4, 2};
-    mHalfEdges[15] = {16, 14, 7, 3};
-    mHalfEdges[16] = {6,  17, 4, 3};
-    mHalfEdges[17] = {9,  16, 0, 4};
-    mHalfEdges[18] = {11, 19, 1, 1};
-    mHalfEdges[19] = {0,  18, 5, 4};
-    mHalfEdges[20] = {2,  21, 6, 1};
-    mHalfEdges[21] = {13, 20, 2, 5};
-    mHalfEdges[22] = {4,  23, 7, 5};
-    mHalfEdges[23] = {15, 22, 3, 3};
+    halfEdges[0]  = {17, 1,  1, 4};
+    halfEdges[1]  = {3,  0,  0, 0};
+    halfEdges[2]  = {18, 3,  2, 1};
+    halfEdges[3]  = {5,  2,  1, 0};
+    halfEdges[4]  = {21, 5,  3, 5};
+    halfEdges[5]  = {7,  4,  2, 0};
+    halfEdges[6]  = {23, 7,  0, 3};
+    halfEdges[7]  = {1,  6,  3, 0};
+    halfEdges[8]  = {14, 9,  5, 2};
+    halfEdges[9]  = {19, 8,  4, 4};
+    halfEdges[10] = {8,  11, 6, 2};
+    halfEdges[11] = {20, 10, 5, 1};
+    halfEdges[12] = {10, 13, 7, 2};
+    halfEdges[13] = {22, 12, 6, 5};
+    halfEdges[14] = {12, 15, 4, 2};
+    halfEdges[15] = {16, 14, 7, 3};
+    halfEdges[16] = {6,  17, 4, 3};
+    halfEdges[17] = {9,  16, 0, 4};
+    halfEdges[18] = {11, 19, 1, 1};
+    halfEdges[19] = {0,  18, 5, 4};
+    halfEdges[20] = {2,  21, 6, 1};
+    halfEdges[21] = {13, 20, 2, 5};
+    halfEdges[22] = {4,  23, 7, 5};
+    halfEdges[23] = {15, 22, 3, 3};
     // clang-format on
+    InitHalfEdges(halfEdges, gArenaReset);
 
     mFaces = gArenaReset.AllocOrDie<Face>(mFacesCount);
     mFaces[0].mHalfEdge = 1;
@@ -223,6 +327,10 @@ void ConvexHull::InitBox(Vec3 scale)
         mFacePlanes[i].mOffset *= Dot(mFacePlanes[i].mNormal, scale);
     }
 
+    InitVertices(gArenaReset);
+    InitWide(gArenaReset);
+    InitEdgeDirections(gArenaReset);
+
     const ConsistencyResult consistency = CheckConsistency();
     if (consistency != ConsistencyResult::Ok)
     {
@@ -234,7 +342,6 @@ void ConvexHull::InitBox(Vec3 scale)
 }
 
 /* For the explanation, refer to the cube above.
- * TODO: I really need to implement quickhull.
  *
  *                                                 ^ Y
  *               (3)                               |
@@ -280,21 +387,22 @@ void ConvexHull::InitTetrahedron(Vec3 scale)
     mCentroid = Vec3{0.0f};
     mRadius = Max(scale.X(), scale.Y(), scale.Z());
 
-    mHalfEdges = gArenaReset.AllocOrDie<HalfEdge>(mHalfEdgesCount);
+    HalfEdge halfEdges[6 * 2];
     // clang-format off
-    mHalfEdges[0]  = {10, 1,  1, 3};
-    mHalfEdges[1]  = {3,  0,  0, 0};
-    mHalfEdges[2]  = {7,  3,  2, 1};
-    mHalfEdges[3]  = {5,  2,  1, 0};
-    mHalfEdges[4]  = {8,  5,  0, 2};
-    mHalfEdges[5]  = {1,  4,  2, 0};
-    mHalfEdges[6]  = {0,  7,  3, 3};
-    mHalfEdges[7]  = {9,  6,  1, 1};
-    mHalfEdges[8]  = {11, 9,  2, 2};
-    mHalfEdges[9]  = {2,  8,  3, 1};
-    mHalfEdges[10] = {6,  11, 0, 3};
-    mHalfEdges[11] = {4,  10, 3, 2};
+    halfEdges[0]  = {10, 1,  1, 3};
+    halfEdges[1]  = {3,  0,  0, 0};
+    halfEdges[2]  = {7,  3,  2, 1};
+    halfEdges[3]  = {5,  2,  1, 0};
+    halfEdges[4]  = {8,  5,  0, 2};
+    halfEdges[5]  = {1,  4,  2, 0};
+    halfEdges[6]  = {0,  7,  3, 3};
+    halfEdges[7]  = {9,  6,  1, 1};
+    halfEdges[8]  = {11, 9,  2, 2};
+    halfEdges[9]  = {2,  8,  3, 1};
+    halfEdges[10] = {6,  11, 0, 3};
+    halfEdges[11] = {4,  10, 3, 2};
     // clang-format on
+    InitHalfEdges(halfEdges, gArenaReset);
 
     mFaces = gArenaReset.AllocOrDie<Face>(mFacesCount);
     mFaces[0].mHalfEdge = 1;
@@ -320,10 +428,14 @@ void ConvexHull::InitTetrahedron(Vec3 scale)
     for (int i = 0; i < mFacesCount; ++i)
     {
         mFacePlanes[i].mNormal = Normalize(mFacePlanes[i].mNormal * inverseScale);
-        const Vec3 pointOnFace = mVertexPositions[mHalfEdges[mFaces[i].mHalfEdge].mOrigin];
+        const Vec3 pointOnFace = GetOrigin(mFaces[i].mHalfEdge);
         mFacePlanes[i].mOffset = Dot(mFacePlanes[i].mNormal, pointOnFace);
     }
 
+    InitVertices(gArenaReset);
+    InitWide(gArenaReset);
+    InitEdgeDirections(gArenaReset);
+
     const ConsistencyResult consistency = CheckConsistency();
     if (consistency != ConsistencyResult::Ok)
     {
@@ -334,39 +446,286 @@ void ConvexHull::InitTetrahedron(Vec3 scale)
     GetTetrahedronData(mMeshPositions, mMeshIndices, nullptr, gArenaReset);
 }
 
+void ConvexHull::InitHalfEdges(const HalfEdge* halfEdges, Arena& arena)
+{
+    assert(halfEdges);
+    assert(mHalfEdgesCount < PRIMITIVE_MAX);
+    assert(mVerticesCount < PRIMITIVE_MAX);
+    assert(mFacesCount < PRIMITIVE_MAX);
+
+    mHalfEdges8 = nullptr;
+    mHalfEdges16 = nullptr;
+    if (mHalfEdgesCount < PRIMITIVE_MAX_8 && mVerticesCount < PRIMITIVE_MAX_8
+        && mFacesCount < PRIMITIVE_MAX_8)
+    {
+        mHalfEdges8 = arena.AllocOrDie<HalfEdge8>(mHalfEdgesCount, Arena::FlagNoZero);
+        for (int i = 0; i < mHalfEdgesCount; ++i)
+        {
+            const HalfEdge halfEdge = halfEdges[i];
+            mHalfEdges8[i] = {
+                static_cast<u8>(halfEdge.mNext),
+                static_cast<u8>(halfEdge.mTwin),
+                static_cast<u8>(halfEdge.mOrigin),
+                static_cast<u8>(halfEdge.mFace),
+            };
+        }
+    }
+    else
+    {
+        mHalfEdges16 = arena.AllocOrDie<HalfEdge>(mHalfEdgesCount, Arena::FlagNoZero);
+        memcpy(mHalfEdges16, halfEdges, static_cast<size_t>(mHalfEdgesCount) * sizeof(HalfEdge));
+    }
+}
+
+void ConvexHull::InitVertices(Arena& arena)
+{
+    mVertices = arena.AllocOrDie<Vertex>(mVerticesCount);
+    for (int i = 0; i < mHalfEdgesCount; ++i)
+    {
+        mVertices[GetHalfEdge(i).mOrigin].mHalfEdge = static_cast<u16>(i);
+    }
+
+    mMaxFaceVerticesCount = 0;
+    for (int i = 0; i < mFacesCount; ++i)
+    {
+        int faceVerticesCount = 0;
+        int halfEdgeIndex = mFaces[i].mHalfEdge;
+        do
+        {
+            ++faceVerticesCount;
+            halfEdgeIndex = GetHalfEdge(halfEdgeIndex).mNext;
+        }
+        while (halfEdgeIndex != mFaces[i].mHalfEdge);
+        mMaxFaceVerticesCount = Max(mMaxFaceVerticesCount, faceVerticesCount);
+    }
+}
+
+static void SetLaneW(Vec3W& v, int lane, Vec3 value)
+{
+    SetLaneW(v.mX, lane, value.X());
+    SetLaneW(v.mY, lane, value.Y());
+    SetLaneW(v.mZ, lane, value.Z());
+}
+
+void ConvexHull::InitWide(Arena& arena)
+{
+    constexpr int N = FloatW::N;
+
+    const int vertexBlocksCount = GetBlocksCountW(mVerticesCount);
+    mVertexPositionsW = arena.AllocOrDie<Vec3W>(vertexBlocksCount, Arena::FlagNoZero);
+    for (int i = 0; i < vertexBlocksCount * N; ++i)
+    {
+        SetLaneW(mVertexPositionsW[i / N], i % N, mVertexPositions[Min(i, mVerticesCount - 1)]);
+    }
+
+    const int faceBlocksCount = GetBlocksCountW(mFacesCount);
+    mFacePlanesW = arena.AllocOrDie<PlaneW>(faceBlocksCount, Arena::FlagNoZero);
+    for (int i = 0; i < faceBlocksCount * N; ++i)
+    {
+        const Plane plane = mFacePlanes[Min(i, mFacesCount - 1)];
+        SetLaneW(mFacePlanesW[i / N].mNormal, i % N, plane.mNormal);
+        SetLaneW(mFacePlanesW[i / N].mOffset, i % N, plane.mOffset);
+    }
+
+    const int edgesCount = mHalfEdgesCount / 2;
+    const int edgeBlocksCount = GetBlocksCountW(edgesCount);
+    mEdgesW = arena.AllocOrDie<EdgeW>(edgeBlocksCount, Arena::FlagNoZero);
+    for (int i = 0; i < edgeBlocksCount * N; ++i)
+    {
+        const int halfEdgeIndex = 2 * Min(i, edgesCount - 1);
+        const HalfEdge edge = GetHalfEdge(halfEdgeIndex);
+        const HalfEdge twin = GetHalfEdge(halfEdgeIndex + 1);
+        const Vec3 origin = mVertexPositions[edge.mOrigin];
+        EdgeW& block = mEdgesW[i / N];
+        SetLaneW(block.mOrigin, i % N, origin);
+        SetLaneW(block.mDirection, i % N, mVertexPositions[twin.mOrigin] - origin);
+        SetLaneW(block.mNormal1, i % N, mFacePlanes[edge.mFace].mNormal);
+        SetLaneW(block.mNormal2, i % N, mFacePlanes[twin.mFace].mNormal);
+    }
+}
+
+static int FindEdgeDirection(const EdgeDirection* directions, int directionsCount, Vec3 direction)
+{
+    for (int i = 0; i < directionsCount; ++i)
+    {
+        const Vec3 cross = Cross(directions[i].mDirection, direction);
+        if (MagnitudeSq(cross) < Square(PHYSICS_HULL_EDGE_DIRECTION_TOLERANCE))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ConvexHull::InitEdgeDirections(Arena& arena)
+{
+    const int edgesCount = mHalfEdgesCount / 2;
+    mEdgeDirections = arena.AllocOrDie<EdgeDirection>(edgesCount, Arena::FlagNoZero);
+    mDirectionEdges = arena.AllocOrDie<DirectionEdge>(edgesCount, Arena::FlagNoZero);
+
+    // Counts the edges of every direction, then lays them out one direction after another.
+    mEdgeDirectionsCount = 0;
+    for (int i = 0; i < mHalfEdgesCount; i += 2)
+    {
+        const Vec3 direction = Normalize(GetTarget(i) - GetOrigin(i));
+        const int index = FindEdgeDirection(mEdgeDirections, mEdgeDirectionsCount, direction);
+        if (index >= 0)
+        {
+            ++mEdgeDirections[index].mEdgesCount;
+        }
+        else
+        {
+            mEdgeDirections[mEdgeDirectionsCount++] = {direction, 0, 1};
+        }
+    }
+
+    int firstEdge = 0;
+    for (int i = 0; i < mEdgeDirectionsCount; ++i)
+    {
+        mEdgeDirections[i].mFirstEdge = firstEdge;
+        firstEdge += mEdgeDirections[i].mEdgesCount;
+        mEdgeDirections[i].mEdgesCount = 0;
+    }
+
+    for (int i = 0; i < mHalfEdgesCount; i += 2)
+    {
+        const Vec3 edge = GetTarget(i) - GetOrigin(i);
+        const int index = FindEdgeDirection(mEdgeDirections, mEdgeDirectionsCount, Normalize(edge));
+        assert(index >= 0);
+        EdgeDirection& direction = mEdgeDirections[index];
+        const Vec3 d = direction.mDirection;
+
+        // The face of the half-edge pointing along the direction is the start of the arc.
+        const bool isAlong = Dot(edge, d) > 0.0f;
+        const Vec3 u = mFacePlanes[GetHalfEdge(isAlong ? i : i + 1).mFace].mNormal;
+        const Vec3 v = mFacePlanes[GetHalfEdge(isAlong ? i + 1 : i).mFace].mNormal;
+        mDirectionEdges[direction.mFirstEdge + direction.mEdgesCount++]
+            = {Cross(d, u), Cross(v, d), i};
+    }
+}
+
 Vec3 ConvexHull::GetSupportPoint(Vec3 direction) const
 {
-    const int index = GetSupportPointIndex(mVertexPositions, mVerticesCount, direction);
-    assert(index >= 0);
-    return mVertexPositions[index];
+    return mVertexPositions[GetSupportPointIndex(direction, 0)];
 }
 
-ConvexHull::HalfEdge ConvexHull::GetNext(u8 halfEdgeIndex) const
+// Lays the arrays out one after another, only measures the size if there is no base.
+struct HullPacker
 {
-    return mHalfEdges[mHalfEdges[halfEdgeIndex].mNext];
+    uchar* mBase;
+    ptrdiff_t mSize;
+
+    template <typename T>
+    void Add(T*& array, int count)
+    {
+        const ptrdiff_t align = alignof(T);
+        mSize = (mSize + align - 1) & -align;
+        if (mBase && array)
+        {
+            T* const packed = reinterpret_cast<T*>(mBase + mSize);
+            memcpy(packed, array, static_cast<size_t>(count) * sizeof(T));
+            array = packed;
+        }
+        mSize += static_cast<ptrdiff_t>(count) * static_cast<ptrdiff_t>(sizeof(T));
+    }
+};
+
+void ConvexHull::Pack(Arena& arena)
+{
+    const auto add = [this](HullPacker& packer)
+    {
+        // Face queries, then edge queries, then clipping and hill climbing.
+        packer.Add(mFacePlanesW, GetBlocksCountW(mFacesCount));
+        packer.Add(mFacePlanes, mFacesCount);
+        packer.Add(mVertexPositionsW, GetBlocksCountW(mVerticesCount));
+        packer.Add(mVertexPositions, mVerticesCount);
+        packer.Add(mHalfEdges8, mHalfEdges8 ? mHalfEdgesCount : 0);
+        packer.Add(mHalfEdges16, mHalfEdges16 ? mHalfEdgesCount : 0);
+        packer.Add(mEdgesW, GetBlocksCountW(mHalfEdgesCount / 2));
+        packer.Add(mEdgeDirections, mEdgeDirectionsCount);
+        packer.Add(mDirectionEdges, mHalfEdgesCount / 2);
+        packer.Add(mFaces, mFacesCount);
+        packer.Add(mVertices, mVerticesCount);
+    };
+
+    HullPacker measure{};
+    add(measure);
+    HullPacker packer{
+        static_cast<uchar*>(arena.AllocOrDie(measure.mSize, 64, Arena::FlagNoZero)),
+        0
+    };
+    add(packer);
+    assert(packer.mSize == measure.mSize);
+}
+
+int ConvexHull::GetSupportPointIndex(Vec3 direction, int startIndex) const
+{
+    if (mVerticesCount < PHYSICS_HULL_HILL_CLIMBING_MIN_VERTICES)
+    {
+        return ::GetSupportPointIndex(mVertexPositionsW, mVerticesCount, direction);
+    }
+    return HillClimbSupportPointIndex(direction, startIndex);
+}
+
+int ConvexHull::HillClimbSupportPointIndex(Vec3 direction, int startIndex) const
+{
+    assert(startIndex >= 0 && startIndex < mVerticesCount);
+
+    int index = startIndex;
+    f32 maxProjection = Dot(direction, mVertexPositions[index]);
+    for (;;)
+    {
+        // Outgoing half-edges around the vertex, the twin's next one starts there again.
+        const int firstHalfEdgeIndex = mVertices[index].mHalfEdge;
+        int halfEdgeIndex = firstHalfEdgeIndex;
+        int maxIndex = index;
+        do
+        {
+            const HalfEdge twin = GetHalfEdge(GetHalfEdge(halfEdgeIndex).mTwin);
+            const f32 projection = Dot(direction, mVertexPositions[twin.mOrigin]);
+            if (projection > maxProjection)
+            {
+                maxIndex = twin.mOrigin;
+                maxProjection = projection;
+            }
+            halfEdgeIndex = twin.mNext;
+        }
+        while (halfEdgeIndex != firstHalfEdgeIndex);
+
+        if (maxIndex == index)
+        {
+            return index;
+        }
+        index = maxIndex;
+    }
 }
 
-Vec3 ConvexHull::GetOrigin(u8 halfEdgeIndex) const
+ConvexHull::HalfEdge ConvexHull::GetNext(int halfEdgeIndex) const
 {
-    return mVertexPositions[mHalfEdges[halfEdgeIndex].mOrigin];
+    return GetHalfEdge(GetHalfEdge(halfEdgeIndex).mNext);
 }
 
-Vec3 ConvexHull::GetTarget(u8 halfEdgeIndex) const
+Vec3 ConvexHull::GetOrigin(int halfEdgeIndex) const
+{
+    return mVertexPositions[GetHalfEdge(halfEdgeIndex).mOrigin];
+}
+
+Vec3 ConvexHull::GetTarget(int halfEdgeIndex) const
 {
     return mVertexPositions[GetNext(halfEdgeIndex).mOrigin];
 }
 
-int ConvexHull::GetVertices(Vec3 vertices[PRIMITIVE_MAX], u8 faceIndex) const
+int ConvexHull::GetVertices(Vec3* vertices, int faceIndex) const
 {
     assert(vertices);
 
     int vertexCount = 0;
 
-    const u8 halfEdgeIndexBegin = mFaces[faceIndex].mHalfEdge;
-    u8 halfEdgeIndex = halfEdgeIndexBegin;
+    const int halfEdgeIndexBegin = mFaces[faceIndex].mHalfEdge;
+    int halfEdgeIndex = halfEdgeIndexBegin;
     do
     {
-        const HalfEdge halfEdge = mHalfEdges[halfEdgeIndex];
+        const HalfEdge halfEdge = GetHalfEdge(halfEdgeIndex);
         vertices[vertexCount++] = mVertexPositions[halfEdge.mOrigin];
         halfEdgeIndex = halfEdge.mNext;
     }
@@ -375,18 +734,18 @@ int ConvexHull::GetVertices(Vec3 vertices[PRIMITIVE_MAX], u8 faceIndex) const
     return vertexCount;
 }
 
-int ConvexHull::GetClipVertices(ClipVertex vertices[PRIMITIVE_MAX], u8 faceIndex) const
+int ConvexHull::GetClipVertices(ClipVertex* vertices, int faceIndex) const
 {
     assert(vertices);
 
     int vertexCount = 0;
 
-    const u8 halfEdgeIndexBegin = mFaces[faceIndex].mHalfEdge;
-    u8 halfEdgeIndex = halfEdgeIndexBegin;
-    u8 prevHalfEdgeIndex = halfEdgeIndex;
+    const u16 halfEdgeIndexBegin = mFaces[faceIndex].mHalfEdge;
+    u16 halfEdgeIndex = halfEdgeIndexBegin;
+    u16 prevHalfEdgeIndex = halfEdgeIndex;
     do
     {
-        const HalfEdge halfEdge = mHalfEdges[halfEdgeIndex];
+        const HalfEdge halfEdge = GetHalfEdge(halfEdgeIndex);
 
         vertices[vertexCount].mPosition = mVertexPositions[halfEdge.mOrigin];
         vertices[vertexCount].mFeatureId.mInHalfEdgeI = prevHalfEdgeIndex;
@@ -406,23 +765,19 @@ int ConvexHull::GetClipVertices(ClipVertex vertices[PRIMITIVE_MAX], u8 faceIndex
     return vertexCount;
 }
 
-int ConvexHull::GetSidePlanes(
-    Plane planes[PRIMITIVE_MAX],
-    u8 planesHalfEdgeIndices[PRIMITIVE_MAX],
-    u8 faceIndex
-) const
+int ConvexHull::GetSidePlanes(Plane* planes, u16* planesHalfEdgeIndices, int faceIndex) const
 {
     assert(planes);
     assert(planesHalfEdgeIndices);
 
     int planesCount = 0;
 
-    const u8 halfEdgeIndexBegin = mFaces[faceIndex].mHalfEdge;
-    u8 halfEdgeIndex = halfEdgeIndexBegin;
+    const int halfEdgeIndexBegin = mFaces[faceIndex].mHalfEdge;
+    int halfEdgeIndex = halfEdgeIndexBegin;
     do
     {
-        const HalfEdge halfEdge = mHalfEdges[halfEdgeIndex];
-        const HalfEdge twinHalfEdge = mHalfEdges[halfEdge.mTwin];
+        const HalfEdge halfEdge = GetHalfEdge(halfEdgeIndex);
+        const HalfEdge twinHalfEdge = GetHalfEdge(halfEdge.mTwin);
         planesHalfEdgeIndices[planesCount] = halfEdge.mTwin;
         planes[planesCount++] = mFacePlanes[twinHalfEdge.mFace];
         halfEdgeIndex = halfEdge.mNext;
@@ -457,7 +812,7 @@ ConvexHull::ConsistencyResult ConvexHull::CheckConsistency() const
 
     for (int i = 0; i < mFacesCount; ++i)
     {
-        u8 firstHalfEdgeIndex = mFaces[i].mHalfEdge;
+        const int firstHalfEdgeIndex = mFaces[i].mHalfEdge;
         if (firstHalfEdgeIndex == PRIMITIVE_NULL)
         {
             return ConsistencyResult::HalfEdgeNull;
@@ -466,11 +821,11 @@ ConvexHull::ConsistencyResult ConvexHull::CheckConsistency() const
         {
             return ConsistencyResult::HalfEdgeIndexOutOfBounds;
         }
-        if (!IsConsistent(mHalfEdges[firstHalfEdgeIndex]))
+        if (!IsConsistent(GetHalfEdge(firstHalfEdgeIndex)))
         {
             return ConsistencyResult::HalfEdgeSomethingNull;
         }
-        u8 halfEdgeIndex = firstHalfEdgeIndex;
+        int halfEdgeIndex = firstHalfEdgeIndex;
         do
         {
             if (halfEdgeIndex >= mHalfEdgesCount)
@@ -478,7 +833,7 @@ ConvexHull::ConsistencyResult ConvexHull::CheckConsistency() const
                 return ConsistencyResult::HalfEdgeIndexOutOfBounds;
             }
 
-            const HalfEdge halfEdge = mHalfEdges[halfEdgeIndex];
+            const HalfEdge halfEdge = GetHalfEdge(halfEdgeIndex);
 
             if (!IsConsistent(halfEdge))
             {
@@ -496,7 +851,7 @@ ConvexHull::ConsistencyResult ConvexHull::CheckConsistency() const
                 return ConsistencyResult::FaceWrongNormal;
             }
 
-            halfEdgeIndex = mHalfEdges[halfEdgeIndex].mNext;
+            halfEdgeIndex = halfEdge.mNext;
         }
         while (halfEdgeIndex != firstHalfEdgeIndex);
     }
@@ -504,40 +859,49 @@ ConvexHull::ConsistencyResult ConvexHull::CheckConsistency() const
     // So we can skip every other half-edge in edge x edge SAT testing.
     for (int i = 0; i < mHalfEdgesCount; i += 2)
     {
-        const HalfEdge halfEdge = mHalfEdges[i];
-        const HalfEdge twin = mHalfEdges[halfEdge.mTwin];
-
+        const HalfEdge halfEdge = GetHalfEdge(i);
         if (halfEdge.mTwin != i + 1)
         {
             return ConsistencyResult::HalfEdgeWrongTwin;
         }
 
+        const HalfEdge twin = GetHalfEdge(halfEdge.mTwin);
         if (twin.mTwin != i)
         {
             return ConsistencyResult::HalfEdgeWrongTwin;
         }
     }
 
+    for (int i = 0; i < mVerticesCount; ++i)
+    {
+        const int halfEdgeIndex = mVertices[i].mHalfEdge;
+        if (halfEdgeIndex >= mHalfEdgesCount || GetHalfEdge(halfEdgeIndex).mOrigin != i)
+        {
+            return ConsistencyResult::VertexWrongHalfEdge;
+        }
+    }
+
     return ConsistencyResult::Ok;
 }
 
+#ifdef PHYSICS_DEBUG
 void ConvexHull::DebugDraw() const
 {
     for (int i = 0; i < mFacesCount; ++i)
     {
         const ConvexHull::Face face = mFaces[i];
-        const u8 firstEdgeIdx = face.mHalfEdge;
-        u8 edgeIndex = face.mHalfEdge;
+        const int firstEdgeIdx = face.mHalfEdge;
+        int edgeIndex = face.mHalfEdge;
         do
         {
-            const ConvexHull::HalfEdge edge = mHalfEdges[edgeIndex];
-            const ConvexHull::HalfEdge edgeNext = mHalfEdges[edge.mNext];
+            const ConvexHull::HalfEdge edge = GetHalfEdge(edgeIndex);
+            const ConvexHull::HalfEdge edgeNext = GetHalfEdge(edge.mNext);
             gRenderer.DrawLine(
                 mVertexPositions[edge.mOrigin],
                 mVertexPositions[edgeNext.mOrigin],
                 gColorSequence[i % gColorSequenceCount]
             );
-            edgeIndex = mHalfEdges[edgeIndex].mNext;
+            edgeIndex = edge.mNext;
         }
         while (edgeIndex != firstEdgeIdx);
     }
@@ -548,6 +912,7 @@ void ConvexHull::DebugDraw() const
     }
     gRenderer.DrawPoint(mCentroid, 0.05f, {255, 0, 0});
 }
+#endif
 
 Vec3 ClosestPoint(Plane plane, Vec3 point)
 {
@@ -560,8 +925,8 @@ f32 Distance(Plane plane, Vec3 point)
     return Dot(plane.mNormal, point) - plane.mOffset;
 }
 
-f32 Project(Plane plane, const ConvexHull& hull)
+f32 Project(Plane plane, const ConvexHull& hull, Vec3 scale, int& supportIndex)
 {
-    const Vec3 support = hull.GetSupportPoint(-plane.mNormal);
-    return Distance(plane, support);
+    supportIndex = hull.GetSupportPointIndex(-plane.mNormal * scale, supportIndex);
+    return Distance(plane, hull.mVertexPositions[supportIndex] * scale);
 }
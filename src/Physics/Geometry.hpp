@@ -3,7 +3,13 @@
 #include "../Common.hpp"
 
 #include "Config.hpp"
+#include "MassProperties.hpp"
 #include "../Math/Types.hpp"
+#include "../Math/Utils.hpp"
+#include "../Math/Vec3.hpp"
+#include "../Math/FloatW.hpp"
+
+struct Arena;
 
 struct TransformMat
 {
@@ -23,15 +29,99 @@ struct Plane
     f32 mOffset;
 };
 
+// Axis-aligned bounding box.
+struct Aabb
+{
+    Vec3 mMin;
+    Vec3 mMax;
+};
+
+[[nodiscard]]
+inline bool Overlap(const Aabb& a, const Aabb& b)
+{
+    return a.mMin.X() <= b.mMax.X() && a.mMax.X() >= b.mMin.X() && a.mMin.Y() <= b.mMax.Y()
+        && a.mMax.Y() >= b.mMin.Y() && a.mMin.Z() <= b.mMax.Z() && a.mMax.Z() >= b.mMin.Z();
+}
+
+[[nodiscard]]
+inline bool Contains(const Aabb& outer, const Aabb& inner)
+{
+    return outer.mMin.X() <= inner.mMin.X() && outer.mMin.Y() <= inner.mMin.Y()
+        && outer.mMin.Z() <= inner.mMin.Z() && inner.mMax.X() <= outer.mMax.X()
+        && inner.mMax.Y() <= outer.mMax.Y() && inner.mMax.Z() <= outer.mMax.Z();
+}
+
+[[nodiscard]]
+inline Aabb Union(const Aabb& a, const Aabb& b)
+{
+    return {Min(a.mMin, b.mMin), Max(a.mMax, b.mMax)};
+}
+
+// Half of the surface area, the SAH cost metric.
+[[nodiscard]]
+inline f32 HalfArea(const Aabb& a)
+{
+    const Vec3 d = a.mMax - a.mMin;
+    return d.X() * d.Y() + d.Y() * d.Z() + d.Z() * d.X();
+}
+
+[[nodiscard]]
+inline Vec3W SplatW(Vec3 v)
+{
+    return {SplatW(v.X()), SplatW(v.Y()), SplatW(v.Z())};
+}
+
+[[nodiscard]]
+inline Vec3W operator*(const Mat3& m, const Vec3W& v)
+{
+    const Vec3W col0 = SplatW(m.mCol[0]);
+    const Vec3W col1 = SplatW(m.mCol[1]);
+    const Vec3W col2 = SplatW(m.mCol[2]);
+    return col0 * v.mX + col1 * v.mY + col2 * v.mZ;
+}
+
+struct PlaneW
+{
+    Vec3W mNormal;
+    FloatW mOffset;
+};
+
+// Edge with the normals of its two faces, for the edge x edge SAT.
+struct EdgeW
+{
+    Vec3W mOrigin;
+    Vec3W mDirection;
+    Vec3W mNormal1; // Face of the half-edge.
+    Vec3W mNormal2; // Face of its twin.
+};
+
+// Parallel edges of a hull. The normals of their faces are on the great circle perpendicular to
+// the direction (Gauss map), an axis crossing it is on the arc of at most one of the edges.
+struct EdgeDirection
+{
+    Vec3 mDirection; // Unit.
+    int mFirstEdge;  // Into ConvexHull::mDirectionEdges.
+    int mEdgesCount;
+};
+
+// Arc between the normals u and v of the faces of an edge pointing along the direction d. An
+// axis perpendicular to d is on it if it projects non-negatively on both bounds.
+struct DirectionEdge
+{
+    Vec3 mArcStart; // Cross(d, u)
+    Vec3 mArcEnd;   // Cross(v, d)
+    int mEdgeIndex; // Every other half-edge, like HullEdgeQuery.
+};
+
 struct FeatureId
 {
-    static constexpr u8 EDGE_NULL = UINT8_MAX;
+    static constexpr u16 EDGE_NULL = UINT16_MAX;
 
     // R -- reference, I -- incident
-    u8 mInHalfEdgeR;
-    u8 mOutHalfEdgeR;
-    u8 mInHalfEdgeI;
-    u8 mOutHalfEdgeI;
+    u16 mInHalfEdgeR;
+    u16 mOutHalfEdgeR;
+    u16 mInHalfEdgeI;
+    u16 mOutHalfEdgeI;
 
     void Flip();
 };
@@ -42,67 +132,112 @@ struct ClipVertex
     FeatureId mFeatureId;
 };
 
-// Half-edge (DCEL) data structure.
-struct ConvexHull
+// Half-edge (DCEL) data structure. The first cache line holds what the SAT and the clipping
+// read, the arrays are in one block after Pack().
+struct alignas(64) ConvexHull
 {
     using Id = int;
 
-    static constexpr u8 PRIMITIVE_NULL = FeatureId::EDGE_NULL;
-    static constexpr u8 PRIMITIVE_MAX = UINT8_MAX;
+    // Counts of the half-edges, vertices and faces are below it, so no index is PRIMITIVE_NULL.
+    static constexpr u16 PRIMITIVE_NULL = FeatureId::EDGE_NULL;
+    static constexpr int PRIMITIVE_MAX = UINT16_MAX;
+    // Hulls with fewer features store the half-edges with u8 indices.
+    static constexpr int PRIMITIVE_MAX_8 = UINT8_MAX;
+    // The half-edges of a triangulated hull with this many vertices still fit.
+    static constexpr int VERTICES_MAX = (PRIMITIVE_MAX / 2 + 6) / 3;
 
-    struct HalfEdge
+    template <typename Index>
+    struct HalfEdgeT
     {
-        u8 mNext;
-        u8 mTwin;
-        u8 mOrigin;
-        u8 mFace;
-
-        static HalfEdge Null();
+        Index mNext;
+        Index mTwin;
+        Index mOrigin;
+        Index mFace;
     };
+    using HalfEdge = HalfEdgeT<u16>;
+    using HalfEdge8 = HalfEdgeT<u8>;
 
     struct Vertex
     {
-        u8 mHalfEdge;
+        u16 mHalfEdge; // Outgoing.
     };
 
     struct Face
     {
-        u8 mHalfEdge;
+        u16 mHalfEdge;
     };
 
-    Vec3 mCentroid;
-    Vec3 mScale;
-    Vertex* mVertices; // TODO: unused so far.
-    Vec3* mVertexPositions;
     int mVerticesCount;
-    HalfEdge* mHalfEdges;
     int mHalfEdgesCount;
-    Face* mFaces;
-    Plane* mFacePlanes;
     int mFacesCount;
+    int mMaxFaceVerticesCount; // Size of the clipping buffers.
+    Vec3* mVertexPositions;
+    Plane* mFacePlanes;
+    // Exactly one of them is set, read through GetHalfEdge.
+    HalfEdge8* mHalfEdges8;
+    HalfEdge* mHalfEdges16;
+    Face* mFaces;
+    Vertex* mVertices; // Adjacency for the hill climbing.
+
+    // SoA copies for the wide kernels, blocks of FloatW::N elements. The last block is padded
+    // by repeating the last element, so maximums and their first index don't change.
+    Vec3W* mVertexPositionsW;
+    PlaneW* mFacePlanesW;
+    EdgeW* mEdgesW; // Every other half-edge, like the edge x edge SAT loops.
+    // The edges grouped by direction, the edge x edge SAT only pairs the directions.
+    EdgeDirection* mEdgeDirections;
+    DirectionEdge* mDirectionEdges; // mHalfEdgesCount / 2 of them.
+    int mEdgeDirectionsCount;
+
+    Vec3 mCentroid;
+    Vec3 mScale;
     f32 mRadius;
+    // Of the render mesh, scaled by mScale. Computed once in World::AddConvexHull, the bodies
+    // only scale it.
+    MassProperties::Polyhedron mMassProperties;
 
     Slice<Vec3> mMeshPositions;
     Slice<u16> mMeshIndices;
     int mMeshIndicesCount;
 
-    // TODO: after implementing quickhull these specialized functions will become unnecessary.
     void InitBox(Vec3 scale);
     void InitTetrahedron(Vec3 scale);
+    // Quickhull, the hull data and the render mesh go to the arena. Faces closer to coplanar
+    // than the tolerance are merged, 0 picks one from the extent of the points. At most
+    // maxVerticesCount points are added, the farthest ones first. The points are moved so that
+    // the center of mass is at the origin, like the other hulls.
+    // Implementing Quickhull, Dirk Gregorius, GDC 2014.
+    void InitFromPoints(
+        const Vec3* points,
+        int pointsCount,
+        Arena& arena,
+        f32 tolerance = 0.0f,
+        int maxVerticesCount = VERTICES_MAX
+    );
+
+    // Copies the collision data into one 64-byte aligned block of the arena, in the order the
+    // SAT and the clipping read it. The old arrays aren't freed, neither is the render mesh
+    // moved. World::AddConvexHull does it.
+    void Pack(Arena& arena);
 
     Vec3 GetSupportPoint(Vec3 direction) const;
-    HalfEdge GetNext(u8 halfEdgeIndex) const;
-    Vec3 GetOrigin(u8 halfEdgeIndex) const;
-    Vec3 GetTarget(u8 halfEdgeIndex) const;
-    int GetVertices(Vec3 vertices[PRIMITIVE_MAX], u8 faceIndex) const;
-    int GetClipVertices(ClipVertex vertices[PRIMITIVE_MAX], u8 faceIndex) const;
-    int GetSidePlanes(
-        Plane planes[PRIMITIVE_MAX],
-        u8 planesHalfEdgeIndices[PRIMITIVE_MAX],
-        u8 faceIndex
-    ) const;
+    // Hill climbing from startIndex for big hulls, a linear scan is faster for small ones.
+    int GetSupportPointIndex(Vec3 direction, int startIndex) const;
+    // Moves to the neighbour with the largest projection until there is no better one, the
+    // local maximum of a convex hull is the global one.
+    int HillClimbSupportPointIndex(Vec3 direction, int startIndex) const;
+    HalfEdge GetHalfEdge(int halfEdgeIndex) const;
+    HalfEdge GetNext(int halfEdgeIndex) const;
+    Vec3 GetOrigin(int halfEdgeIndex) const;
+    Vec3 GetTarget(int halfEdgeIndex) const;
+    // The buffers hold mMaxFaceVerticesCount elements.
+    int GetVertices(Vec3* vertices, int faceIndex) const;
+    int GetClipVertices(ClipVertex* vertices, int faceIndex) const;
+    int GetSidePlanes(Plane* planes, u16* planesHalfEdgeIndices, int faceIndex) const;
 
+#ifdef PHYSICS_DEBUG
     void DebugDraw() const;
+#endif
 
     enum class ConsistencyResult
     {
@@ -115,20 +250,46 @@ struct ConvexHull
         HalfEdgeWrongFace,
         HalfEdgeWrongTwin,
         FaceWrongNormal,
+        VertexWrongHalfEdge,
     };
 
     ConsistencyResult CheckConsistency() const;
+
+private:
+    // Stored as HalfEdge8 when the hull is small enough, the counts must be set.
+    void InitHalfEdges(const HalfEdge* halfEdges, Arena& arena);
+    void InitVertices(Arena& arena); // From the half-edges.
+    void InitWide(Arena& arena);
+    void InitEdgeDirections(Arena& arena);
 };
 
+inline ConvexHull::HalfEdge ConvexHull::GetHalfEdge(int halfEdgeIndex) const
+{
+    assert(halfEdgeIndex >= 0 && halfEdgeIndex < mHalfEdgesCount);
+    if (mHalfEdges8)
+    {
+        const HalfEdge8 halfEdge = mHalfEdges8[halfEdgeIndex];
+        return {halfEdge.mNext, halfEdge.mTwin, halfEdge.mOrigin, halfEdge.mFace};
+    }
+    return mHalfEdges16[halfEdgeIndex];
+}
+
 int GetSupportPointIndex(const Vec3* vertices, int verticesCount, Vec3 direction);
+int GetSupportPointIndex(const Vec3W* vertices, int verticesCount, Vec3 direction);
+// Picks the kernel of the wide GetSupportPointIndex(), see InitCollideKernels().
+void InitGeometryKernels(bool isAvx2);
 Vec3 GetSupportPoint(const Vec3* vertices, int verticesCount, Vec3 direction);
 int GetSupportPointIndex(const ClipVertex* vertices, int verticesCount, Vec3 direction);
 ClipVertex GetSupportPoint(const ClipVertex* vertices, int verticesCount, Vec3 direction);
 
 Plane Transform(const TransformMat& transform, Plane plane);
+// Plane of a hull scaled by the (non-uniform) scale, the normal is scaled by its inverse.
+Plane Scale(Plane plane, Vec3 scale);
 Vec3 Transform(const TransformMat& transform, Vec3 v);
 Vec3 InverseTransform(const TransformMat& transform, Vec3 v);
 
 Vec3 ClosestPoint(Plane plane, Vec3 point);
 f32 Distance(Plane plane, Vec3 point);
-f32 Project(Plane plane, const ConvexHull& hull);
+// Signed distance of the support point of the scaled hull, supportIndex is where its search
+// starts and is set to the support point.
+f32 Project(Plane plane, const ConvexHull& hull, Vec3 scale, int& supportIndex);
@@ -72,15 +72,13 @@ void CalculateRectangularCuboid(Vec3 size, f32 density, Mat3& inverseInertia, f3
 // Polyhedral Mass Properties (Revisited) David Eberly, Geometric Tools.
 // https://www.geometrictools.com/Documentation/PolyhedralMassProperties.pdf
 // Assumes counterclockwise ordered triangles.
-void CalculatePolyhedronTriangleMesh(
+// Order: 1, x, y, z, xˆ2, yˆ2, zˆ2, xy, yz, zx.
+static void Integrate(
     const Vec3* positions,
     const u16* indices,
     int indicesCount,
-    f32 density,
     Vec3 scale,
-    Mat3& inverseInertia,
-    Vec3& centerOfMass,
-    f32& inverseMass
+    f32 integrals[10]
 )
 {
     assert(positions);
@@ -89,7 +87,6 @@ void CalculatePolyhedronTriangleMesh(
     assert(scale.X() > 0.0f);
     assert(scale.Y() > 0.0f);
     assert(scale.Z() > 0.0f);
-    assert(density > 0.0f);
 
 #define SUBEXPRESSIONS(w0, w1, w2, f1, f2, f3, g0, g1, g2) \
     temp0 = w0 + w1; \
@@ -116,7 +113,10 @@ void CalculatePolyhedronTriangleMesh(
         1.0f / 120.0f
     };
     // clang-format on
-    f32 integrals[10] = {}; // Order: 1, x, y, z, xˆ2, yˆ2, zˆ2, xy, yz, zx.
+    for (int i = 0; i < 10; ++i)
+    {
+        integrals[i] = 0.0f;
+    }
     f32 temp0 = 0.0f;
     f32 temp1 = 0.0f;
     f32 temp2 = 0.0f;
@@ -167,6 +167,25 @@ void CalculatePolyhedronTriangleMesh(
         integrals[i] *= integralsCoefficients[i];
     }
 
+#undef SUBEXPRESSIONS
+}
+
+void CalculatePolyhedronTriangleMesh(
+    const Vec3* positions,
+    const u16* indices,
+    int indicesCount,
+    f32 density,
+    Vec3 scale,
+    Mat3& inverseInertia,
+    Vec3& centerOfMass,
+    f32& inverseMass
+)
+{
+    assert(density > 0.0f);
+
+    f32 integrals[10];
+    Integrate(positions, indices, indicesCount, scale, integrals);
+
     f32 mass = integrals[0];
 
     centerOfMass = {integrals[1] / mass, integrals[2] / mass, integrals[3] / mass};
@@ -206,8 +225,74 @@ void CalculatePolyhedronTriangleMesh(
 
         inverseInertia = Inverse(inertia);
     }
+}
 
-#undef SUBEXPRESSIONS
+Polyhedron CalculatePolyhedron(
+    const Vec3* positions,
+    const u16* indices,
+    int indicesCount,
+    Vec3 scale
+)
+{
+    f32 integrals[10];
+    Integrate(positions, indices, indicesCount, scale, integrals);
+
+    Polyhedron polyhedron;
+    const f32 volume = integrals[0];
+    const Vec3 c = Vec3{integrals[1], integrals[2], integrals[3]} / volume;
+    polyhedron.mVolume = volume;
+    polyhedron.mCenterOfMass = c;
+
+    Mat3& covariance = polyhedron.mCovariance;
+    covariance(0, 0) = integrals[4] - volume * c.X() * c.X();
+    covariance(1, 1) = integrals[5] - volume * c.Y() * c.Y();
+    covariance(2, 2) = integrals[6] - volume * c.Z() * c.Z();
+    covariance(0, 1) = integrals[7] - volume * c.X() * c.Y();
+    covariance(1, 0) = covariance(0, 1);
+    covariance(1, 2) = integrals[8] - volume * c.Y() * c.Z();
+    covariance(2, 1) = covariance(1, 2);
+    covariance(0, 2) = integrals[9] - volume * c.Z() * c.X();
+    covariance(2, 0) = covariance(0, 2);
+
+    return polyhedron;
+}
+
+void CalculateScaledPolyhedron(
+    const Polyhedron& polyhedron,
+    f32 density,
+    Vec3 scale,
+    Mat3& inverseInertia,
+    f32& inverseMass
+)
+{
+    assert(scale.X() > 0.0f);
+    assert(scale.Y() > 0.0f);
+    assert(scale.Z() > 0.0f);
+    assert(density > 0.0f);
+
+    if (density == FLT_MAX)
+    {
+        inverseMass = 0.0f;
+        inverseInertia = Mat3::Zero();
+        return;
+    }
+
+    // x' = S * x, so dV' = det(S) * dV and C' = det(S) * S * C * S.
+    const f32 determinant = scale.X() * scale.Y() * scale.Z();
+    const f32 mass = density * determinant * polyhedron.mVolume;
+    inverseMass = 1.0f / mass;
+
+    Mat3 covariance;
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            covariance(i, j)
+                = density * determinant * scale[i] * scale[j] * polyhedron.mCovariance(i, j);
+        }
+    }
+    const f32 trace = covariance(0, 0) + covariance(1, 1) + covariance(2, 2);
+    inverseInertia = Inverse(trace * Mat3::Identity() - covariance);
 }
 
 }
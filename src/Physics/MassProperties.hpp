@@ -6,6 +6,16 @@
 namespace MassProperties
 {
 
+// Unit density polyhedron, computed once and then scaled to any density and (non-uniform) scale.
+struct Polyhedron
+{
+    f32 mVolume;
+    Vec3 mCenterOfMass;
+    // Second moments of the volume about the center of mass, the inertia tensor is
+    // trace(C) * I - C.
+    Mat3 mCovariance;
+};
+
 void CalculateSphere(f32 radius, f32 density, Mat3& inverseInertia, f32& inverseMass);
 void CalculateRectangularCuboid(Vec3 size, f32 density, Mat3& inverseInertia, f32& inverseMass);
 void CalculatePolyhedronTriangleMesh(
@@ -18,5 +28,19 @@ void CalculatePolyhedronTriangleMesh(
     Vec3& centerOfMass,
     f32& inverseMass
 );
+Polyhedron CalculatePolyhedron(
+    const Vec3* positions,
+    const u16* indices,
+    int indicesCount,
+    Vec3 scale
+);
+// Inertia about the center of mass.
+void CalculateScaledPolyhedron(
+    const Polyhedron& polyhedron,
+    f32 density,
+    Vec3 scale,
+    Mat3& inverseInertia,
+    f32& inverseMass
+);
 
 }
@@ -0,0 +1,118 @@
+#include "PairSet.hpp"
+
+#include "../Arena.hpp"
+#include "../Math/Hash.hpp"
+
+#include <string.h>
+
+static int HomeSlot(u64 pair, int tableCapacity)
+{
+    return static_cast<int>(Hash::Splittable64(pair) & static_cast<u64>(tableCapacity - 1));
+}
+
+void PairSet::Init(int capacity)
+{
+    assert(capacity > 0);
+
+    *this = {};
+    mCapacity = capacity;
+    mPairs = gArenaReset.AllocOrDie<u64>(mCapacity, Arena::FlagNoZero);
+
+    mTableCapacity = 1;
+    while (mTableCapacity < 2 * mCapacity)
+    {
+        mTableCapacity *= 2;
+    }
+    mTable = gArenaReset.AllocOrDie<int>(mTableCapacity, Arena::FlagNoZero);
+    memset(mTable, 0xff, static_cast<size_t>(mTableCapacity) * sizeof(mTable[0]));
+}
+
+// Slot holding the pair or the empty slot where it would go.
+int PairSet::FindSlot(u64 pair) const
+{
+    const int mask = mTableCapacity - 1;
+    int slot = HomeSlot(pair, mTableCapacity);
+    while (mTable[slot] != -1 && mPairs[mTable[slot]] != pair)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+int PairSet::Find(u64 pair) const
+{
+    return mTable[FindSlot(pair)];
+}
+
+void PairSet::Grow()
+{
+    // The old arrays stay in the arena until the world is reset.
+    const u64* const oldPairs = mPairs;
+    const int count = mCount;
+
+    Init(mCapacity * 2);
+    memcpy(mPairs, oldPairs, static_cast<size_t>(count) * sizeof(mPairs[0]));
+    mCount = count;
+    for (int i = 0; i < mCount; ++i)
+    {
+        mTable[FindSlot(mPairs[i])] = i;
+    }
+}
+
+bool PairSet::Add(u64 pair)
+{
+    int slot = FindSlot(pair);
+    if (mTable[slot] != -1)
+    {
+        return false;
+    }
+
+    if (mCount == mCapacity)
+    {
+        Grow();
+        slot = FindSlot(pair);
+    }
+
+    mPairs[mCount] = pair;
+    mTable[slot] = mCount;
+    ++mCount;
+    return true;
+}
+
+void PairSet::RemoveAt(int index)
+{
+    assert(index >= 0 && index < mCount);
+
+    // Backward shift deletion, linear probing has no tombstones then.
+    const int mask = mTableCapacity - 1;
+    int hole = FindSlot(mPairs[index]);
+    assert(mTable[hole] == index);
+    int slot = hole;
+    for (;;)
+    {
+        slot = (slot + 1) & mask;
+        if (mTable[slot] == -1)
+        {
+            break;
+        }
+        // The entry can fill the hole if its home slot isn't cyclically in (hole, slot].
+        const int home = HomeSlot(mPairs[mTable[slot]], mTableCapacity);
+        const bool isHomeBetween
+            = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+        if (!isHomeBetween)
+        {
+            mTable[hole] = mTable[slot];
+            hole = slot;
+        }
+    }
+    mTable[hole] = -1;
+
+    // Swap-remove from the dense array.
+    const int last = mCount - 1;
+    if (index != last)
+    {
+        mPairs[index] = mPairs[last];
+        mTable[FindSlot(mPairs[index])] = index;
+    }
+    --mCount;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../Common.hpp"
+
+// Set of body pairs (ContactManifold::Key as u64), persistent between steps.
+// Pairs are dense for iteration, the lookup table is open addressing (linear probing)
+// with indices into the dense array.
+struct PairSet
+{
+    u64* mPairs; // In gArenaReset.
+    int mCount;
+    int mCapacity;
+    int* mTable; // -1 -- empty slot, power of two and at least twice mCapacity.
+    int mTableCapacity;
+
+    void Init(int capacity);
+    int Find(u64 pair) const; // Index in mPairs, -1 if not found.
+    bool Add(u64 pair); // False if the pair is already there.
+    void RemoveAt(int index); // The last pair moves to index.
+
+private:
+    int FindSlot(u64 pair) const;
+    void Grow();
+};
@@ -0,0 +1,584 @@
+#include "Geometry.hpp"
+
+#include "../Arena.hpp"
+#include "../Math/Utils.hpp"
+#include "../Math/Vec3.hpp"
+
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+
+// Triangles while the hull is built, merged into the ConvexHull faces at the end.
+struct QuickhullHalfEdge
+{
+    int mNext;
+    int mTwin;
+    int mOrigin; // Index of the point.
+    int mFace;
+};
+
+struct QuickhullFace
+{
+    Plane mPlane;
+    int mHalfEdge;
+    int mOutsideHead; // Points above the face, linked by Quickhull::mOutsideNext.
+    int mFarthestPoint;
+    int mVisitStamp;
+    bool mIsDeleted;
+};
+
+struct Quickhull
+{
+    const Vec3* mPoints;
+    f32 mTolerance;
+    Arena* mScratch;
+
+    // Deleted faces stay, the arrays grow.
+    QuickhullHalfEdge* mHalfEdges;
+    int mHalfEdgesCount;
+    QuickhullFace* mFaces;
+    int mFacesCount;
+    int mFacesCapacity;
+
+    // Per point, the face it is above (-1 when it is inside or on the hull) and its distance.
+    int* mOutsideFace;
+    int* mOutsideNext;
+    f32* mOutsideDistance;
+
+    // Boundary of the faces visible from the eye point, counterclockwise.
+    int* mHorizon;
+    int mHorizonCount;
+    int* mNewFaces;
+    int* mVisibleFaces;
+    int mVisibleFacesCount;
+    int mVisitStamp;
+
+    int AddFace(int a, int b, int c);
+    void AssignPoint(int pointIndex, const int* faces, int facesCount);
+    void BuildHorizon(int faceIndex, int firstHalfEdgeIndex, Vec3 eye);
+    void AddPoint(int eyeIndex);
+};
+
+int Quickhull::AddFace(int a, int b, int c)
+{
+    if (mFacesCount == mFacesCapacity)
+    {
+        const int newCapacity = 2 * mFacesCapacity;
+        mFaces = mScratch->ReallocOrDie(mFaces, mFacesCapacity, newCapacity, Arena::FlagNoZero);
+        mHalfEdges = mScratch->ReallocOrDie(
+            mHalfEdges,
+            3 * mFacesCapacity,
+            3 * newCapacity,
+            Arena::FlagNoZero
+        );
+        mFacesCapacity = newCapacity;
+    }
+
+    const int faceIndex = mFacesCount++;
+    const int halfEdgeIndex = mHalfEdgesCount;
+    mHalfEdgesCount += 3;
+
+    const int origins[3] = {a, b, c};
+    for (int i = 0; i < 3; ++i)
+    {
+        mHalfEdges[halfEdgeIndex + i] = {halfEdgeIndex + (i + 1) % 3, -1, origins[i], faceIndex};
+    }
+
+    const Vec3 normal = Normalize(Cross(mPoints[b] - mPoints[a], mPoints[c] - mPoints[a]));
+    mFaces[faceIndex] = {{normal, Dot(normal, mPoints[a])}, halfEdgeIndex, -1, -1, 0, false};
+
+    return faceIndex;
+}
+
+void Quickhull::AssignPoint(int pointIndex, const int* faces, int facesCount)
+{
+    int maxFace = -1;
+    f32 maxDistance = mTolerance;
+    for (int i = 0; i < facesCount; ++i)
+    {
+        const f32 distance = Distance(mFaces[faces[i]].mPlane, mPoints[pointIndex]);
+        if (distance > maxDistance)
+        {
+            maxFace = faces[i];
+            maxDistance = distance;
+        }
+    }
+
+    mOutsideFace[pointIndex] = maxFace;
+    if (maxFace != -1)
+    {
+        QuickhullFace& face = mFaces[maxFace];
+        mOutsideDistance[pointIndex] = maxDistance;
+        mOutsideNext[pointIndex] = face.mOutsideHead;
+        face.mOutsideHead = pointIndex;
+        if (face.mFarthestPoint == -1 || maxDistance > mOutsideDistance[face.mFarthestPoint])
+        {
+            face.mFarthestPoint = pointIndex;
+        }
+    }
+}
+
+// Depth-first search over the faces the eye is above, the edges to the other faces are the
+// horizon. Each face is crossed starting after the edge it was entered through, so the horizon
+// comes out as a loop.
+void Quickhull::BuildHorizon(int faceIndex, int firstHalfEdgeIndex, Vec3 eye)
+{
+    QuickhullFace& face = mFaces[faceIndex];
+    face.mVisitStamp = mVisitStamp;
+    mVisibleFaces[mVisibleFacesCount++] = faceIndex;
+
+    int halfEdgeIndex = firstHalfEdgeIndex;
+    do
+    {
+        const QuickhullHalfEdge twin = mHalfEdges[mHalfEdges[halfEdgeIndex].mTwin];
+        const QuickhullFace& neighbour = mFaces[twin.mFace];
+        if (neighbour.mVisitStamp != mVisitStamp)
+        {
+            if (Distance(neighbour.mPlane, eye) > mTolerance)
+            {
+                BuildHorizon(twin.mFace, twin.mNext, eye);
+            }
+            else
+            {
+                mHorizon[mHorizonCount++] = halfEdgeIndex;
+            }
+        }
+        halfEdgeIndex = mHalfEdges[halfEdgeIndex].mNext;
+    }
+    while (halfEdgeIndex != firstHalfEdgeIndex);
+}
+
+// Replaces the faces visible from the eye point by a cone of triangles from the horizon.
+void Quickhull::AddPoint(int eyeIndex)
+{
+    const Vec3 eye = mPoints[eyeIndex];
+
+    ++mVisitStamp;
+    mHorizonCount = 0;
+    mVisibleFacesCount = 0;
+    const int eyeFace = mOutsideFace[eyeIndex];
+    BuildHorizon(eyeFace, mFaces[eyeFace].mHalfEdge, eye);
+    assert(mHorizonCount >= 3);
+
+    const int firstNewFace = mFacesCount;
+    for (int i = 0; i < mHorizonCount; ++i)
+    {
+        const QuickhullHalfEdge horizon = mHalfEdges[mHorizon[i]];
+        const int faceIndex
+            = AddFace(horizon.mOrigin, mHalfEdges[horizon.mNext].mOrigin, eyeIndex);
+        const int halfEdgeIndex = mFaces[faceIndex].mHalfEdge;
+        mHalfEdges[halfEdgeIndex].mTwin = horizon.mTwin;
+        mHalfEdges[horizon.mTwin].mTwin = halfEdgeIndex;
+    }
+    // Neighbouring triangles of the cone share the edge to the eye.
+    const int newFacesCount = mFacesCount - firstNewFace;
+    for (int i = 0; i < newFacesCount; ++i)
+    {
+        const int toEye = mFaces[firstNewFace + i].mHalfEdge + 1;
+        const int fromEye = mFaces[firstNewFace + (i + 1) % newFacesCount].mHalfEdge + 2;
+        assert(mHalfEdges[mHalfEdges[toEye].mNext].mOrigin == eyeIndex);
+        assert(mHalfEdges[mHalfEdges[fromEye].mNext].mOrigin == mHalfEdges[toEye].mOrigin);
+        mHalfEdges[toEye].mTwin = fromEye;
+        mHalfEdges[fromEye].mTwin = toEye;
+    }
+
+    for (int i = 0; i < newFacesCount; ++i)
+    {
+        mNewFaces[i] = firstNewFace + i;
+    }
+
+    mOutsideFace[eyeIndex] = -1;
+    for (int i = 0; i < mVisibleFacesCount; ++i)
+    {
+        QuickhullFace& face = mFaces[mVisibleFaces[i]];
+        face.mIsDeleted = true;
+        int pointIndex = face.mOutsideHead;
+        while (pointIndex != -1)
+        {
+            const int nextPointIndex = mOutsideNext[pointIndex];
+            if (pointIndex != eyeIndex)
+            {
+                AssignPoint(pointIndex, mNewFaces, newFacesCount);
+            }
+            pointIndex = nextPointIndex;
+        }
+        face.mOutsideHead = -1;
+        face.mFarthestPoint = -1;
+    }
+}
+
+void ConvexHull::InitFromPoints(
+    const Vec3* points,
+    int pointsCount,
+    Arena& arena,
+    f32 tolerance,
+    int maxVerticesCount
+)
+{
+    assert(points);
+    assert(pointsCount >= 4);
+    assert(maxVerticesCount >= 4 && maxVerticesCount <= VERTICES_MAX);
+
+    // The final hull has at most this many vertices, its arrays go before the scratch memory.
+    // The half-edges are built with u16 indices and copied by InitHalfEdges.
+    const int verticesCapacity = Min(pointsCount, maxVerticesCount);
+    const int facesCapacity = 2 * verticesCapacity - 4;
+    const int halfEdgesCapacity = 2 * (3 * verticesCapacity - 6);
+    mVertexPositions = arena.AllocOrDie<Vec3>(verticesCapacity, Arena::FlagNoZero);
+    HalfEdge* const halfEdges = arena.AllocOrDie<HalfEdge>(halfEdgesCapacity, Arena::FlagNoZero);
+    mFaces = arena.AllocOrDie<Face>(facesCapacity, Arena::FlagNoZero);
+    mFacePlanes = arena.AllocOrDie<Plane>(facesCapacity, Arena::FlagNoZero);
+    mMeshIndices.mData = arena.AllocOrDie<u16>(3 * facesCapacity, Arena::FlagNoZero);
+
+    Arena scratch = arena;
+
+    Vec3 extent{0.0f};
+    for (int i = 0; i < pointsCount; ++i)
+    {
+        extent = Max(extent, Abs(points[i]));
+    }
+    if (tolerance == 0.0f)
+    {
+        tolerance = 3.0f * FLT_EPSILON * (extent.X() + extent.Y() + extent.Z());
+    }
+
+    Quickhull qh{};
+    qh.mPoints = points;
+    qh.mTolerance = tolerance;
+    qh.mScratch = &scratch;
+    // The hull has at most facesCapacity faces and 3 * verticesCapacity edges at any time.
+    qh.mFacesCapacity = 4 * facesCapacity;
+    qh.mFaces = scratch.AllocOrDie<QuickhullFace>(qh.mFacesCapacity, Arena::FlagNoZero);
+    qh.mHalfEdges
+        = scratch.AllocOrDie<QuickhullHalfEdge>(3 * qh.mFacesCapacity, Arena::FlagNoZero);
+    qh.mOutsideFace = scratch.AllocOrDie<int>(pointsCount, Arena::FlagNoZero);
+    qh.mOutsideNext = scratch.AllocOrDie<int>(pointsCount, Arena::FlagNoZero);
+    qh.mOutsideDistance = scratch.AllocOrDie<f32>(pointsCount, Arena::FlagNoZero);
+    qh.mHorizon = scratch.AllocOrDie<int>(3 * verticesCapacity, Arena::FlagNoZero);
+    qh.mNewFaces = scratch.AllocOrDie<int>(3 * verticesCapacity, Arena::FlagNoZero);
+    qh.mVisibleFaces = scratch.AllocOrDie<int>(facesCapacity, Arena::FlagNoZero);
+
+    // Initial tetrahedron: the farthest pair of the extreme points along the axes, the point
+    // farthest from their line and the point farthest from the plane of the three.
+    int extremes[6]{};
+    for (int i = 0; i < pointsCount; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (points[i][axis] < points[extremes[2 * axis]][axis])
+            {
+                extremes[2 * axis] = i;
+            }
+            if (points[i][axis] > points[extremes[2 * axis + 1]][axis])
+            {
+                extremes[2 * axis + 1] = i;
+            }
+        }
+    }
+    int i0 = 0;
+    int i1 = 0;
+    f32 maxDistanceSq = -1.0f;
+    for (int i = 0; i < 6; ++i)
+    {
+        for (int j = i + 1; j < 6; ++j)
+        {
+            const f32 distanceSq = MagnitudeSq(points[extremes[j]] - points[extremes[i]]);
+            if (distanceSq > maxDistanceSq)
+            {
+                i0 = extremes[i];
+                i1 = extremes[j];
+                maxDistanceSq = distanceSq;
+            }
+        }
+    }
+    const Vec3 line = Normalize(points[i1] - points[i0]);
+    int i2 = -1;
+    f32 maxDistance = tolerance;
+    for (int i = 0; i < pointsCount; ++i)
+    {
+        const f32 distance = Magnitude(Cross(points[i] - points[i0], line));
+        if (distance > maxDistance)
+        {
+            i2 = i;
+            maxDistance = distance;
+        }
+    }
+    assert(i2 != -1 && "Collinear points.");
+    const Vec3 normal = Normalize(Cross(points[i1] - points[i0], points[i2] - points[i0]));
+    int i3 = -1;
+    maxDistance = tolerance;
+    for (int i = 0; i < pointsCount; ++i)
+    {
+        const f32 distance = Abs(Dot(normal, points[i] - points[i0]));
+        if (distance > maxDistance)
+        {
+            i3 = i;
+            maxDistance = distance;
+        }
+    }
+    assert(i3 != -1 && "Coplanar points.");
+    // The base faces away from the apex.
+    if (Dot(normal, points[i3] - points[i0]) > 0.0f)
+    {
+        Swap(i1, i2);
+    }
+
+    const int tetrahedron[4][3] = {{i0, i1, i2}, {i1, i0, i3}, {i2, i1, i3}, {i0, i2, i3}};
+    for (const auto& triangle : tetrahedron)
+    {
+        qh.AddFace(triangle[0], triangle[1], triangle[2]);
+    }
+    for (int i = 0; i < qh.mHalfEdgesCount; ++i)
+    {
+        const int origin = qh.mHalfEdges[i].mOrigin;
+        const int target = qh.mHalfEdges[qh.mHalfEdges[i].mNext].mOrigin;
+        for (int j = 0; j < qh.mHalfEdgesCount; ++j)
+        {
+            const int twinTarget = qh.mHalfEdges[qh.mHalfEdges[j].mNext].mOrigin;
+            if (qh.mHalfEdges[j].mOrigin == target && twinTarget == origin)
+            {
+                qh.mHalfEdges[i].mTwin = j;
+            }
+        }
+        assert(qh.mHalfEdges[i].mTwin != -1);
+    }
+
+    const int initialFaces[4] = {0, 1, 2, 3};
+    for (int i = 0; i < pointsCount; ++i)
+    {
+        qh.mOutsideFace[i] = -1;
+        if (i != i0 && i != i1 && i != i2 && i != i3)
+        {
+            qh.AssignPoint(i, initialFaces, 4);
+        }
+    }
+
+    // The farthest point first, so the cap drops the least important ones.
+    for (int verticesCount = 4; verticesCount < verticesCapacity; ++verticesCount)
+    {
+        int eyeIndex = -1;
+        f32 maxOutsideDistance = 0.0f;
+        for (int i = 0; i < qh.mFacesCount; ++i)
+        {
+            const int pointIndex = qh.mFaces[i].mFarthestPoint;
+            if (pointIndex != -1 && qh.mOutsideDistance[pointIndex] > maxOutsideDistance)
+            {
+                eyeIndex = pointIndex;
+                maxOutsideDistance = qh.mOutsideDistance[pointIndex];
+            }
+        }
+        if (eyeIndex == -1)
+        {
+            break;
+        }
+        qh.AddPoint(eyeIndex);
+    }
+
+    // Merges coplanar triangles into groups, every vertex of the group is within the tolerance
+    // from the plane of the triangle it grew from.
+    int* faceGroups = scratch.AllocOrDie<int>(qh.mFacesCount, Arena::FlagNoZero);
+    int* groupsStack = scratch.AllocOrDie<int>(qh.mFacesCount, Arena::FlagNoZero);
+    memset(faceGroups, 0xff, static_cast<size_t>(qh.mFacesCount) * sizeof(faceGroups[0]));
+    int groupsCount = 0;
+    for (int i = 0; i < qh.mFacesCount; ++i)
+    {
+        if (qh.mFaces[i].mIsDeleted || faceGroups[i] != -1)
+        {
+            continue;
+        }
+        const Plane plane = qh.mFaces[i].mPlane;
+        faceGroups[i] = groupsCount;
+        int stackCount = 0;
+        groupsStack[stackCount++] = i;
+        while (stackCount > 0)
+        {
+            const int faceIndex = groupsStack[--stackCount];
+            const int firstHalfEdgeIndex = qh.mFaces[faceIndex].mHalfEdge;
+            int halfEdgeIndex = firstHalfEdgeIndex;
+            do
+            {
+                const QuickhullHalfEdge twin = qh.mHalfEdges[qh.mHalfEdges[halfEdgeIndex].mTwin];
+                const QuickhullFace& neighbour = qh.mFaces[twin.mFace];
+                // The only vertex of the neighbour not on the shared edge.
+                const int apex = qh.mHalfEdges[qh.mHalfEdges[twin.mNext].mNext].mOrigin;
+                if (faceGroups[twin.mFace] == -1
+                    && Dot(neighbour.mPlane.mNormal, plane.mNormal) > 0.0f
+                    && Abs(Distance(plane, points[apex])) <= tolerance)
+                {
+                    faceGroups[twin.mFace] = groupsCount;
+                    groupsStack[stackCount++] = twin.mFace;
+                }
+                halfEdgeIndex = qh.mHalfEdges[halfEdgeIndex].mNext;
+            }
+            while (halfEdgeIndex != firstHalfEdgeIndex);
+        }
+        ++groupsCount;
+    }
+
+    // Half-edges between groups are the edges of the merged faces, a point stays a vertex if
+    // at least three faces meet there (not inside a face or on a straight edge).
+    int* vertexIndices = scratch.AllocOrDie<int>(pointsCount);
+    for (int i = 0; i < qh.mHalfEdgesCount; ++i)
+    {
+        const QuickhullHalfEdge halfEdge = qh.mHalfEdges[i];
+        if (!qh.mFaces[halfEdge.mFace].mIsDeleted
+            && faceGroups[halfEdge.mFace] != faceGroups[qh.mHalfEdges[halfEdge.mTwin].mFace])
+        {
+            ++vertexIndices[halfEdge.mOrigin];
+        }
+    }
+    mVerticesCount = 0;
+    for (int i = 0; i < pointsCount; ++i)
+    {
+        vertexIndices[i] = vertexIndices[i] >= 3 ? mVerticesCount++ : -1;
+        if (vertexIndices[i] != -1)
+        {
+            mVertexPositions[vertexIndices[i]] = points[i];
+        }
+    }
+    assert(mVerticesCount <= verticesCapacity);
+
+    // A boundary half-edge from a vertex starts every outline.
+    int* groupsBoundary = scratch.AllocOrDie<int>(groupsCount, Arena::FlagNoZero);
+    for (int i = 0; i < qh.mHalfEdgesCount; ++i)
+    {
+        const QuickhullHalfEdge halfEdge = qh.mHalfEdges[i];
+        const int group = faceGroups[halfEdge.mFace];
+        if (!qh.mFaces[halfEdge.mFace].mIsDeleted && vertexIndices[halfEdge.mOrigin] != -1
+            && group != faceGroups[qh.mHalfEdges[halfEdge.mTwin].mFace])
+        {
+            groupsBoundary[group] = i;
+        }
+    }
+
+    // Outlines of the groups are counterclockwise, split into chains of boundary half-edges
+    // between the vertices. The ConvexHull faces go clockwise (seen from the outside), so the
+    // half-edge of a chain runs from its end to its start. Twins are next to each other, the
+    // chain found first gets the even index, the other side finds it through the tags.
+    int* chainHalfEdges = scratch.AllocOrDie<int>(qh.mHalfEdgesCount, Arena::FlagNoZero);
+    int* outline = scratch.AllocOrDie<int>(mVerticesCount, Arena::FlagNoZero);
+    int* outlineHalfEdges = scratch.AllocOrDie<int>(mVerticesCount, Arena::FlagNoZero);
+    memset(chainHalfEdges, 0xff, static_cast<size_t>(qh.mHalfEdgesCount) * sizeof(int));
+    mFacesCount = groupsCount;
+    mHalfEdgesCount = 0;
+    mMeshIndices.mCount = 0;
+    for (int i = 0; i < groupsCount; ++i)
+    {
+        int outlineCount = 0;
+        const int firstHalfEdgeIndex = groupsBoundary[i];
+        int halfEdgeIndex = firstHalfEdgeIndex;
+        int chainHalfEdge = -1;
+        do
+        {
+            const QuickhullHalfEdge halfEdge = qh.mHalfEdges[halfEdgeIndex];
+            const int vertexIndex = vertexIndices[halfEdge.mOrigin];
+            if (vertexIndex != -1)
+            {
+                outline[outlineCount] = vertexIndex;
+                chainHalfEdge = chainHalfEdges[halfEdge.mTwin];
+                if (chainHalfEdge == -1)
+                {
+                    chainHalfEdge = mHalfEdgesCount;
+                    mHalfEdgesCount += 2;
+                    assert(mHalfEdgesCount <= halfEdgesCapacity);
+                }
+                else
+                {
+                    chainHalfEdge ^= 1;
+                }
+                outlineHalfEdges[outlineCount++] = chainHalfEdge;
+            }
+            chainHalfEdges[halfEdgeIndex] = chainHalfEdge;
+            // Around the target to the next half-edge on the boundary.
+            halfEdgeIndex = halfEdge.mNext;
+            while (faceGroups[qh.mHalfEdges[qh.mHalfEdges[halfEdgeIndex].mTwin].mFace] == i)
+            {
+                halfEdgeIndex = qh.mHalfEdges[qh.mHalfEdges[halfEdgeIndex].mTwin].mNext;
+            }
+        }
+        while (halfEdgeIndex != firstHalfEdgeIndex);
+        assert(outlineCount >= 3);
+
+        for (int j = 0; j < outlineCount; ++j)
+        {
+            const int previous = (j + outlineCount - 1) % outlineCount;
+            halfEdges[outlineHalfEdges[j]] = {
+                static_cast<u16>(outlineHalfEdges[previous]),
+                static_cast<u16>(outlineHalfEdges[j] ^ 1),
+                static_cast<u16>(outline[(j + 1) % outlineCount]),
+                static_cast<u16>(i),
+            };
+        }
+        mFaces[i].mHalfEdge = static_cast<u16>(outlineHalfEdges[0]);
+
+        // A fan for the render mesh, counterclockwise.
+        for (int j = 1; j + 1 < outlineCount; ++j)
+        {
+            mMeshIndices.mData[mMeshIndices.mCount++] = static_cast<u16>(outline[0]);
+            mMeshIndices.mData[mMeshIndices.mCount++] = static_cast<u16>(outline[j]);
+            mMeshIndices.mData[mMeshIndices.mCount++] = static_cast<u16>(outline[j + 1]);
+        }
+    }
+    InitHalfEdges(halfEdges, arena);
+
+    // Center of mass of the tetrahedra from the first vertex to the triangles.
+    const Vec3 apex = mVertexPositions[0];
+    Vec3 centroid{0.0f};
+    f32 volume = 0.0f;
+    for (int i = 0; i < mMeshIndices.mCount; i += 3)
+    {
+        const Vec3 a = mVertexPositions[mMeshIndices.mData[i]];
+        const Vec3 b = mVertexPositions[mMeshIndices.mData[i + 1]];
+        const Vec3 c = mVertexPositions[mMeshIndices.mData[i + 2]];
+        const f32 tetrahedronVolume = TripleProduct(a - apex, b - apex, c - apex);
+        centroid += tetrahedronVolume * (apex + a + b + c);
+        volume += tetrahedronVolume;
+    }
+    assert(volume > 0.0f);
+    centroid /= 4.0f * volume;
+
+    mRadius = 0.0f;
+    for (int i = 0; i < mVerticesCount; ++i)
+    {
+        mVertexPositions[i] -= centroid;
+        mRadius = Max(mRadius, Magnitude(mVertexPositions[i]));
+    }
+    mCentroid = Vec3{0.0f};
+    mScale = Vec3{1.0f};
+
+    // Newell's method, the offset goes through the average of the vertices.
+    for (int i = 0; i < mFacesCount; ++i)
+    {
+        Vec3 faceNormal{0.0f};
+        Vec3 faceCenter{0.0f};
+        int faceVerticesCount = 0;
+        const int firstHalfEdgeIndex = mFaces[i].mHalfEdge;
+        int halfEdgeIndex = firstHalfEdgeIndex;
+        do
+        {
+            const Vec3 origin = GetOrigin(halfEdgeIndex);
+            const Vec3 target = GetTarget(halfEdgeIndex);
+            faceNormal += Cross(target, origin);
+            faceCenter += origin;
+            ++faceVerticesCount;
+            halfEdgeIndex = GetHalfEdge(halfEdgeIndex).mNext;
+        }
+        while (halfEdgeIndex != firstHalfEdgeIndex);
+        faceNormal = Normalize(faceNormal);
+        faceCenter /= static_cast<f32>(faceVerticesCount);
+        mFacePlanes[i] = {faceNormal, Dot(faceNormal, faceCenter)};
+    }
+
+    mMeshPositions = {mVertexPositions, mVerticesCount};
+
+    InitVertices(arena);
+    InitWide(arena);
+    InitEdgeDirections(arena);
+
+    const ConsistencyResult consistency = CheckConsistency();
+    if (consistency != ConsistencyResult::Ok)
+    {
+        fprintf(stderr, "Quickhull consistency error: %d\n", static_cast<int>(consistency));
+    }
+    assert(consistency == ConsistencyResult::Ok);
+}
@@ -0,0 +1,199 @@
+#include "SweepAndPrune.hpp"
+
+#include "../Arena.hpp"
+#include "../Utils.hpp"
+#include "../Math/FloatW.hpp"
+#include "World.hpp"
+
+#include <stdlib.h>
+
+void SweepAndPrune::Init(int capacity)
+{
+    assert(capacity > 0);
+
+    *this = {};
+    mCapacity = capacity;
+    mAabbs = gArenaReset.AllocOrDie<Aabb>(mCapacity, Arena::FlagNoZero);
+    mOrder = gArenaReset.AllocOrDie<int>(mCapacity, Arena::FlagNoZero);
+}
+
+void SweepAndPrune::Add(int id, const Aabb& aabb)
+{
+    assert(id >= 0);
+
+    if (id >= mCapacity || mCount == mCapacity)
+    {
+        const int newCapacity = Max(mCapacity * 2, id + 1);
+        mAabbs = gArenaReset.ReallocOrDie(mAabbs, mCapacity, newCapacity, Arena::FlagNoZero);
+        mOrder = gArenaReset.ReallocOrDie(mOrder, mCapacity, newCapacity, Arena::FlagNoZero);
+        mCapacity = newCapacity;
+    }
+
+    // Goes to the end, the next Update sorts it in.
+    mAabbs[id] = aabb;
+    mOrder[mCount++] = id;
+}
+
+struct SortKey
+{
+    f32 mMin;
+    int mId;
+};
+
+static int CompareSortKeys(const void* a, const void* b)
+{
+    const SortKey* const ka = static_cast<const SortKey*>(a);
+    const SortKey* const kb = static_cast<const SortKey*>(b);
+    if (ka->mMin != kb->mMin)
+    {
+        return ka->mMin < kb->mMin ? -1 : 1;
+    }
+    return ka->mId - kb->mId;
+}
+
+void SweepAndPrune::Update(Arena& scratch)
+{
+    if (mCount == 0)
+    {
+        return;
+    }
+
+    // Variance of the centers (times count), the sweep prunes best along the widest spread.
+    Vec3 sum{0.0f};
+    Vec3 sumSq{0.0f};
+    Vec3 maxSize{0.0f};
+    for (int i = 0; i < mCount; ++i)
+    {
+        const Aabb& aabb = mAabbs[mOrder[i]];
+        const Vec3 center = (aabb.mMin + aabb.mMax) * 0.5f;
+        sum += center;
+        sumSq += center * center;
+        maxSize = Max(maxSize, aabb.mMax - aabb.mMin);
+    }
+    const Vec3 variance = sumSq - sum * sum / static_cast<f32>(mCount);
+    int axis = 0;
+    for (int i = 1; i < 3; ++i)
+    {
+        if (variance[i] > variance[axis])
+        {
+            axis = i;
+        }
+    }
+
+    // Some hysteresis, switching the axis means a full sort.
+    constexpr f32 AXIS_SWITCH_RATIO = 1.2f;
+    if (axis != mAxis && variance[axis] > AXIS_SWITCH_RATIO * variance[mAxis])
+    {
+        mAxis = axis;
+        mMaxSize = maxSize[mAxis];
+        SortKey* const keys = scratch.AllocOrDie<SortKey>(mCount, Arena::FlagNoZero);
+        for (int i = 0; i < mCount; ++i)
+        {
+            keys[i] = {mAabbs[mOrder[i]].mMin[mAxis], mOrder[i]};
+        }
+        qsort(keys, static_cast<size_t>(mCount), sizeof(keys[0]), CompareSortKeys);
+        for (int i = 0; i < mCount; ++i)
+        {
+            mOrder[i] = keys[i].mId;
+        }
+        return;
+    }
+
+    mMaxSize = maxSize[mAxis];
+
+    // Nearly sorted from the last step, insertion sort is close to linear.
+    for (int i = 1; i < mCount; ++i)
+    {
+        const int id = mOrder[i];
+        const f32 key = mAabbs[id].mMin[mAxis];
+        int j = i - 1;
+        while (j >= 0 && mAabbs[mOrder[j]].mMin[mAxis] > key)
+        {
+            mOrder[j + 1] = mOrder[j];
+            --j;
+        }
+        mOrder[j + 1] = id;
+    }
+}
+
+int SweepAndPrune::FindPairs(Arena& arena, u64** pairs) const
+{
+    assert(pairs);
+
+    // Sorted boxes in SoA, padded so the wide loads past the end stay in bounds.
+    const int axisB = (mAxis + 1) % 3;
+    const int axisC = (mAxis + 2) % 3;
+    const int paddedCount = mCount + FLOAT_W_WIDTH;
+    f32* const minA = arena.AllocOrDie<f32>(paddedCount);
+    f32* const maxA = arena.AllocOrDie<f32>(paddedCount);
+    f32* const minB = arena.AllocOrDie<f32>(paddedCount);
+    f32* const maxB = arena.AllocOrDie<f32>(paddedCount);
+    f32* const minC = arena.AllocOrDie<f32>(paddedCount);
+    f32* const maxC = arena.AllocOrDie<f32>(paddedCount);
+    for (int i = 0; i < mCount; ++i)
+    {
+        const Aabb& aabb = mAabbs[mOrder[i]];
+        minA[i] = aabb.mMin[mAxis];
+        maxA[i] = aabb.mMax[mAxis];
+        minB[i] = aabb.mMin[axisB];
+        maxB[i] = aabb.mMax[axisB];
+        minC[i] = aabb.mMin[axisC];
+        maxC[i] = aabb.mMax[axisC];
+    }
+
+    // The last allocation, so growing it doesn't copy.
+    int capacity = Max(mCount, 16);
+    int count = 0;
+    u64* out = arena.AllocOrDie<u64>(capacity, Arena::FlagNoZero);
+
+    for (int i = 0; i < mCount; ++i)
+    {
+        // Boxes starting before this one ends on the sorted axis.
+        int end = i + 1;
+        while (end < mCount && minA[end] <= maxA[i])
+        {
+            ++end;
+        }
+
+        const FloatW minBi = SplatW(minB[i]);
+        const FloatW maxBi = SplatW(maxB[i]);
+        const FloatW minCi = SplatW(minC[i]);
+        const FloatW maxCi = SplatW(maxC[i]);
+        for (int j = i + 1; j < end; j += FLOAT_W_WIDTH)
+        {
+            const FloatW overlapB = AndW(
+                LessEqualW(LoadUnalignedW(minB + j), maxBi),
+                LessEqualW(minBi, LoadUnalignedW(maxB + j))
+            );
+            const FloatW overlapC = AndW(
+                LessEqualW(LoadUnalignedW(minC + j), maxCi),
+                LessEqualW(minCi, LoadUnalignedW(maxC + j))
+            );
+            int mask = MoveMaskW(AndW(overlapB, overlapC));
+            if (end - j < FLOAT_W_WIDTH)
+            {
+                mask &= (1 << (end - j)) - 1;
+            }
+
+            for (int lane = 0; mask != 0; ++lane, mask >>= 1)
+            {
+                if ((mask & 1) == 0)
+                {
+                    continue;
+                }
+                if (count == capacity)
+                {
+                    out = arena.ReallocOrDie(out, capacity, capacity * 2, Arena::FlagNoZero);
+                    capacity *= 2;
+                }
+                const int id1 = mOrder[i];
+                const int id2 = mOrder[j + lane];
+                const ContactManifold::Key key = {Min(id1, id2), Max(id1, id2)};
+                out[count++] = Utils::BitCast<u64>(key);
+            }
+        }
+    }
+
+    *pairs = out;
+    return count;
+}
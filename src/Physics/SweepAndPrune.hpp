@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../Common.hpp"
+
+#include "Geometry.hpp"
+
+struct Arena;
+
+// Sweep-and-prune over AABBs sorted by their min on the axis of greatest variance of the
+// centers. The order is kept between steps, so the insertion sort only fixes what moved.
+// The sweep tests the other two axes FLOAT_W_WIDTH boxes at a time.
+//
+// Real-Time Collision Detection, Christer Ericson, 7.5.
+struct SweepAndPrune
+{
+    Aabb* mAabbs; // Indexed by id, ids are in [0, mCapacity).
+    int* mOrder; // Ids sorted by mAabbs[id].mMin[mAxis].
+    int mCount;
+    int mCapacity;
+    int mAxis;
+    f32 mMaxSize; // Largest box on mAxis, as of the last Update.
+
+    void Init(int capacity); // In gArenaReset, grows.
+    void Add(int id, const Aabb& aabb);
+
+    // Picks the axis and sorts, the boxes are updated through mAabbs before.
+    void Update(Arena& scratch);
+
+    // Overlapping pairs as ContactManifold::Key (min id, max id) in u64, allocated in arena.
+    int FindPairs(Arena& arena, u64** pairs) const;
+
+    // callback(id) for the boxes overlapping aabb, as of the last Update.
+    template <typename F>
+    void Query(const Aabb& aabb, const F& callback) const;
+};
+
+template <typename F>
+void SweepAndPrune::Query(const Aabb& aabb, const F& callback) const
+{
+    // No box starting before the first candidate reaches aabb.
+    const f32 begin = aabb.mMin[mAxis] - mMaxSize;
+    int low = 0;
+    int high = mCount;
+    while (low < high)
+    {
+        const int middle = (low + high) / 2;
+        if (mAabbs[mOrder[middle]].mMin[mAxis] < begin)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    for (int i = low; i < mCount; ++i)
+    {
+        const Aabb& box = mAabbs[mOrder[i]];
+        if (box.mMin[mAxis] > aabb.mMax[mAxis])
+        {
+            break;
+        }
+        if (Overlap(box, aabb))
+        {
+            callback(mOrder[i]);
+        }
+    }
+}
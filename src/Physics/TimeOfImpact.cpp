@@ -0,0 +1,233 @@
+#include "TimeOfImpact.hpp"
+
+#include "Config.hpp"
+#include "Geometry.hpp"
+#include "GJK.hpp"
+#include "../Math/Vec3.hpp"
+#include "../Math/Mat3.hpp"
+#include "../Math/Quat.hpp"
+
+struct SweepRotation
+{
+    Vec3 mAxis;
+    f32 mAngle; // During the whole step.
+};
+
+static SweepRotation GetSweepRotation(const Sweep& sweep)
+{
+    Quat delta = sweep.mOrientation1 * Conjugate(sweep.mOrientation0);
+    // The shortest way.
+    if (delta.W() < 0.0f)
+    {
+        delta = {-delta.W(), -delta.X(), -delta.Y(), -delta.Z()};
+    }
+    const Vec3 v = {delta.X(), delta.Y(), delta.Z()};
+    const f32 sinHalfAngle = Magnitude(v);
+    if (sinHalfAngle < 1e-6f)
+    {
+        return {{1.0f, 0.0f, 0.0f}, 0.0f};
+    }
+    return {v / sinHalfAngle, 2.0f * atan2f(sinHalfAngle, delta.W())};
+}
+
+TransformQuat GetSweepTransform(const Sweep& sweep, f32 t)
+{
+    const SweepRotation rotation = GetSweepRotation(sweep);
+    const Vec3 position = sweep.mPosition0 + (sweep.mPosition1 - sweep.mPosition0) * t;
+    const Quat orientation
+        = Normalize(Quat::FromAxis(rotation.mAngle * t, rotation.mAxis) * sweep.mOrientation0);
+    return {orientation, position};
+}
+
+// World space support point, GJK treats a sphere as its center. The hull search starts at
+// startIndex, the previous support point.
+static int GetShapeSupport(
+    const World& world,
+    const Body& body,
+    const TransformMat& transform,
+    Vec3 direction,
+    int startIndex,
+    Vec3& point
+)
+{
+    if (body.mShape == Body::Shape::Sphere)
+    {
+        point = transform.mTranslation;
+        return 0;
+    }
+
+    Vec3 scale{};
+    const ConvexHull& hull = world.GetBodyHull(body, scale);
+    const int index
+        = hull.GetSupportPointIndex(TMul(transform.mRotation, direction) * scale, startIndex);
+    point = Transform(transform, hull.mVertexPositions[index] * scale);
+    return index;
+}
+
+struct ShapesDistance
+{
+    Vec3 mNormal; // From the first shape to the second one.
+    f32 mDistance;
+    bool mIsOverlapping;
+};
+
+static ShapesDistance GetShapesDistance(
+    const World& world,
+    const Body& body1,
+    const TransformMat& transform1,
+    const Body& body2,
+    const TransformMat& transform2
+)
+{
+    GjkSupport support{};
+    const Vec3 direction = {1.0f, 0.0f, 0.0f};
+    support.mIdA = GetShapeSupport(world, body1, transform1, direction, 0, support.mA);
+    support.mIdB = GetShapeSupport(world, body2, transform2, -direction, 0, support.mB);
+
+    GjkSimplex simplex{};
+    while (Gjk(simplex, support))
+    {
+        support.mIdA = GetShapeSupport(
+            world,
+            body1,
+            transform1,
+            support.mDirectionA,
+            support.mIdA,
+            support.mA
+        );
+        support.mIdB = GetShapeSupport(
+            world,
+            body2,
+            transform2,
+            support.mDirectionB,
+            support.mIdB,
+            support.mB
+        );
+    }
+
+    GjkResult result{};
+    GjkAnalyze(result, simplex);
+
+    ShapesDistance distance{};
+    const Vec3 segment = result.mP1 - result.mP0;
+    const f32 segmentMagnitude = Magnitude(segment);
+    if (result.mHit || segmentMagnitude == 0.0f)
+    {
+        distance.mIsOverlapping = true;
+        return distance;
+    }
+
+    distance.mNormal = segment / segmentMagnitude;
+    distance.mDistance = segmentMagnitude;
+    if (body1.mShape == Body::Shape::Sphere)
+    {
+        distance.mDistance -= body1.mRadius;
+    }
+    if (body2.mShape == Body::Shape::Sphere)
+    {
+        distance.mDistance -= body2.mRadius;
+    }
+    distance.mIsOverlapping = distance.mDistance <= 0.0f;
+    return distance;
+}
+
+// Fraction of the step at which the center of the moving body gets within
+// PHYSICS_CCD_PENETRATION of the other body, 1 if it doesn't or starts there.
+static f32 CenterTimeOfImpact(const World& world, const Sweep& sweep, const Body& other)
+{
+    const f32 margin = PHYSICS_CCD_PENETRATION;
+    if (other.mShape == Body::Shape::Sphere)
+    {
+        // |p0 + d * t - c| = r
+        const Vec3 d = sweep.mPosition1 - sweep.mPosition0;
+        const Vec3 m = sweep.mPosition0 - other.mPosition;
+        const f32 a = MagnitudeSq(d);
+        const f32 b = Dot(m, d);
+        const f32 c = MagnitudeSq(m) - Square(other.mRadius + margin);
+        const f32 discriminant = b * b - a * c;
+        if (c <= 0.0f || b >= 0.0f || discriminant < 0.0f)
+        {
+            return 1.0f;
+        }
+        return Min((-b - sqrtf(discriminant)) / a, 1.0f);
+    }
+
+    // The segment is clipped by the face planes pushed out by the margin.
+    Vec3 scale{};
+    const ConvexHull& hull = world.GetBodyHull(other, scale);
+    const TransformMat otherTransform{ToMat3(other.mOrientation), other.mPosition};
+    const Vec3 p0 = InverseTransform(otherTransform, sweep.mPosition0);
+    const Vec3 p1 = InverseTransform(otherTransform, sweep.mPosition1);
+    f32 tEnter = 0.0f;
+    f32 tExit = 1.0f;
+    bool isStartOutside = false;
+    for (int i = 0; i < hull.mFacesCount; ++i)
+    {
+        const Plane plane = Scale(hull.mFacePlanes[i], scale);
+        const f32 d0 = Distance(plane, p0) - margin;
+        const f32 d1 = Distance(plane, p1) - margin;
+        if (d0 > 0.0f && d1 > 0.0f)
+        {
+            return 1.0f;
+        }
+        if (d0 > 0.0f)
+        {
+            isStartOutside = true;
+            tEnter = Max(tEnter, d0 / (d0 - d1));
+        }
+        else if (d1 > 0.0f)
+        {
+            tExit = Min(tExit, d0 / (d0 - d1));
+        }
+    }
+    return isStartOutside && tEnter <= tExit ? tEnter : 1.0f;
+}
+
+f32 TimeOfImpact(const World& world, const Body& body, const Sweep& sweep, const Body& other)
+{
+    const TransformMat otherTransform{ToMat3(other.mOrientation), other.mPosition};
+    const SweepRotation rotation = GetSweepRotation(sweep);
+    const Vec3 translation = sweep.mPosition1 - sweep.mPosition0;
+    // No point of the body is farther from its center than the bounding sphere radius,
+    // a sphere doesn't get any closer by rotating.
+    const f32 angularBound
+        = body.mShape == Body::Shape::Sphere ? 0.0f : rotation.mAngle * body.mRadius;
+
+    f32 t = 0.0f;
+    for (int i = 0; i < PHYSICS_CCD_MAX_ITERATIONS; ++i)
+    {
+        const TransformQuat pose = GetSweepTransform(sweep, t);
+        const TransformMat transform{ToMat3(pose.mRotation), pose.mTranslation};
+        const ShapesDistance distance
+            = GetShapesDistance(world, body, transform, other, otherTransform);
+        if (distance.mIsOverlapping)
+        {
+            // Overlapping at the start is left to the contacts, but they don't stop a body
+            // hitting with a corner and spinning around it, so at least its center can't pass.
+            return i == 0 ? CenterTimeOfImpact(world, sweep, other) : t;
+        }
+
+        // Upper bound of how much closer the bodies get during the rest of the step.
+        const f32 approachBound = Dot(translation, distance.mNormal) + angularBound;
+        if (approachBound <= 0.0f)
+        {
+            return 1.0f;
+        }
+
+        // Close enough, goes slightly in, so the next step has a contact to solve.
+        if (distance.mDistance < PHYSICS_CCD_PENETRATION)
+        {
+            t += (distance.mDistance + PHYSICS_CCD_PENETRATION) / approachBound;
+            return Min(t, 1.0f);
+        }
+
+        t += distance.mDistance / approachBound;
+        if (t >= 1.0f)
+        {
+            return 1.0f;
+        }
+    }
+
+    // Not converged (grazing motion), t is still safe.
+    return t;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "World.hpp"
+
+// Motion of a body during a step, the rotation is at a constant angular velocity.
+struct Sweep
+{
+    Vec3 mPosition0;
+    Vec3 mPosition1;
+    Quat mOrientation0;
+    Quat mOrientation1;
+};
+
+// Pose at fraction t of the step.
+TransformQuat GetSweepTransform(const Sweep& sweep, f32 t);
+
+// Fraction of the step in [0, 1] at which the body moving along the sweep hits the other one
+// (at rest), 1 if it doesn't. The bodies overlap by at most PHYSICS_CCD_PENETRATION then, so
+// the next step creates the contact. If they overlap at the start already, only the center of
+// the moving body is stopped before it enters the other one.
+//
+// Conservative advancement: the body is advanced by the GJK distance divided by an upper
+// bound of the approach speed, so it can't pass through the other one.
+// Impulse-based Dynamic Simulation of Rigid Body Systems, Brian Mirtich, 1996.
+// Continuous Collision, Erin Catto, GDC 2013.
+f32 TimeOfImpact(const World& world, const Body& body, const Sweep& sweep, const Body& other);
@@ -4,23 +4,60 @@
 #include "../Arena.hpp"
 #include "Config.hpp"
 #include "Collide.hpp"
+#include "ContactSolverWide.hpp"
+#include "ConstraintGraph.hpp"
 #include "MassProperties.hpp"
+#include "TimeOfImpact.hpp"
 #include "../Math/Vec3.hpp"
 #include "../Math/Mat3.hpp"
 #include "../Math/Quat.hpp"
 #include "../Math/Hash.hpp"
-#include "../Renderer/Renderer.hpp"
+#include "../Math/FloatW8.hpp"
 #include "../TimeMeter.hpp"
+#include "../ThreadPool.hpp"
+
+#ifdef PHYSICS_DEBUG
+#include "../Renderer/Renderer.hpp"
 
 #include "imgui.h"
+#endif
 
-void World::BroadPhaseAdd(HGrid& hgrid, HGrid::Object* obj)
+// Runs function on the pool if there is one.
+template <typename F>
+static void ParallelFor(ThreadPool* pool, int count, int minBatch, const F& function)
 {
-    assert(obj);
+    if (pool)
+    {
+        pool->ParallelFor(count, minBatch, function);
+    }
+    else if (count > 0)
+    {
+        function(0, count, 0);
+    }
+}
 
-    // Find lowest level where object fully fits inside cell.
-    const f32 diameter = 2.0f * obj->mRadius;
-    i16 level = 0;
+// Calls function(begin, end) for the items of every color in turn,
+// items of one color are independent and processed in parallel.
+template <typename F>
+static void ForEachColor(ThreadPool* pool, const int* colorsStart, int minBatch, const F& function)
+{
+    for (int c = 0; c < PHYSICS_SOLVER_COLORS_COUNT; ++c)
+    {
+        const int start = colorsStart[c];
+        ParallelFor(
+            pool,
+            colorsStart[c + 1] - start,
+            minBatch,
+            [&](int begin, int end, int) { function(start + begin, start + end); }
+        );
+    }
+}
+
+// Lowest level where the object fully fits inside a cell.
+static int HGridLevel(f32 radius)
+{
+    const f32 diameter = 2.0f * radius;
+    int level = 0;
     for (size_t i = 0; i < ARRAY_SIZE(HGrid::LEVEL_SIZES); ++i)
     {
         if (diameter <= HGrid::LEVEL_SIZES[i])
@@ -29,18 +66,72 @@ void World::BroadPhaseAdd(HGrid& hgrid, HGrid::Object* obj)
         }
         ++level;
     }
-    assert(level < static_cast<i16>(ARRAY_SIZE(HGrid::LEVEL_SIZES)));
-    const f32 cellSize = HGrid::LEVEL_SIZES[level];
+    assert(level < ARRAY_SSIZE(HGrid::LEVEL_SIZES));
+    return level;
+}
 
-    // Add object to grid square, and remember cell and level numbers.
+static int HGridCellBucket(const HGrid& hgrid, HGrid::Cell cell)
+{
+    const u64 bucket = Hash::Splittable64(Utils::BitCast<u64>(cell))
+        % static_cast<u64>(hgrid.mBucketsCount);
+    return static_cast<int>(bucket);
+}
+
+static int HGridBucket(const HGrid& hgrid, Vec3 position, int level)
+{
+    const f32 cellSize = HGrid::LEVEL_SIZES[level];
     const HGrid::Cell cell{
-        static_cast<i16>(roundf(obj->mPosition.X() / cellSize)),
-        static_cast<i16>(roundf(obj->mPosition.Y() / cellSize)),
-        static_cast<i16>(roundf(obj->mPosition.Z() / cellSize)),
-        level
+        static_cast<i16>(roundf(position.X() / cellSize)),
+        static_cast<i16>(roundf(position.Y() / cellSize)),
+        static_cast<i16>(roundf(position.Z() / cellSize)),
+        static_cast<i16>(level)
     };
-    const u64 bucket = Hash::Splittable64(Utils::BitCast<u64>(cell)) % HGrid::BUCKETS_COUNT;
-    obj->mBucket = static_cast<int>(bucket);
+    return HGridCellBucket(hgrid, cell);
+}
+
+void World::BroadPhaseAlloc(int objectsCapacity)
+{
+    assert(objectsCapacity > 0);
+
+    // Old arrays stay in the arena until the world is reset.
+    const HGrid::Object* const oldObjects = mHGrid.mObjects;
+    const int objectsCount = mHGrid.mObjectsCount;
+    const u32 tick = mHGrid.mTick;
+
+    mHGrid = {};
+    mHGrid.mObjectsCapacity = objectsCapacity;
+    mHGrid.mObjects = gArenaReset.AllocOrDie<HGrid::Object>(objectsCapacity);
+    mHGrid.mBucketsCount = objectsCapacity * HGrid::BUCKETS_PER_OBJECT;
+    mHGrid.mObjectBucket = gArenaReset.AllocOrDie<HGrid::Object*>(mHGrid.mBucketsCount);
+    mHGrid.mTimeStamp = gArenaReset.AllocOrDie<u32>(mHGrid.mBucketsCount);
+    mHGrid.mTick = tick;
+
+    // Buckets depend on the buckets count, so everything is relinked.
+    for (int i = 0; i < objectsCount; ++i)
+    {
+        mHGrid.mObjects[i] = oldObjects[i];
+        if (mHGrid.mObjects[i].mInverseMass != 0.0f)
+        {
+            BroadPhaseAdd(mHGrid, &mHGrid.mObjects[i]);
+        }
+    }
+    mHGrid.mObjectsCount = objectsCount;
+}
+
+// Dynamic and awake, contacts between inactive bodies don't need updates or solving.
+static bool IsBodyActive(const Body& body)
+{
+    return body.mInverseMass != 0.0f && !body.mIsAsleep;
+}
+
+void World::BroadPhaseAdd(HGrid& hgrid, HGrid::Object* obj)
+{
+    assert(obj);
+
+    // Add object to grid square, and remember cell and level numbers.
+    const int level = HGridLevel(obj->mRadius);
+    const int bucket = HGridBucket(hgrid, obj->mPosition, level);
+    obj->mBucket = bucket;
     obj->mLevel = level;
     obj->mNext = hgrid.mObjectBucket[bucket];
     hgrid.mObjectBucket[bucket] = obj;
@@ -49,10 +140,34 @@ void World::BroadPhaseAdd(HGrid& hgrid, HGrid::Object* obj)
     hgrid.mOccupiedLevelsMask |= (1U << level);
 }
 
+void World::BroadPhaseRemove(HGrid& hgrid, HGrid::Object* obj)
+{
+    assert(obj);
+    assert(obj->mBucket != -1);
+
+    // Buckets are short, BUCKETS_PER_OBJECT keeps the load low.
+    HGrid::Object** link = &hgrid.mObjectBucket[obj->mBucket];
+    while (*link != obj)
+    {
+        assert(*link);
+        link = &(*link)->mNext;
+    }
+    *link = obj->mNext;
+    obj->mNext = nullptr;
+    obj->mBucket = -1;
+
+    if (--hgrid.mObjectsAtLevel[obj->mLevel] == 0)
+    {
+        hgrid.mOccupiedLevelsMask &= ~(1U << obj->mLevel);
+    }
+}
+
 void World::BroadPhaseCheck(HGrid& hgrid, const HGrid::Object* obj)
 {
     assert(obj);
     assert(obj->mId != -1);
+    // Sleeping objects are only found by the awake ones.
+    assert(!obj->mIsAsleep);
 
     int startLevel = 0;
     u32 occupiedLevelsMask = hgrid.mOccupiedLevelsMask;
@@ -74,8 +189,12 @@ void World::BroadPhaseCheck(HGrid& hgrid, const HGrid::Object* obj)
     }
     assert(startLevel < LEVELS_COUNT);
 
-    // For each new query, increase time stamp counter.
-    ++hgrid.mTick;
+    // For each new query, increase time stamp counter. Stamps are cleared only when it wraps.
+    if (++hgrid.mTick == 0)
+    {
+        memset(hgrid.mTimeStamp, 0, static_cast<size_t>(hgrid.mBucketsCount) * sizeof(u32));
+        hgrid.mTick = 1;
+    }
 
     for (int level = startLevel; level < LEVELS_COUNT; ++level)
     {
@@ -118,8 +237,8 @@ void World::BroadPhaseCheck(HGrid& hgrid, const HGrid::Object* obj)
                         static_cast<i16>(z),
                         static_cast<i16>(level)
                     };
-                    const u64 bucket
-                        = Hash::Splittable64(Utils::BitCast<u64>(cellPos)) % HGrid::BUCKETS_COUNT;
+                    const u64 bucket = Hash::Splittable64(Utils::BitCast<u64>(cellPos))
+                        % static_cast<u64>(hgrid.mBucketsCount);
 
                     // Has this hash bucket already been checked for this object?
                     if (hgrid.mTimeStamp[bucket] == hgrid.mTick)
@@ -132,19 +251,22 @@ void World::BroadPhaseCheck(HGrid& hgrid, const HGrid::Object* obj)
                     const HGrid::Object* o = hgrid.mObjectBucket[bucket];
                     while (o)
                     {
-                        if (o != obj)
+                        // Each pair is tested once: levels are only searched upwards, so an
+                        // awake object below finds this pair too, on the same level the lower
+                        // id takes it. Sleeping objects don't search at all.
+                        const bool isFoundByOther = !o->mIsAsleep
+                            && (o->mLevel < obj->mLevel
+                                || (o->mLevel == obj->mLevel && o->mId < obj->mId));
+                        if (o != obj && !isFoundByOther)
                         {
                             assert(o->mId != -1);
                             ++hgrid.mTestsCount;
+                            // Manifolds of the pairs that separated are removed after the
+                            // narrow phase.
                             const f32 dist2 = MagnitudeSq(pos - o->mPosition);
                             if (dist2 <= Square(obj->mRadius + o->mRadius + EPSILON))
                             {
-                                NarrowPhase(obj, o);
-                            }
-                            else
-                            {
-                                // Broke the contact (or no contact at all).
-                                ManifoldErase({obj->mId, o->mId});
+                                PairAdd(Min(obj->mId, o->mId), Max(obj->mId, o->mId));
                             }
                         }
                         o = o->mNext;
@@ -157,24 +279,92 @@ void World::BroadPhaseCheck(HGrid& hgrid, const HGrid::Object* obj)
     }
 }
 
-void World::NarrowPhase(const HGrid::Object* obj1, const HGrid::Object* obj2)
+void World::PairAdd(Body::Id bodyId1, Body::Id bodyId2)
 {
-    assert(obj1);
-    assert(obj2);
-
-    const ContactManifold::Key key = {obj1->mId, obj2->mId};
+    const ContactManifold::Key key = {bodyId1, bodyId2};
     assert(Utils::BitCast<u64>(key) != UINT64_MAX);
 
-    if (obj1->mInverseMass == 0.0f && obj2->mInverseMass == 0.0f)
+    if (mBodies[bodyId1].mInverseMass == 0.0f && mBodies[bodyId2].mInverseMass == 0.0f)
     {
         return;
     }
 
-    ContactManifold manifold{};
-    ManifoldInit(manifold, obj1->mId, obj2->mId);
+    if (mPairsCount == mPairsCapacity)
+    {
+        const int newCapacity = Max(mPairsCapacity * 2, 64);
+        mPairs = gArenaFrame.ReallocOrDie(mPairs, mPairsCapacity, newCapacity, Arena::FlagNoZero);
+        mPairsCapacity = newCapacity;
+    }
+    mPairs[mPairsCount++] = key;
+}
+
+void World::NarrowPhase()
+{
+    const int pairsCount = mPairsCount;
+    ContactManifold* const manifolds
+        = gArenaFrame.AllocOrDie<ContactManifold>(pairsCount, Arena::FlagNoZero);
+    SatCache* const satCaches = gArenaFrame.AllocOrDie<SatCache>(pairsCount, Arena::FlagNoZero);
+
+    // The clipping buffers of every thread.
+    const int threadsCount = mThreadPool ? mThreadPool->GetThreadsCount() : 1;
+    const ptrdiff_t scratchSize = GetCollideScratchSize(mMaxFaceVerticesCount);
+    Arena* const scratches = gArenaFrame.AllocOrDie<Arena>(threadsCount);
+    for (int i = 0; i < threadsCount; ++i)
+    {
+        scratches[i].Init(
+            gArenaFrame.AllocOrDie(scratchSize, 64, Arena::FlagNoZero),
+            scratchSize,
+            "Collide"
+        );
+    }
+
+    // Collide only reads the bodies, hulls and caches, every pair has its own output slot.
+    ParallelFor(
+        mThreadPool,
+        pairsCount,
+        PHYSICS_NARROW_PHASE_MIN_BATCH,
+        [&](int begin, int end, int threadIndex)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const int satIndex = mSatPairs.Find(Utils::BitCast<u64>(mPairs[i]));
+                satCaches[i] = satIndex == -1 ? SatCache{} : mSatCaches[satIndex];
+                manifolds[i] = {};
+                ManifoldInit(
+                    manifolds[i],
+                    satCaches[i],
+                    mPairs[i].mBodyId1,
+                    mPairs[i].mBodyId2,
+                    scratches[threadIndex]
+                );
+            }
+        }
+    );
+
+    for (int i = 0; i < mContactPairs.mCount; ++i)
+    {
+        mContactManifolds[i].mIsTouching = false;
+    }
+    for (int i = 0; i < mSatPairs.mCount; ++i)
+    {
+        mSatCaches[i].mIsCollided = false;
+    }
 
-    if (manifold.mContactsCount > 0)
+    // Manifolds are changed serially in the pairs order, so they're the same for any threads count.
+    for (int i = 0; i < pairsCount; ++i)
     {
+        const ContactManifold::Key key = mPairs[i];
+        if (satCaches[i].mType != SatCache::None)
+        {
+            SatCacheStore(key, satCaches[i]);
+        }
+
+        ContactManifold& manifold = manifolds[i];
+        if (manifold.mContactsCount == 0)
+        {
+            continue;
+        }
+        manifold.mIsTouching = true;
         const int index = ManifoldFind(key);
         if (index == -1)
         {
@@ -183,27 +373,60 @@ void World::NarrowPhase(const HGrid::Object* obj1, const HGrid::Object* obj2)
         else
         {
             ManifoldUpdate(mContactManifolds[index], manifold, manifold.mContactsCount);
+            mContactManifolds[index].mIsTouching = true;
         }
     }
-    else
+
+    // Broke the contact, or the broad-phase didn't report the pair at all. Contacts inside
+    // sleeping islands aren't collided and are kept.
+    for (int i = 0; i < mContactPairs.mCount;)
+    {
+        const ContactManifold::Key key = mContactManifoldsKeys[i];
+        const bool isActive
+            = IsBodyActive(mBodies[key.mBodyId1]) || IsBodyActive(mBodies[key.mBodyId2]);
+        if (!mContactManifolds[i].mIsTouching && isActive)
+        {
+            ManifoldRemoveAt(i);
+            continue;
+        }
+        ++i;
+    }
+    for (int i = 0; i < mSatPairs.mCount;)
     {
-        // Broke the contact (or no contact at all).
-        ManifoldErase(key);
+        const auto key = Utils::BitCast<ContactManifold::Key>(mSatPairs.mPairs[i]);
+        const bool isActive
+            = IsBodyActive(mBodies[key.mBodyId1]) || IsBodyActive(mBodies[key.mBodyId2]);
+        if (!mSatCaches[i].mIsCollided && isActive)
+        {
+            // Same swap-remove as in the pair set.
+            mSatCaches[i] = mSatCaches[mSatPairs.mCount - 1];
+            mSatPairs.RemoveAt(i);
+            continue;
+        }
+        ++i;
     }
+
+    mPairs = nullptr;
+    mPairsCount = 0;
+    mPairsCapacity = 0;
 }
 
+#ifdef PHYSICS_DEBUG
 static const char* BodyShapeToString(u8 shape)
 {
     switch (shape)
     {
     case Body::Shape::Sphere:
         return "Sphere";
+    case Body::Shape::Box:
+        return "Box";
     case Body::Shape::ConvexHull:
         return "Hull";
     default:
         return "Unknown";
     }
 }
+#endif
 
 void World::BodyInitSphere(Body& body, f32 density, f32 radius) const
 {
@@ -222,9 +445,33 @@ void World::BodyInitSphere(Body& body, f32 density, f32 radius) const
     MassProperties::CalculateSphere(radius, density, body.mInverseInertia, body.mInverseMass);
 }
 
-void World::BodyInitConvexHull(Body& body, f32 density, ConvexHull::Id hullId) const
+void World::BodyInitBox(Body& body, f32 density, Vec3 halfExtents) const
+{
+    assert(density > 0.0f);
+    assert(halfExtents.X() > 0.0f && halfExtents.Y() > 0.0f && halfExtents.Z() > 0.0f);
+
+    body = {};
+    body.mShape = Body::Shape::Box;
+    body.mOrientation = {1.0f, 0.0f, 0.0f, 0.0f};
+    body.mFriction = 0.2f;
+    body.mLinearDamping = 0.1f;
+    body.mAngularDamping = 0.1f;
+
+    body.mBox.mHalfExtents = halfExtents;
+    body.mRadius = Magnitude(halfExtents);
+
+    MassProperties::CalculateRectangularCuboid(
+        halfExtents * 2.0f,
+        density,
+        body.mInverseInertia,
+        body.mInverseMass
+    );
+}
+
+void World::BodyInitConvexHull(Body& body, f32 density, ConvexHull::Id hullId, Vec3 scale) const
 {
     assert(density > 0.0f);
+    assert(scale.X() > 0.0f && scale.Y() > 0.0f && scale.Z() > 0.0f);
 
     body = {};
     body.mShape = Body::Shape::ConvexHull;
@@ -234,194 +481,299 @@ void World::BodyInitConvexHull(Body& body, f32 density, ConvexHull::Id hullId) c
     body.mAngularDamping = 0.1f;
 
     body.mConvexHull.mId = hullId;
+    body.mConvexHull.mScale = scale;
 
     const ConvexHull& hull = mConvexHulls[hullId];
-    Vec3 centerOfMass{};
-    MassProperties::CalculatePolyhedronTriangleMesh(
-        hull.mMeshPositions.mData,
-        hull.mMeshIndices.mData,
-        hull.mMeshIndices.mCount,
+    assert(AlmostEqual(hull.mMassProperties.mCenterOfMass, hull.mCentroid, 0.0001f));
+    MassProperties::CalculateScaledPolyhedron(
+        hull.mMassProperties,
         density,
-        hull.mScale,
+        scale,
         body.mInverseInertia,
-        centerOfMass,
         body.mInverseMass
     );
-    assert(AlmostEqual(centerOfMass, hull.mCentroid, 0.0001f));
-    body.mRadius = hull.mRadius;
+    f32 radiusSq = 0.0f;
+    for (int i = 0; i < hull.mVerticesCount; ++i)
+    {
+        radiusSq = Max(radiusSq, MagnitudeSq(hull.mVertexPositions[i] * scale));
+    }
+    body.mRadius = sqrtf(radiusSq);
 }
 
 int World::ManifoldFind(ContactManifold::Key key) const
 {
-    const u64 searchKey = Utils::BitCast<u64>(key);
-    assert(searchKey != UINT64_MAX);
-    u64 index = Hash::Splittable64(searchKey) % PHYSICS_MAX_CONTACT_MANIFOLDS;
-    const u64 originalIndex = index;
+    assert(Utils::BitCast<u64>(key) != UINT64_MAX);
+    return mContactPairs.Find(Utils::BitCast<u64>(key));
+}
 
-    u64 k = 0;
-    do
-    {
-        k = Utils::BitCast<u64>(mContactManifoldsKeys[index]);
-        if (k == searchKey)
-        {
-            return static_cast<int>(index);
-        }
-        index = (index + 1) % PHYSICS_MAX_CONTACT_MANIFOLDS;
-    }
-    while ((k != UINT64_MAX) && (index != originalIndex));
+void World::ManifoldsAlloc(int capacity)
+{
+    assert(capacity > 0);
 
-    return -1;
+    mContactPairs.Init(capacity);
+    mContactManifoldsCapacity = capacity;
+    mContactManifolds = gArenaReset.AllocOrDie<ContactManifold>(capacity, Arena::FlagNoZero);
+    mContactManifoldsKeys
+        = gArenaReset.AllocOrDie<ContactManifold::Key>(capacity, Arena::FlagNoZero);
 }
 
 void World::ManifoldInsert(ContactManifold::Key key, const ContactManifold& manifold)
 {
-    assert(mContactManifoldsCount < PHYSICS_MAX_CONTACT_MANIFOLDS);
-    if (mContactManifoldsCount >= PHYSICS_MAX_CONTACT_MANIFOLDS)
-    {
-        return;
-    }
+    const bool isAdded = mContactPairs.Add(Utils::BitCast<u64>(key));
+    assert(isAdded);
+    (void)isAdded;
 
-    u64 index = Hash::Splittable64(Utils::BitCast<u64>(key)) % PHYSICS_MAX_CONTACT_MANIFOLDS;
-    const u64 originalIndex = index;
-    (void)originalIndex;
-
-    while (Utils::BitCast<u64>(mContactManifoldsKeys[index]) != UINT64_MAX)
+    // The pair set has grown, the manifolds follow it.
+    if (mContactPairs.mCapacity != mContactManifoldsCapacity)
     {
-        index = (index + 1) % PHYSICS_MAX_CONTACT_MANIFOLDS;
-        assert(index != originalIndex);
-        assert(Utils::BitCast<u64>(mContactManifoldsKeys[index]) != Utils::BitCast<u64>(key));
+        const int newCapacity = mContactPairs.mCapacity;
+        mContactManifolds = gArenaReset.ReallocOrDie(
+            mContactManifolds,
+            mContactManifoldsCapacity,
+            newCapacity,
+            Arena::FlagNoZero
+        );
+        mContactManifoldsKeys = gArenaReset.ReallocOrDie(
+            mContactManifoldsKeys,
+            mContactManifoldsCapacity,
+            newCapacity,
+            Arena::FlagNoZero
+        );
+        mContactManifoldsCapacity = newCapacity;
     }
 
-    assert(Utils::BitCast<u64>(mContactManifoldsKeys[index]) == UINT64_MAX);
-    assert(Utils::BitCast<u64>(key) != UINT64_MAX);
+    const int index = mContactPairs.mCount - 1;
     mContactManifoldsKeys[index] = key;
     mContactManifolds[index] = manifold;
-    ++mContactManifoldsCount;
 }
 
-void World::ManifoldErase(ContactManifold::Key key)
+void World::ManifoldRemoveAt(int index)
 {
-    int index = ManifoldFind(key);
+    assert(index >= 0 && index < mContactPairs.mCount);
 
-    if (index == -1)
-    {
-        return;
-    }
+    // Same swap-remove as in the pair set.
+    const int last = mContactPairs.mCount - 1;
+    mContactPairs.RemoveAt(index);
+    mContactManifoldsKeys[index] = mContactManifoldsKeys[last];
+    mContactManifolds[index] = mContactManifolds[last];
+}
+
+void World::SatCachesAlloc(int capacity)
+{
+    assert(capacity > 0);
 
-    mContactManifoldsKeys[index] = {-1, -1};
-    --mContactManifoldsCount;
+    mSatPairs.Init(capacity);
+    mSatCachesCapacity = capacity;
+    mSatCaches = gArenaReset.AllocOrDie<SatCache>(capacity, Arena::FlagNoZero);
+}
 
-    // Rehashing is necessary, since linear probing can fail to find a key
-    // because of the hole we made.
-    const int originalIndex = index;
-    index = (index + 1) % PHYSICS_MAX_CONTACT_MANIFOLDS;
-    while ((Utils::BitCast<u64>(mContactManifoldsKeys[index]) != UINT64_MAX)
-           && (index != originalIndex))
+void World::SatCacheStore(ContactManifold::Key key, const SatCache& cache)
+{
+    const u64 pair = Utils::BitCast<u64>(key);
+    int index = mSatPairs.Find(pair);
+    if (index == -1)
     {
-        const ContactManifold::Key savedKey = mContactManifoldsKeys[index];
-        const ContactManifold savedManifold = mContactManifolds[index];
-        mContactManifoldsKeys[index] = {-1, -1};
-        --mContactManifoldsCount;
-        ManifoldInsert(savedKey, savedManifold);
-        index = (index + 1) % PHYSICS_MAX_CONTACT_MANIFOLDS;
+        mSatPairs.Add(pair);
+        // The pair set has grown, the caches follow it.
+        if (mSatPairs.mCapacity != mSatCachesCapacity)
+        {
+            const int newCapacity = mSatPairs.mCapacity;
+            mSatCaches = gArenaReset.ReallocOrDie(
+                mSatCaches,
+                mSatCachesCapacity,
+                newCapacity,
+                Arena::FlagNoZero
+            );
+            mSatCachesCapacity = newCapacity;
+        }
+        index = mSatPairs.mCount - 1;
     }
+    mSatCaches[index] = cache;
+    mSatCaches[index].mIsCollided = true;
 }
 
-void World::Init(Vec3 gravity, f32 timeStep, int iterations)
+void World::Init(const WorldDesc& desc)
 {
-    assert(iterations > 0);
-    assert(timeStep > 0.0f);
-
-    mTimeStep = timeStep;
-    mGravity = gravity;
-    mIterationsCount = iterations;
-
-    mBodies = gArenaReset.AllocOrDie<Body>(PHYSICS_MAX_BODIES);
-    mInverseInertiasLocal = gArenaReset.AllocOrDie<Mat3>(PHYSICS_MAX_BODIES);
-
-    mContactManifolds = gArenaReset.AllocOrDie<ContactManifold>(PHYSICS_MAX_CONTACT_MANIFOLDS);
+    assert(desc.mIterationsCount > 0);
+    assert(desc.mTimeStep > 0.0f);
+    assert(desc.mSubStepsCount >= 0);
+    assert(desc.mBodiesCapacity >= 0);
+    assert(desc.mConvexHullsCapacity >= 0);
+    assert(desc.mContactManifoldsCapacity >= 0);
+
+#if defined(FLOAT_W_DISPATCH_AVX2)
+    InitCollideKernels(IsAvx2Supported());
+#endif
 
-    mContactManifoldsKeys = gArenaReset.AllocOrDie<ContactManifold::Key>(
-        PHYSICS_MAX_CONTACT_MANIFOLDS,
-        Arena::FlagNoZero
-    );
-    memset(
-        mContactManifoldsKeys,
-        0xff,
-        PHYSICS_MAX_CONTACT_MANIFOLDS * sizeof(mContactManifoldsKeys[0])
+    mTimeStep = desc.mTimeStep;
+    mGravity = desc.mGravity;
+    mIterationsCount = desc.mIterationsCount;
+    mSubStepsCount
+        = desc.mSubStepsCount > 0 ? desc.mSubStepsCount : PHYSICS_DEFAULT_SUB_STEPS_COUNT;
+    mSolverType = desc.mSolver;
+    mThreadPool = desc.mThreadPool;
+    mIsSleepingEnabled = !desc.mDisableSleeping;
+
+    mBodiesCapacity
+        = desc.mBodiesCapacity > 0 ? desc.mBodiesCapacity : PHYSICS_DEFAULT_BODIES_CAPACITY;
+    mBodies = gArenaReset.AllocOrDie<Body>(mBodiesCapacity);
+
+    ManifoldsAlloc(
+        desc.mContactManifoldsCapacity > 0
+            ? desc.mContactManifoldsCapacity
+            : mBodiesCapacity * PHYSICS_CONTACT_MANIFOLDS_PER_BODY
     );
+    SatCachesAlloc(mContactManifoldsCapacity);
+    mStaticTree.Init(2 * PHYSICS_DEFAULT_STATIC_BODIES_CAPACITY); // Leaves and internal nodes.
+    mBroadPhaseType = desc.mBroadPhase;
+    switch (mBroadPhaseType)
+    {
+    case BroadPhaseType::HGrid:
+        BroadPhaseAlloc(mBodiesCapacity);
+        break;
+    case BroadPhaseType::AabbTree:
+        mTree.Init(2 * mBodiesCapacity); // Leaves and internal nodes.
+        mTreePairs.Init(mBodiesCapacity * PHYSICS_CONTACT_MANIFOLDS_PER_BODY);
+        break;
+    case BroadPhaseType::SweepAndPrune:
+        mSap.Init(mBodiesCapacity);
+        break;
+    }
+
+    mConvexHullsCapacity = desc.mConvexHullsCapacity > 0 ? desc.mConvexHullsCapacity
+                                                         : PHYSICS_DEFAULT_CONVEX_HULLS_CAPACITY;
+    mConvexHulls = gArenaReset.AllocOrDie<ConvexHull>(mConvexHullsCapacity);
 
-    mConvexHulls = gArenaReset.AllocOrDie<ConvexHull>(PHYSICS_MAX_CONVEX_HULLS);
+    mBoxHull.InitBox(Vec3{2.0f});
+    mBoxHull.Pack(gArenaReset);
+    mMaxFaceVerticesCount = Max(mMaxFaceVerticesCount, mBoxHull.mMaxFaceVerticesCount);
 }
 
 ConvexHull::Id World::AddConvexHull(const ConvexHull& hull)
 {
     const int id = mConvexHullsCount;
+    if (id == mConvexHullsCapacity)
+    {
+        const int newCapacity = mConvexHullsCapacity * 2;
+        mConvexHulls = gArenaReset.ReallocOrDie(mConvexHulls, mConvexHullsCapacity, newCapacity);
+        mConvexHullsCapacity = newCapacity;
+    }
     mConvexHulls[id] = hull;
+    mConvexHulls[id].Pack(gArenaReset);
+    mConvexHulls[id].mMassProperties = MassProperties::CalculatePolyhedron(
+        hull.mMeshPositions.mData,
+        hull.mMeshIndices.mData,
+        hull.mMeshIndices.mCount,
+        hull.mScale
+    );
     ++mConvexHullsCount;
+    mMaxFaceVerticesCount = Max(mMaxFaceVerticesCount, hull.mMaxFaceVerticesCount);
     return id;
 }
 
+Aabb World::BodyComputeAabb(const Body& body) const
+{
+    if (body.mShape == Body::Shape::Box)
+    {
+        const Mat3 rotation = ToMat3(body.mOrientation);
+        const Vec3 halfExtents = body.mBox.mHalfExtents;
+        const Vec3 extent = Abs(rotation.mCol[0]) * halfExtents.X()
+                            + Abs(rotation.mCol[1]) * halfExtents.Y()
+                            + Abs(rotation.mCol[2]) * halfExtents.Z();
+        return {body.mPosition - extent, body.mPosition + extent};
+    }
+    if (body.mShape == Body::Shape::ConvexHull)
+    {
+        // Tighter than the bounding sphere for long thin hulls.
+        const ConvexHull& hull = mConvexHulls[body.mConvexHull.mId];
+        const Mat3 rotation = ToMat3(body.mOrientation);
+        Aabb aabb{Vec3{FLT_MAX}, Vec3{-FLT_MAX}};
+        for (int i = 0; i < hull.mVerticesCount; ++i)
+        {
+            const Vec3 v = rotation * (hull.mVertexPositions[i] * body.mConvexHull.mScale);
+            aabb.mMin = Min(aabb.mMin, v);
+            aabb.mMax = Max(aabb.mMax, v);
+        }
+        return {aabb.mMin + body.mPosition, aabb.mMax + body.mPosition};
+    }
+
+    const Vec3 radius{body.mRadius};
+    return {body.mPosition - radius, body.mPosition + radius};
+}
+
 void World::BroadPhase()
 {
+    gTimeMeters[TimeMeter::PhysicsUpdateBroadPhase].Start();
 #ifdef PHYSICS_NO_BROADPHASE
     for (int i = 0; i < mBodiesCount; ++i)
     {
-        Body& bi = mBodies[i];
-
         for (int j = i + 1; j < mBodiesCount; ++j)
         {
-            Body& bj = mBodies[j];
-            const ContactManifold::Key key = {i, j};
-
-            if (bi.mInverseMass == 0.0f && bj.mInverseMass == 0.0f)
+            // Static pairs and contacts inside sleeping islands don't change.
+            if (IsBodyActive(mBodies[i]) || IsBodyActive(mBodies[j]))
             {
-                continue;
-            }
-
-            ContactManifold manifold{};
-            ManifoldInit(manifold, i, j);
-
-            if (manifold.mContactsCount > 0)
-            {
-                const int index = ManifoldFind(key);
-                if (index == -1)
-                {
-                    ManifoldInsert(key, manifold);
-                }
-                else
-                {
-                    ManifoldUpdate(
-                        mContactManifolds[index],
-                        manifold.mContacts,
-                        manifold.mContactsCount
-                    );
-                }
-            }
-            else
-            {
-                // Broke the contact (or no contact at all).
-                ManifoldErase(key);
+                PairAdd(i, j);
             }
         }
     }
 #else
-    gTimeMeters[TimeMeter::PhysicsCreateHGrid].Start();
-    mHGrid = {};
-    HGrid::Object* const objects = gArenaFrame.AllocOrDie<HGrid::Object>(mBodiesCount - 1);
-    const int bodiesCount = mBodiesCount - 1; // Without the floor.
+    switch (mBroadPhaseType)
+    {
+    case BroadPhaseType::HGrid:
+        BroadPhaseHGrid();
+        break;
+    case BroadPhaseType::AabbTree:
+        BroadPhaseTree();
+        break;
+    case BroadPhaseType::SweepAndPrune:
+        BroadPhaseSap();
+        break;
+    }
+    BroadPhaseStatic();
+#endif
+    gTimeMeters[TimeMeter::PhysicsUpdateBroadPhase].End();
+}
+
+void World::BroadPhaseHGrid()
+{
+    const int bodiesCount = mBodiesCount;
+    if (bodiesCount > mHGrid.mObjectsCapacity)
+    {
+        BroadPhaseAlloc(Max(bodiesCount, mHGrid.mObjectsCapacity * 2));
+    }
+    HGrid::Object* const objects = mHGrid.mObjects;
     for (int i = 0; i < bodiesCount; ++i)
     {
-        const Body& b = mBodies[i + 1];
-        objects[i].mPosition = b.mPosition;
-        objects[i].mRadius = b.mRadius;
-        objects[i].mInverseMass = b.mInverseMass;
-        objects[i].mId = b.mId;
-        BroadPhaseAdd(mHGrid, &objects[i]);
+        const Body& b = mBodies[i];
+        HGrid::Object& obj = objects[i];
+        if (i >= mHGrid.mObjectsCount)
+        {
+            obj.mRadius = b.mRadius;
+            obj.mInverseMass = b.mInverseMass;
+            obj.mId = b.mId;
+            obj.mBucket = -1;
+        }
+        if (obj.mInverseMass == 0.0f)
+        {
+            continue;
+        }
+
+        obj.mPosition = b.mPosition;
+        obj.mIsAsleep = b.mIsAsleep;
+        if (obj.mBucket == -1)
+        {
+            BroadPhaseAdd(mHGrid, &obj);
+        }
+        else if (HGridBucket(mHGrid, obj.mPosition, obj.mLevel) != obj.mBucket)
+        {
+            BroadPhaseRemove(mHGrid, &obj);
+            BroadPhaseAdd(mHGrid, &obj);
+        }
     }
-    gTimeMeters[TimeMeter::PhysicsCreateHGrid].End();
+    mHGrid.mObjectsCount = bodiesCount;
+    mHGrid.mTestsCount = 0;
 
-    // for (int i = 0; i < HGrid::BUCKETS_COUNT; ++i)
+    // for (int i = 0; i < mHGrid.mBucketsCount; ++i)
     // {
     //     const HGrid::Object* o = mHGrid.mObjectBucket[i];
     //     while (o)
@@ -439,156 +791,936 @@ void World::BroadPhase()
     //     }
     // }
 
+    // Contacts inside a sleeping island are kept as they are.
     for (int i = 0; i < bodiesCount; ++i)
     {
-        BroadPhaseCheck(mHGrid, &objects[i]);
-    }
-
-    HGrid::Object floor{};
-    for (int i = 0; i < bodiesCount; ++i)
-    {
-        NarrowPhase(&objects[i], &floor);
+        if (objects[i].mInverseMass != 0.0f && !objects[i].mIsAsleep)
+        {
+            BroadPhaseCheck(mHGrid, &objects[i]);
+        }
     }
-#endif
 }
 
-Body::Id World::AddBody(const Body& body)
+void World::BroadPhaseTree()
 {
-    const int id = mBodiesCount;
-    if (id >= PHYSICS_MAX_BODIES)
+    // Proxies of the bodies that left their fat AABBs (or are new), sleeping bodies don't move.
+    int* const moveBuffer = gArenaFrame.AllocOrDie<int>(mBodiesCount, Arena::FlagNoZero);
+    int moveCount = 0;
+    for (int i = 0; i < mBodiesCount; ++i)
     {
-        return World::BODY_ID_INVALID;
+        Body& b = mBodies[i];
+        if (!IsBodyActive(b))
+        {
+            continue;
+        }
+        const Aabb aabb = BodyComputeAabb(b);
+        if (b.mProxyId == DynamicTree::NODE_NULL)
+        {
+            b.mProxyId = mTree.CreateProxy(aabb, i);
+            moveBuffer[moveCount++] = i;
+        }
+        else if (mTree.MoveProxy(b.mProxyId, aabb))
+        {
+            moveBuffer[moveCount++] = i;
+        }
     }
 
-    mBodies[id] = body;
-    mBodies[id].mId = id;
-    mInverseInertiasLocal[id] = body.mInverseInertia;
-    ++mBodiesCount;
+    // Only the moved proxies can start new pairs.
+    for (int i = 0; i < moveCount; ++i)
+    {
+        const Body::Id bodyId = moveBuffer[i];
+        mTree.Query(
+            mTree.GetFatAabb(mBodies[bodyId].mProxyId),
+            [&](int proxyId)
+            {
+                const Body::Id otherId = mTree.GetUserData(proxyId);
+                if (otherId != bodyId)
+                {
+                    const ContactManifold::Key key = {Min(bodyId, otherId), Max(bodyId, otherId)};
+                    mTreePairs.Add(Utils::BitCast<u64>(key));
+                }
+                return true;
+            }
+        );
+    }
 
-    return id;
+    // Pairs live while their fat AABBs overlap, contacts inside sleeping islands are kept.
+    for (int i = 0; i < mTreePairs.mCount;)
+    {
+        const ContactManifold::Key key = Utils::BitCast<ContactManifold::Key>(mTreePairs.mPairs[i]);
+        const Body& b1 = mBodies[key.mBodyId1];
+        const Body& b2 = mBodies[key.mBodyId2];
+        if (!Overlap(mTree.GetFatAabb(b1.mProxyId), mTree.GetFatAabb(b2.mProxyId)))
+        {
+            // The manifold is removed after the narrow phase, since the pair isn't reported.
+            mTreePairs.RemoveAt(i);
+            continue;
+        }
+        if (IsBodyActive(b1) || IsBodyActive(b2))
+        {
+            PairAdd(key.mBodyId1, key.mBodyId2);
+        }
+        ++i;
+    }
 }
 
-Body::Id World::SetFloor(const Body& floor)
+void World::BroadPhaseSap()
 {
-    assert(mBodiesCount == 0);
-    if (mBodiesCount != 0)
+    // Sleeping bodies keep their old boxes, the ids are the body ids.
+    for (int i = 0; i < mBodiesCount; ++i)
     {
-        return World::BODY_ID_INVALID;
+        Body& b = mBodies[i];
+        if (b.mInverseMass == 0.0f)
+        {
+            continue;
+        }
+        if (b.mProxyId == DynamicTree::NODE_NULL)
+        {
+            b.mProxyId = i;
+            mSap.Add(i, BodyComputeAabb(b));
+        }
+        else if (!b.mIsAsleep)
+        {
+            mSap.mAabbs[i] = BodyComputeAabb(b);
+        }
     }
+    mSap.Update(gArenaFrame);
 
-    mBodies[0] = floor;
-    mBodies[0].mId = 0;
-    ++mBodiesCount;
+    // Pairs that stopped overlapping aren't reported, their manifolds are removed after the
+    // narrow phase.
+    u64* pairs = nullptr;
+    const int pairsCount = mSap.FindPairs(gArenaFrame, &pairs);
+    for (int i = 0; i < pairsCount; ++i)
+    {
+        const ContactManifold::Key key = Utils::BitCast<ContactManifold::Key>(pairs[i]);
+        if (IsBodyActive(mBodies[key.mBodyId1]) || IsBodyActive(mBodies[key.mBodyId2]))
+        {
+            PairAdd(key.mBodyId1, key.mBodyId2);
+        }
+    }
+}
+
+void World::BroadPhaseStatic()
+{
+    // Static bodies don't move on their own, only the new ones are inserted.
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        Body& b = mBodies[i];
+        if (b.mInverseMass == 0.0f && b.mProxyId == DynamicTree::NODE_NULL)
+        {
+            b.mProxyId = mStaticTree.CreateProxy(BodyComputeAabb(b), i);
+        }
+    }
+
+    // Sleeping bodies keep their contacts with the static ones.
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        const Body& b = mBodies[i];
+        if (!IsBodyActive(b))
+        {
+            continue;
+        }
+        mStaticTree.Query(
+            BodyComputeAabb(b),
+            [&](int proxyId)
+            {
+                const Body::Id staticId = mStaticTree.GetUserData(proxyId);
+                PairAdd(Min(i, staticId), Max(i, staticId));
+                return true;
+            }
+        );
+    }
+}
+
+static bool OverlapSphereAabb(Vec3 center, f32 radius, const Aabb& aabb)
+{
+    const Vec3 closest = Min(Max(center, aabb.mMin), aabb.mMax);
+    return MagnitudeSq(center - closest) <= Square(radius);
+}
+
+template <typename F>
+void World::BroadPhaseQuery(const Aabb& aabb, const F& callback)
+{
+    switch (mBroadPhaseType)
+    {
+    case BroadPhaseType::HGrid:
+    {
+        // Objects are in the cell of their center and fit inside it.
+        constexpr int LEVELS_COUNT = ARRAY_SSIZE(HGrid::LEVEL_SIZES);
+        HGrid::Cell cellsMin[LEVELS_COUNT]{};
+        HGrid::Cell cellsMax[LEVELS_COUNT]{};
+        i64 cellsCount = 0;
+        for (int level = 0; level < LEVELS_COUNT; ++level)
+        {
+            if ((mHGrid.mOccupiedLevelsMask & (1U << level)) == 0)
+            {
+                continue;
+            }
+            const f32 cellSize = HGrid::LEVEL_SIZES[level];
+            const Vec3 min = aabb.mMin / cellSize - Vec3{1.0f};
+            const Vec3 max = aabb.mMax / cellSize + Vec3{1.0f};
+            cellsMin[level] = {
+                static_cast<i16>(floorf(min.X())),
+                static_cast<i16>(floorf(min.Y())),
+                static_cast<i16>(floorf(min.Z())),
+                static_cast<i16>(level)
+            };
+            cellsMax[level] = {
+                static_cast<i16>(ceilf(max.X())),
+                static_cast<i16>(ceilf(max.Y())),
+                static_cast<i16>(ceilf(max.Z())),
+                static_cast<i16>(level)
+            };
+            cellsCount += static_cast<i64>(cellsMax[level].mX - cellsMin[level].mX + 1)
+                          * (cellsMax[level].mY - cellsMin[level].mY + 1)
+                          * (cellsMax[level].mZ - cellsMin[level].mZ + 1);
+        }
+
+        // A long sweep over the small cells is cheaper as a scan of the objects.
+        if (cellsCount > mHGrid.mObjectsCount)
+        {
+            for (int i = 0; i < mHGrid.mObjectsCount; ++i)
+            {
+                const HGrid::Object& o = mHGrid.mObjects[i];
+                if (o.mBucket != -1 && OverlapSphereAabb(o.mPosition, o.mRadius, aabb))
+                {
+                    callback(o.mId);
+                }
+            }
+            break;
+        }
+
+        if (++mHGrid.mTick == 0)
+        {
+            const size_t size = static_cast<size_t>(mHGrid.mBucketsCount) * sizeof(u32);
+            memset(mHGrid.mTimeStamp, 0, size);
+            mHGrid.mTick = 1;
+        }
+        for (int level = 0; level < LEVELS_COUNT; ++level)
+        {
+            if ((mHGrid.mOccupiedLevelsMask & (1U << level)) == 0)
+            {
+                continue;
+            }
+            HGrid::Cell cell = cellsMin[level];
+            for (cell.mX = cellsMin[level].mX; cell.mX <= cellsMax[level].mX; ++cell.mX)
+            {
+                for (cell.mY = cellsMin[level].mY; cell.mY <= cellsMax[level].mY; ++cell.mY)
+                {
+                    for (cell.mZ = cellsMin[level].mZ; cell.mZ <= cellsMax[level].mZ; ++cell.mZ)
+                    {
+                        const int bucket = HGridCellBucket(mHGrid, cell);
+                        if (mHGrid.mTimeStamp[bucket] == mHGrid.mTick)
+                        {
+                            continue;
+                        }
+                        mHGrid.mTimeStamp[bucket] = mHGrid.mTick;
+
+                        // Other cells and levels share the bucket too.
+                        const HGrid::Object* o = mHGrid.mObjectBucket[bucket];
+                        while (o)
+                        {
+                            if (OverlapSphereAabb(o->mPosition, o->mRadius, aabb))
+                            {
+                                callback(o->mId);
+                            }
+                            o = o->mNext;
+                        }
+                    }
+                }
+            }
+        }
+        break;
+    }
+    case BroadPhaseType::AabbTree:
+        mTree.Query(
+            aabb,
+            [&](int proxyId)
+            {
+                callback(mTree.GetUserData(proxyId));
+                return true;
+            }
+        );
+        break;
+    case BroadPhaseType::SweepAndPrune:
+        mSap.Query(aabb, callback);
+        break;
+    }
+}
+
+Body::Id World::AddBody(const Body& body)
+{
+    const int id = mBodiesCount;
+    if (id == mBodiesCapacity)
+    {
+        const int newCapacity = mBodiesCapacity * 2;
+        mBodies = gArenaReset.ReallocOrDie(mBodies, mBodiesCapacity, newCapacity);
+        mBodiesCapacity = newCapacity;
+    }
+
+    mBodies[id] = body;
+    mBodies[id].mId = id;
+    mBodies[id].mProxyId = DynamicTree::NODE_NULL; // Added on the next step.
+    ++mBodiesCount;
+
+    return id;
+}
+
+Body::Id World::AddBodies(const Body& body, const Vec3* positions, int count)
+{
+    assert(positions);
+    assert(count > 0);
+
+    const int firstId = mBodiesCount;
+    if (firstId + count > mBodiesCapacity)
+    {
+        const int newCapacity = Max(mBodiesCapacity * 2, firstId + count);
+        mBodies = gArenaReset.ReallocOrDie(mBodies, mBodiesCapacity, newCapacity);
+        mBodiesCapacity = newCapacity;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        Body& b = mBodies[firstId + i];
+        b = body;
+        b.mPosition = positions[i];
+        b.mId = firstId + i;
+        b.mProxyId = DynamicTree::NODE_NULL; // Added on the next step.
+    }
+    mBodiesCount += count;
+
+    return firstId;
+}
+
+bool World::IsBodyIdValid(Body::Id bodyId) const
+{
+    return bodyId >= 0 && bodyId < mBodiesCount;
+}
+
+// Gravity, external forces and damping.
+static void IntegrateForces(
+    const Body* bodies,
+    SolverBody* solverBodies,
+    int bodiesCount,
+    Vec3 gravity,
+    f32 timeStep
+)
+{
+    for (int i = 0; i < bodiesCount; ++i)
+    {
+        const Body& b = bodies[i];
+        SolverBody& sb = solverBodies[i];
+
+        if (sb.mInverseMass == 0.0f)
+        {
+            continue;
+        }
+
+        sb.mVelocity += (gravity + b.mForce * sb.mInverseMass) * timeStep;
+        sb.mAngularVelocity += (sb.mInverseInertia * b.mTorque) * timeStep;
+
+        // Damping logic is from box2d.
+        // Differential equation: dv/dt + c * v = 0
+        // Solution: v(t) = v0 * exp(-c * t)
+        //
+        // Time step: v(t + dt) = v0 * exp(-c * (t + dt)) =
+        // = v0 * exp(-c * t) * exp(-c * dt) = v(t) * exp(-c * dt)
+        //
+        // v2 = exp(-c * dt) * v1
+        //
+        // Pade approximation:
+        // v2 = v1 * 1 / (1 + c * dt)
+        sb.mVelocity *= 1.0f / (1.0f + timeStep * b.mLinearDamping);
+        sb.mAngularVelocity *= 1.0f / (1.0f + timeStep * b.mAngularDamping);
+    }
+}
+
+static Quat IntegrateOrientation(Quat orientation, Vec3 angularVelocity, f32 timeStep)
+{
+    Quat angVelDt = ToQuat(angularVelocity * timeStep);
+    angVelDt = angVelDt * orientation;
+    orientation.W() += angVelDt.W() * 0.5f;
+    orientation.X() += angVelDt.X() * 0.5f;
+    orientation.Y() += angVelDt.Y() * 0.5f;
+    orientation.Z() += angVelDt.Z() * 0.5f;
+    return Normalize(orientation);
+}
+
+// Spring with the given frequency and damping ratio, implicitly integrated over the time step.
+// Solver2D, Erin Catto.
+static ContactSoftness MakeSoftness(f32 hertz, f32 dampingRatio, f32 timeStep)
+{
+    const f32 omega = 2.0f * M_PIf * hertz;
+    const f32 a1 = 2.0f * dampingRatio + timeStep * omega;
+    const f32 a2 = timeStep * omega * a1;
+    const f32 a3 = 1.0f / (1.0f + a2);
+    return {omega / a1, a2 * a3, a3};
+}
+
+void World::Step()
+{
+    const f32 timeStep = mTimeStep;
+    const f32 inverseTimeStep = 1.0f / mTimeStep;
+
+    gTimeMeters[TimeMeter::PhysicsContactManifold].Start();
+    BroadPhase();
+    NarrowPhase();
+    gTimeMeters[TimeMeter::PhysicsContactManifold].End();
+
+#ifdef PHYSICS_COLLIDE_ONLY
+    return;
+#endif
+
+    int manifoldsCount = mContactPairs.mCount;
+    int* const manifoldsIndices = gArenaFrame.AllocOrDie<int>(manifoldsCount, Arena::FlagNoZero);
+    for (int i = 0; i < manifoldsCount; ++i)
+    {
+        manifoldsIndices[i] = i;
+    }
+
+    int* islands = nullptr;
+    if (mIsSleepingEnabled)
+    {
+        gTimeMeters[TimeMeter::PhysicsIslands].Start();
+        islands = BuildIslands(manifoldsIndices, manifoldsCount);
+
+        // Contacts inside sleeping islands and with static bodies only aren't solved.
+        int activeCount = 0;
+        for (int i = 0; i < manifoldsCount; ++i)
+        {
+            const ContactManifold::Key key = mContactManifoldsKeys[manifoldsIndices[i]];
+            if (IsBodyActive(mBodies[key.mBodyId1]) || IsBodyActive(mBodies[key.mBodyId2]))
+            {
+                manifoldsIndices[activeCount++] = manifoldsIndices[i];
+            }
+        }
+        manifoldsCount = activeCount;
+        gTimeMeters[TimeMeter::PhysicsIslands].End();
+    }
+
+    gTimeMeters[TimeMeter::PhysicsInertiasWorld].Start();
+    const bool isSoftStep = mSolverType == ContactSolverType::SoftStep;
+    mSolverBodies = gArenaFrame.AllocOrDie<SolverBody>(mBodiesCount, Arena::FlagNoZero);
+    mSolverDeltas = isSoftStep
+        ? gArenaFrame.AllocOrDie<SolverBodyDelta>(mBodiesCount, Arena::FlagNoZero)
+        : nullptr;
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        const Body& b = mBodies[i];
+        SolverBody& sb = mSolverBodies[i];
+        if (isSoftStep)
+        {
+            mSolverDeltas[i] = {b.mOrientation, {}, {}};
+        }
+        if (b.mIsAsleep)
+        {
+            // Not touched by the solver, zero mass skips the integration as well.
+            sb = {};
+            continue;
+        }
+        const Mat3 rot = ToMat3(b.mOrientation);
+        sb.mInverseInertia = rot * b.mInverseInertia * Transpose(rot);
+        sb.mVelocity = b.mVelocity;
+        sb.mAngularVelocity = b.mAngularVelocity;
+        sb.mInverseMass = b.mInverseMass;
+    }
+    gTimeMeters[TimeMeter::PhysicsInertiasWorld].End();
+
+    // The soft step solver integrates the forces every sub-step.
+    if (!isSoftStep)
+    {
+        gTimeMeters[TimeMeter::PhysicsIntegrateForces].Start();
+        IntegrateForces(mBodies, mSolverBodies, mBodiesCount, mGravity, timeStep);
+        gTimeMeters[TimeMeter::PhysicsIntegrateForces].End();
+    }
+
+    gTimeMeters[TimeMeter::PhysicsPrestep].Start();
+    ThreadPool* const pool = mThreadPool;
+    const bool isWide = mSolverType == ContactSolverType::Wide;
+    // Colors are needed for SIMD lanes and threads, otherwise the plain loop is cheaper. Any
+    // pool colors, even with one thread, so the order and the results don't depend on its size.
+    const bool isColored = isWide || pool;
+    ConstraintGraph graph{};
+    ContactSolverWide wideSolver{};
+    // Manifolds for the serial loop, when colored only the graph overflow.
+    const int* serialIndices = manifoldsIndices;
+    int serialCount = manifoldsCount;
+    if (isColored)
+    {
+        graph.Build(
+            gArenaFrame,
+            mSolverBodies,
+            mBodiesCount,
+            mContactManifoldsKeys,
+            manifoldsIndices,
+            manifoldsCount
+        );
+        serialIndices = graph.mOverflowManifolds;
+        serialCount = graph.mOverflowCount;
+    }
+
+    constexpr int BATCH = PHYSICS_SOLVER_MIN_BATCH;
+    constexpr int WIDE_BATCH = (PHYSICS_SOLVER_MIN_BATCH + FLOAT_W_WIDTH - 1) / FLOAT_W_WIDTH;
+    // Calls function(index) for the manifolds solved by the scalar code: the colors in parallel
+    // (unless the wide solver has them), then the serial ones.
+    const auto forEachScalarManifold = [&](const auto& function)
+    {
+        if (isColored && !isWide)
+        {
+            ForEachColor(
+                pool,
+                graph.mColorsStart,
+                BATCH,
+                [&](int begin, int end)
+                {
+                    for (int i = begin; i < end; ++i)
+                    {
+                        function(graph.mManifolds[i]);
+                    }
+                }
+            );
+        }
+        for (int i = 0; i < serialCount; ++i)
+        {
+            function(serialIndices[i]);
+        }
+    };
+
+    if (isWide)
+    {
+        wideSolver.Prepare(
+            gArenaFrame,
+            graph,
+            mBodies,
+            mSolverBodies,
+            mContactManifolds,
+            mContactManifoldsKeys
+        );
+        ParallelFor(
+            pool,
+            wideSolver.mBundlesCount,
+            WIDE_BATCH,
+            [&](int begin, int end, int) { wideSolver.Prestep(begin, end, inverseTimeStep); }
+        );
+        ForEachColor(
+            pool,
+            wideSolver.mColorsBundlesStart,
+            WIDE_BATCH,
+            [&](int begin, int end) { wideSolver.WarmStart(mSolverBodies, begin, end); }
+        );
+    }
+    if (isSoftStep)
+    {
+        // Warm started every sub-step.
+        forEachScalarManifold(
+            [&](int index)
+            { ManifoldPrepare(mContactManifoldsKeys[index], mContactManifolds[index]); }
+        );
+    }
+    else
+    {
+        forEachScalarManifold(
+            [&](int index)
+            {
+                ManifoldPrestep(
+                    mContactManifoldsKeys[index],
+                    mContactManifolds[index],
+                    inverseTimeStep
+                );
+            }
+        );
+    }
+    gTimeMeters[TimeMeter::PhysicsPrestep].End();
+
+    gTimeMeters[TimeMeter::PhysicsApplyImpulse].Start();
+    if (isSoftStep)
+    {
+        // Solver2D, Erin Catto: a sub-step is a solve with the soft bias, the integration of the
+        // positions and a relax iteration without the bias which removes the velocity it added.
+        const f32 subStep = timeStep / static_cast<f32>(mSubStepsCount);
+        const f32 inverseSubStep = 1.0f / subStep;
+        const f32 contactHertz = Min(PHYSICS_CONTACT_HERTZ, 0.25f * inverseSubStep);
+        const ContactSoftness softness
+            = MakeSoftness(contactHertz, PHYSICS_CONTACT_DAMPING_RATIO, subStep);
+        const ContactSoftness staticSoftness
+            = MakeSoftness(2.0f * contactHertz, PHYSICS_CONTACT_DAMPING_RATIO, subStep);
+        const auto applyImpulses = [&](bool useBias)
+        {
+            forEachScalarManifold(
+                [&](int index)
+                {
+                    ManifoldApplyImpulseSoft(
+                        mContactManifoldsKeys[index],
+                        mContactManifolds[index],
+                        softness,
+                        staticSoftness,
+                        inverseSubStep,
+                        useBias
+                    );
+                }
+            );
+        };
+
+        for (int subStepIndex = 0; subStepIndex < mSubStepsCount; ++subStepIndex)
+        {
+            IntegrateForces(mBodies, mSolverBodies, mBodiesCount, mGravity, subStep);
+            forEachScalarManifold(
+                [&](int index)
+                { ManifoldWarmStart(mContactManifoldsKeys[index], mContactManifolds[index]); }
+            );
+            applyImpulses(true);
+            for (int i = 0; i < mBodiesCount; ++i)
+            {
+                const SolverBody& sb = mSolverBodies[i];
+                if (sb.mInverseMass == 0.0f)
+                {
+                    continue;
+                }
+                SolverBodyDelta& d = mSolverDeltas[i];
+                d.mPosition += sb.mVelocity * subStep;
+                d.mRotation += sb.mAngularVelocity * subStep;
+                d.mOrientation = IntegrateOrientation(d.mOrientation, sb.mAngularVelocity, subStep);
+            }
+            applyImpulses(false);
+        }
+    }
+    else
+    {
+        const int iterationsCount = mIterationsCount;
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            if (isWide)
+            {
+                ForEachColor(
+                    pool,
+                    wideSolver.mColorsBundlesStart,
+                    WIDE_BATCH,
+                    [&](int begin, int end) { wideSolver.ApplyImpulses(mSolverBodies, begin, end); }
+                );
+            }
+            forEachScalarManifold(
+                [&](int index)
+                { ManifoldApplyImpulse(mContactManifoldsKeys[index], mContactManifolds[index]); }
+            );
+        }
+    }
+    if (isWide)
+    {
+        ParallelFor(
+            pool,
+            wideSolver.mBundlesCount,
+            WIDE_BATCH,
+            [&](int begin, int end, int)
+            { wideSolver.StoreImpulses(mContactManifolds, begin, end); }
+        );
+    }
+    gTimeMeters[TimeMeter::PhysicsApplyImpulse].End();
+
+    gTimeMeters[TimeMeter::PhysicsIntegrateVelocities].Start();
+    // Bullets which can pass through something during this step, their sweeps start here.
+    int bulletsCount = 0;
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        bulletsCount += IsBulletFast(mBodies[i], mSolverBodies[i], timeStep);
+    }
+    Body::Id* const bulletIds = gArenaFrame.AllocOrDie<Body::Id>(bulletsCount, Arena::FlagNoZero);
+    Sweep* const sweeps = gArenaFrame.AllocOrDie<Sweep>(bulletsCount, Arena::FlagNoZero);
+    bulletsCount = 0;
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        const Body& b = mBodies[i];
+        if (IsBulletFast(b, mSolverBodies[i], timeStep))
+        {
+            bulletIds[bulletsCount] = i;
+            sweeps[bulletsCount].mPosition0 = b.mPosition;
+            sweeps[bulletsCount].mOrientation0 = b.mOrientation;
+            ++bulletsCount;
+        }
+    }
+
+    // How far the other bodies get from their broad-phase bounds, for the bullets.
+    f32 maxDisplacementSq = 0.0f;
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        Body& b = mBodies[i];
+        const SolverBody& sb = mSolverBodies[i];
+        if (b.mIsAsleep)
+        {
+            continue;
+        }
+        const Vec3 position = b.mPosition;
+
+        b.mVelocity = sb.mVelocity;
+        b.mAngularVelocity = sb.mAngularVelocity;
+        if (isSoftStep)
+        {
+            // Moved by the sub-steps already.
+            b.mPosition += mSolverDeltas[i].mPosition;
+            b.mOrientation = mSolverDeltas[i].mOrientation;
+        }
+        else
+        {
+            b.mPosition += b.mVelocity * timeStep;
+            b.mOrientation = IntegrateOrientation(b.mOrientation, b.mAngularVelocity, timeStep);
+        }
+        if (!b.mIsBullet)
+        {
+            maxDisplacementSq = Max(maxDisplacementSq, MagnitudeSq(b.mPosition - position));
+        }
+
+        Clear(b.mForce);
+        Clear(b.mTorque);
+    }
+    mSolverDeltas = nullptr;
+    mSolverBodies = nullptr;
+    if (mIsSleepingEnabled)
+    {
+        UpdateSleeping(islands);
+    }
+    gTimeMeters[TimeMeter::PhysicsIntegrateVelocities].End();
+
+    if (bulletsCount > 0)
+    {
+        for (int i = 0; i < bulletsCount; ++i)
+        {
+            const Body& b = mBodies[bulletIds[i]];
+            sweeps[i].mPosition1 = b.mPosition;
+            sweeps[i].mOrientation1 = b.mOrientation;
+        }
+        SolveContinuous(bulletIds, sweeps, bulletsCount, sqrtf(maxDisplacementSq));
+    }
+}
+
+// Smallest distance from the center of the body to its surface.
+static f32 GetMinExtent(const Body& body, const ConvexHull* convexHulls)
+{
+    if (body.mShape == Body::Shape::Sphere)
+    {
+        return body.mRadius;
+    }
+    if (body.mShape == Body::Shape::Box)
+    {
+        const Vec3 halfExtents = body.mBox.mHalfExtents;
+        return Min(halfExtents.X(), Min(halfExtents.Y(), halfExtents.Z()));
+    }
+
+    const ConvexHull& hull = convexHulls[body.mConvexHull.mId];
+    const Vec3 scale = body.mConvexHull.mScale;
+    f32 minExtent = body.mRadius;
+    for (int i = 0; i < hull.mFacesCount; ++i)
+    {
+        minExtent = Min(minExtent, -Distance(Scale(hull.mFacePlanes[i], scale), hull.mCentroid));
+    }
+    return minExtent;
+}
+
+bool World::IsBulletFast(const Body& body, const SolverBody& solverBody, f32 timeStep) const
+{
+    if (!body.mIsBullet || !IsBodyActive(body))
+    {
+        return false;
+    }
+    const f32 maxMotion = PHYSICS_CCD_MOTION_FRACTION * GetMinExtent(body, mConvexHulls);
+    return MagnitudeSq(solverBody.mVelocity) * Square(timeStep) > Square(maxMotion);
+}
+
+// Squared distance from point to segment [a, b].
+static f32 DistanceSqPointSegment(Vec3 point, Vec3 a, Vec3 b)
+{
+    const Vec3 ab = b - a;
+    const f32 abMagnitudeSq = MagnitudeSq(ab);
+    f32 t = abMagnitudeSq > 0.0f ? Dot(point - a, ab) / abMagnitudeSq : 0.0f;
+    t = Min(Max(t, 0.0f), 1.0f);
+    return MagnitudeSq(point - (a + ab * t));
+}
+
+void World::SolveContinuous(
+    const Body::Id* bulletIds,
+    const Sweep* sweeps,
+    int bulletsCount,
+    f32 maxDisplacement
+)
+{
+    gTimeMeters[TimeMeter::PhysicsContinuous].Start();
+    for (int k = 0; k < bulletsCount; ++k)
+    {
+        const Body::Id bulletId = bulletIds[k];
+        Body& bullet = mBodies[bulletId];
+        const Sweep& sweep = sweeps[k];
+
+        // The other bodies are at rest in their final poses, only the ones touching the
+        // swept bounding sphere are tested.
+        f32 timeOfImpact = 1.0f;
+        const auto testBody = [&](const Body& other)
+        {
+            const f32 radiusSum = bullet.mRadius + other.mRadius;
+            if (DistanceSqPointSegment(other.mPosition, sweep.mPosition0, sweep.mPosition1)
+                <= Square(radiusSum))
+            {
+                timeOfImpact = Min(timeOfImpact, TimeOfImpact(*this, bullet, sweep, other));
+            }
+        };
+
+        // Bullets don't see each other, they haven't been moved to their times of impact yet.
+        const auto testOther = [&](Body::Id otherId)
+        {
+            const Body& other = mBodies[otherId];
+            if (other.mInverseMass == 0.0f || !other.mIsBullet)
+            {
+                testBody(other);
+            }
+        };
+
+#ifdef PHYSICS_NO_BROADPHASE
+        // No broad-phase structures, the static tree is empty too.
+        (void)maxDisplacement;
+        for (int i = 0; i < mBodiesCount; ++i)
+        {
+            testOther(i);
+        }
+#else
+        const Vec3 radius{bullet.mRadius};
+        const Aabb sweptAabb = Union(
+            {sweep.mPosition0 - radius, sweep.mPosition0 + radius},
+            {sweep.mPosition1 - radius, sweep.mPosition1 + radius}
+        );
+        mStaticTree.Query(
+            sweptAabb,
+            [&](int proxyId)
+            {
+                testOther(mStaticTree.GetUserData(proxyId));
+                return true;
+            }
+        );
 
-    return 0;
+        // The broad phase has the dynamic bodies where they were before this step.
+        const Vec3 displacement{maxDisplacement};
+        BroadPhaseQuery(
+            {sweptAabb.mMin - displacement, sweptAabb.mMax + displacement},
+            testOther
+        );
+#endif
+
+        // The rest of the step is lost, the velocity is kept for the contact to deal with.
+        if (timeOfImpact < 1.0f)
+        {
+            const TransformQuat pose = GetSweepTransform(sweep, timeOfImpact);
+            bullet.mPosition = pose.mTranslation;
+            bullet.mOrientation = pose.mRotation;
+        }
+    }
+    gTimeMeters[TimeMeter::PhysicsContinuous].End();
 }
 
-bool World::IsBodyIdValid(Body::Id bodyId) const
+static int IslandFind(int* parents, int i)
 {
-    return bodyId >= 0 && bodyId < mBodiesCount;
+    // Path halving.
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
 }
 
-void World::Step()
+int* World::BuildIslands(const int* manifoldsIndices, int manifoldsCount)
 {
-    const f32 timeStep = mTimeStep;
-    const f32 inverseTimeStep = 1.0f / mTimeStep;
-
-    gTimeMeters[TimeMeter::PhysicsContactManifold].Start();
-    BroadPhase();
-    gTimeMeters[TimeMeter::PhysicsContactManifold].End();
-
-#ifdef PHYSICS_COLLIDE_ONLY
-    return;
-#endif
-
-    gTimeMeters[TimeMeter::PhysicsInertiasWorld].Start();
+    int* const islands = gArenaFrame.AllocOrDie<int>(mBodiesCount, Arena::FlagNoZero);
     for (int i = 0; i < mBodiesCount; ++i)
     {
-        Body& b = mBodies[i];
-        const Mat3 rot = ToMat3(b.mOrientation);
-        b.mInverseInertia = rot * mInverseInertiasLocal[i] * Transpose(rot);
+        islands[i] = i;
     }
-    gTimeMeters[TimeMeter::PhysicsInertiasWorld].End();
 
-    gTimeMeters[TimeMeter::PhysicsIntegrateForces].Start();
-    for (int i = 0; i < mBodiesCount; ++i)
+    // Static bodies don't connect islands, the floor would merge everything into one.
+    for (int i = 0; i < manifoldsCount; ++i)
     {
-        Body& b = mBodies[i];
-
-        if (b.mInverseMass == 0.0f)
+        const ContactManifold::Key key = mContactManifoldsKeys[manifoldsIndices[i]];
+        if (mBodies[key.mBodyId1].mInverseMass == 0.0f
+            || mBodies[key.mBodyId2].mInverseMass == 0.0f)
         {
             continue;
         }
-
-        b.mVelocity += (mGravity + b.mForce * b.mInverseMass) * timeStep;
-        b.mAngularVelocity += (b.mInverseInertia * b.mTorque) * timeStep;
-
-        // Damping logic is from box2d.
-        // Differential equation: dv/dt + c * v = 0
-        // Solution: v(t) = v0 * exp(-c * t)
-        //
-        // Time step: v(t + dt) = v0 * exp(-c * (t + dt)) =
-        // = v0 * exp(-c * t) * exp(-c * dt) = v(t) * exp(-c * dt)
-        //
-        // v2 = exp(-c * dt) * v1
-        //
-        // Pade approximation:
-        // v2 = v1 * 1 / (1 + c * dt)
-        b.mVelocity *= 1.0f / (1.0f + timeStep * b.mLinearDamping);
-        b.mAngularVelocity *= 1.0f / (1.0f + timeStep * b.mAngularDamping);
+        const int root1 = IslandFind(islands, key.mBodyId1);
+        const int root2 = IslandFind(islands, key.mBodyId2);
+        if (root1 != root2)
+        {
+            // Lower id as the root keeps the result independent of the manifolds order.
+            islands[Max(root1, root2)] = Min(root1, root2);
+        }
     }
-    gTimeMeters[TimeMeter::PhysicsIntegrateForces].End();
 
-    int manifoldsIndices[PHYSICS_MAX_CONTACT_MANIFOLDS];
-    int manifoldsCount = 0;
-    for (int i = 0; i < PHYSICS_MAX_CONTACT_MANIFOLDS; ++i)
+    bool* const isIslandAwake = gArenaFrame.AllocOrDie<bool>(mBodiesCount);
+    for (int i = 0; i < mBodiesCount; ++i)
     {
-        if (Utils::BitCast<u64>(mContactManifoldsKeys[i]) != UINT64_MAX)
+        islands[i] = IslandFind(islands, i);
+        if (IsBodyActive(mBodies[i]))
         {
-            manifoldsIndices[manifoldsCount++] = i;
+            isIslandAwake[islands[i]] = true;
         }
     }
-    assert(manifoldsCount == mContactManifoldsCount);
 
-    gTimeMeters[TimeMeter::PhysicsPrestep].Start();
-    for (int i = 0; i < manifoldsCount; ++i)
+    // A sleeping island touched by an awake body wakes up as a whole.
+    for (int i = 0; i < mBodiesCount; ++i)
     {
-        const int index = manifoldsIndices[i];
-        ManifoldPrestep(mContactManifoldsKeys[index], mContactManifolds[index], inverseTimeStep);
+        Body& b = mBodies[i];
+        if (b.mIsAsleep && isIslandAwake[islands[i]])
+        {
+            b.mIsAsleep = false;
+            b.mSleepTime = 0.0f;
+        }
     }
-    gTimeMeters[TimeMeter::PhysicsPrestep].End();
 
-    gTimeMeters[TimeMeter::PhysicsApplyImpulse].Start();
-    const int iterationsCount = mIterationsCount;
-    for (int iteration = 0; iteration < iterationsCount; ++iteration)
+    return islands;
+}
+
+void World::UpdateSleeping(const int* islands)
+{
+    assert(islands);
+
+    constexpr f32 LINEAR_SQ = Square(PHYSICS_SLEEP_LINEAR_VELOCITY);
+    constexpr f32 ANGULAR_SQ = Square(PHYSICS_SLEEP_ANGULAR_VELOCITY);
+
+    // Time the island has been at rest is the minimum over its bodies.
+    f32* const islandsSleepTime
+        = gArenaFrame.AllocOrDie<f32>(mBodiesCount, Arena::FlagNoZero);
+    for (int i = 0; i < mBodiesCount; ++i)
     {
-        for (int i = 0; i < manifoldsCount; ++i)
+        islandsSleepTime[i] = FLT_MAX;
+    }
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        Body& b = mBodies[i];
+        if (b.mInverseMass == 0.0f || b.mIsAsleep)
+        {
+            continue;
+        }
+
+        if (MagnitudeSq(b.mVelocity) > LINEAR_SQ || MagnitudeSq(b.mAngularVelocity) > ANGULAR_SQ)
+        {
+            b.mSleepTime = 0.0f;
+        }
+        else
         {
-            const int index = manifoldsIndices[i];
-            ManifoldApplyImpulse(mContactManifoldsKeys[index], mContactManifolds[index]);
+            b.mSleepTime += mTimeStep;
         }
+        f32& islandSleepTime = islandsSleepTime[islands[i]];
+        islandSleepTime = Min(islandSleepTime, b.mSleepTime);
     }
-    gTimeMeters[TimeMeter::PhysicsApplyImpulse].End();
 
-    gTimeMeters[TimeMeter::PhysicsIntegrateVelocities].Start();
     for (int i = 0; i < mBodiesCount; ++i)
     {
         Body& b = mBodies[i];
-
-        b.mPosition += b.mVelocity * timeStep;
-
-        Quat angVelDt = ToQuat(b.mAngularVelocity * timeStep);
-        angVelDt = angVelDt * b.mOrientation;
-        b.mOrientation.W() += angVelDt.W() * 0.5f;
-        b.mOrientation.X() += angVelDt.X() * 0.5f;
-        b.mOrientation.Y() += angVelDt.Y() * 0.5f;
-        b.mOrientation.Z() += angVelDt.Z() * 0.5f;
-        b.mOrientation = Normalize(b.mOrientation);
-
-        Clear(b.mForce);
-        Clear(b.mTorque);
+        if (b.mInverseMass == 0.0f || b.mIsAsleep)
+        {
+            continue;
+        }
+        if (islandsSleepTime[islands[i]] >= PHYSICS_TIME_TO_SLEEP)
+        {
+            b.mIsAsleep = true;
+            Clear(b.mVelocity);
+            Clear(b.mAngularVelocity);
+        }
     }
-    gTimeMeters[TimeMeter::PhysicsIntegrateVelocities].End();
 }
 
 void World::Reset()
@@ -609,7 +1741,19 @@ Vec3 World::GetPosition(Body::Id bodyId) const
 
 void World::SetPosition(Body::Id bodyId, Vec3 position)
 {
-    mBodies[bodyId].mPosition = position;
+    Body& body = mBodies[bodyId];
+    body.mPosition = position;
+    if (body.mInverseMass == 0.0f)
+    {
+        if (body.mProxyId != DynamicTree::NODE_NULL)
+        {
+            mStaticTree.MoveProxy(body.mProxyId, BodyComputeAabb(body));
+        }
+        return;
+    }
+    // The rest of its island wakes up on the next step.
+    body.mIsAsleep = false;
+    body.mSleepTime = 0.0f;
 }
 
 Quat World::GetOrientation(Body::Id bodyId) const
@@ -620,8 +1764,12 @@ Quat World::GetOrientation(Body::Id bodyId) const
 Vec3 World::GetScale(Body::Id bodyId) const
 {
     const Body& body = mBodies[bodyId];
+    if (body.mShape == Body::Shape::Box)
+    {
+        return body.mBox.mHalfExtents * 2.0f;
+    }
     assert(body.mShape == Body::Shape::ConvexHull);
-    return mConvexHulls[body.mConvexHull.mId].mScale;
+    return mConvexHulls[body.mConvexHull.mId].mScale * body.mConvexHull.mScale;
 }
 
 f32 World::GetRadius(Body::Id bodyId) const
@@ -630,6 +1778,59 @@ f32 World::GetRadius(Body::Id bodyId) const
     return body.mRadius;
 }
 
+bool World::IsAsleep(Body::Id bodyId) const
+{
+    return mBodies[bodyId].mIsAsleep;
+}
+
+int World::GetBodiesCount() const
+{
+    return mBodiesCount;
+}
+
+int World::GetAwakeBodiesCount() const
+{
+    int count = 0;
+    for (int i = 0; i < mBodiesCount; ++i)
+    {
+        count += IsBodyActive(mBodies[i]);
+    }
+    return count;
+}
+
+int World::GetContactManifoldsCount() const
+{
+    return mContactPairs.mCount;
+}
+
+int World::GetContactManifoldsCapacity() const
+{
+    return mContactManifoldsCapacity;
+}
+
+const HGrid& World::GetHGrid() const
+{
+    return mHGrid;
+}
+
+const Slice<ConvexHull> World::GetConvexHulls() const
+{
+    return Slice<ConvexHull>{mConvexHulls, mConvexHullsCount};
+}
+
+const ConvexHull& World::GetBodyHull(const Body& body, Vec3& scale) const
+{
+    if (body.mShape == Body::Shape::Box)
+    {
+        scale = body.mBox.mHalfExtents;
+        return mBoxHull;
+    }
+    assert(body.mShape == Body::Shape::ConvexHull);
+    assert(body.mConvexHull.mId < mConvexHullsCount);
+    scale = body.mConvexHull.mScale;
+    return mConvexHulls[body.mConvexHull.mId];
+}
+
 #ifdef PHYSICS_DEBUG
 
 void World::DebugDraw(bool drawSpheres, bool drawContacts) const
@@ -642,22 +1843,22 @@ void World::DebugDraw(bool drawSpheres, bool drawContacts) const
 
     if (drawSpheres)
     {
-        // Without the floor.
-        for (int i = 1; i < mBodiesCount; ++i)
+        // Static bodies can be huge (like the floor).
+        for (int i = 0; i < mBodiesCount; ++i)
         {
             const Body& b = mBodies[i];
+            if (b.mInverseMass == 0.0f)
+            {
+                continue;
+            }
             gRenderer.DrawSphere(b.mPosition, b.mOrientation, b.mRadius, BODIES_COLOR);
         }
     }
 
     if (drawContacts)
     {
-        for (int i = 0; i < PHYSICS_MAX_CONTACT_MANIFOLDS; ++i)
+        for (int i = 0; i < mContactPairs.mCount; ++i)
         {
-            if (Utils::BitCast<u64>(mContactManifoldsKeys[i]) == UINT64_MAX)
-            {
-                continue;
-            }
             const ContactManifold& m = mContactManifolds[i];
             for (int j = 0; j < m.mContactsCount; ++j)
             {
@@ -677,26 +1878,6 @@ void World::DebugDraw(bool drawSpheres, bool drawContacts) const
     }
 }
 
-int World::GetBodiesCount() const
-{
-    return mBodiesCount;
-}
-
-int World::GetContactManifoldsCount() const
-{
-    return mContactManifoldsCount;
-}
-
-const HGrid& World::GetHGrid() const
-{
-    return mHGrid;
-}
-
-const Slice<ConvexHull> World::GetConvexHulls() const
-{
-    return Slice<ConvexHull>{mConvexHulls, mConvexHullsCount};
-}
-
 void World::DebugPrintBodiesInfo() const
 {
     ImGui::Begin("Physics bodies info");
@@ -709,13 +1890,9 @@ void World::DebugPrintBodiesInfo() const
         ImGui::Text("pos = %.3f %.3f %.3f", b.mPosition.X(), b.mPosition.Y(), b.mPosition.Z());
     }
 
-    ImGui::Text("manifolds (count = %d)", mContactManifoldsCount);
-    for (int i = 0; i < mContactManifoldsCount; ++i)
+    ImGui::Text("manifolds (count = %d)", mContactPairs.mCount);
+    for (int i = 0; i < mContactPairs.mCount; ++i)
     {
-        if (Utils::BitCast<u64>(mContactManifoldsKeys[i]) == UINT64_MAX)
-        {
-            continue;
-        }
         const ContactManifold::Key k = mContactManifoldsKeys[i];
         const ContactManifold& m = mContactManifolds[i];
         const Body::Id id1 = k.mBodyId1;
@@ -754,7 +1931,13 @@ void World::DebugPrintBodiesInfo() const
 
 #endif
 
-void World::ManifoldInit(ContactManifold& manifold, Body::Id bodyId1, Body::Id bodyId2) const
+void World::ManifoldInit(
+    ContactManifold& manifold,
+    SatCache& satCache,
+    Body::Id bodyId1,
+    Body::Id bodyId2,
+    Arena& scratch
+) const
 {
     assert(bodyId1 > -1);
     assert(bodyId2 > -1);
@@ -762,26 +1945,29 @@ void World::ManifoldInit(ContactManifold& manifold, Body::Id bodyId1, Body::Id b
     const Body& body1 = mBodies[bodyId1];
     const Body& body2 = mBodies[bodyId2];
 
-    Collide(manifold, *this, body1, body2);
+    Collide(manifold, satCache, *this, body1, body2, scratch);
     manifold.mFriction = sqrtf(body1.mFriction * body2.mFriction);
 }
 
-void World::ManifoldPrestep(
-    ContactManifold::Key key,
-    ContactManifold& manifold,
-    f32 inverseTimeStep
-) const
+// A static body may be in several manifolds solved at the same time, it's never written.
+static void StoreVelocities(SolverBody& dst, const SolverBody& src)
 {
-    assert(inverseTimeStep > 0.0f);
-
-    constexpr f32 ALLOWED_PENETRATION = 0.05f;
-    constexpr f32 BIAS_FACTOR = 0.2f; // For Baumgarte stabilization.
+    if (src.mInverseMass != 0.0f)
+    {
+        dst.mVelocity = src.mVelocity;
+        dst.mAngularVelocity = src.mAngularVelocity;
+    }
+}
 
+void World::ManifoldPrepare(ContactManifold::Key key, ContactManifold& manifold) const
+{
     // Derivation of normal/tangent masses is explained here:
     // https://danielchappuis.ch/download/ConstraintsDerivationRigidBody3D.pdf
 
-    Body& body1 = mBodies[key.mBodyId1];
-    Body& body2 = mBodies[key.mBodyId2];
+    const Vec3 position1 = mBodies[key.mBodyId1].mPosition;
+    const Vec3 position2 = mBodies[key.mBodyId2].mPosition;
+    const SolverBody& body1 = mSolverBodies[key.mBodyId1];
+    const SolverBody& body2 = mSolverBodies[key.mBodyId2];
 
     const f32 sumInvMass = body1.mInverseMass + body2.mInverseMass;
 
@@ -789,8 +1975,11 @@ void World::ManifoldPrestep(
     {
         ContactPoint* const c = manifold.mContacts + i;
 
-        const Vec3 r1 = c->mPosition - body1.mPosition;
-        const Vec3 r2 = c->mPosition - body2.mPosition;
+        // Positions don't change during the solver iterations.
+        const Vec3 r1 = c->mPosition - position1;
+        const Vec3 r2 = c->mPosition - position2;
+        c->mBody1ToPosition = r1;
+        c->mBody2ToPosition = r2;
 
         // Precompute normal mass.
         const Vec3 crossR1Normal = Cross(r1, manifold.mNormal);
@@ -812,31 +2001,58 @@ void World::ManifoldPrestep(
             assert(kTangent != 0.0f);
             c->mMassTangent[j] = 1.0f / kTangent;
         }
+    }
+}
+
+void World::ManifoldWarmStart(ContactManifold::Key key, ContactManifold& manifold) const
+{
+    SolverBody body1 = mSolverBodies[key.mBodyId1];
+    SolverBody body2 = mSolverBodies[key.mBodyId2];
 
-        c->mBias = -BIAS_FACTOR * inverseTimeStep * Min(0.0f, c->mSeparation + ALLOWED_PENETRATION);
+    for (int i = 0; i < manifold.mContactsCount; ++i)
+    {
+        const ContactPoint* const c = manifold.mContacts + i;
 
         const Vec3 impulse = manifold.mNormal * c->mImpulseNormal
             + manifold.mTangents[0] * c->mImpulseTangent[0]
             + manifold.mTangents[1] * c->mImpulseTangent[1];
 
         body1.mVelocity -= impulse * body1.mInverseMass;
-        body1.mAngularVelocity -= body1.mInverseInertia * Cross(r1, impulse);
+        body1.mAngularVelocity -= body1.mInverseInertia * Cross(c->mBody1ToPosition, impulse);
 
         body2.mVelocity += impulse * body2.mInverseMass;
-        body2.mAngularVelocity += body2.mInverseInertia * Cross(r2, impulse);
+        body2.mAngularVelocity += body2.mInverseInertia * Cross(c->mBody2ToPosition, impulse);
     }
+
+    StoreVelocities(mSolverBodies[key.mBodyId1], body1);
+    StoreVelocities(mSolverBodies[key.mBodyId2], body2);
 }
 
-void World::ManifoldApplyImpulse(ContactManifold::Key key, ContactManifold& manifold) const
+void World::ManifoldPrestep(
+    ContactManifold::Key key,
+    ContactManifold& manifold,
+    f32 inverseTimeStep
+) const
 {
-    Body& b1 = mBodies[key.mBodyId1];
-    Body& b2 = mBodies[key.mBodyId2];
+    assert(inverseTimeStep > 0.0f);
+
+    ManifoldPrepare(key, manifold);
     for (int i = 0; i < manifold.mContactsCount; ++i)
     {
         ContactPoint* const c = manifold.mContacts + i;
+        c->mBias = -PHYSICS_BIAS_FACTOR * inverseTimeStep
+            * Min(0.0f, c->mSeparation + PHYSICS_ALLOWED_PENETRATION);
+    }
+    ManifoldWarmStart(key, manifold);
+}
 
-        c->mBody1ToPosition = c->mPosition - b1.mPosition;
-        c->mBody2ToPosition = c->mPosition - b2.mPosition;
+void World::ManifoldApplyImpulse(ContactManifold::Key key, ContactManifold& manifold) const
+{
+    SolverBody b1 = mSolverBodies[key.mBodyId1];
+    SolverBody b2 = mSolverBodies[key.mBodyId2];
+    for (int i = 0; i < manifold.mContactsCount; ++i)
+    {
+        ContactPoint* const c = manifold.mContacts + i;
 
         Vec3 relativeVelocity = b2.mVelocity + Cross(b2.mAngularVelocity, c->mBody2ToPosition)
             - b1.mVelocity - Cross(b1.mAngularVelocity, c->mBody1ToPosition);
@@ -882,6 +2098,103 @@ void World::ManifoldApplyImpulse(ContactManifold::Key key, ContactManifold& mani
             b2.mAngularVelocity += b2.mInverseInertia * Cross(c->mBody2ToPosition, impulseTangent);
         }
     }
+
+    StoreVelocities(mSolverBodies[key.mBodyId1], b1);
+    StoreVelocities(mSolverBodies[key.mBodyId2], b2);
+}
+
+void World::ManifoldApplyImpulseSoft(
+    ContactManifold::Key key,
+    ContactManifold& manifold,
+    const ContactSoftness& softness,
+    const ContactSoftness& staticSoftness,
+    f32 inverseSubStep,
+    bool useBias
+) const
+{
+    SolverBody b1 = mSolverBodies[key.mBodyId1];
+    SolverBody b2 = mSolverBodies[key.mBodyId2];
+    const SolverBodyDelta& d1 = mSolverDeltas[key.mBodyId1];
+    const SolverBodyDelta& d2 = mSolverDeltas[key.mBodyId2];
+    const ContactSoftness& soft
+        = b1.mInverseMass == 0.0f || b2.mInverseMass == 0.0f ? staticSoftness : softness;
+
+    for (int i = 0; i < manifold.mContactsCount; ++i)
+    {
+        ContactPoint* const c = manifold.mContacts + i;
+
+        // The separation is updated with the motion since the manifold was created, instead of
+        // colliding the bodies again.
+        const Vec3 displacement = d2.mPosition + Cross(d2.mRotation, c->mBody2ToPosition)
+            - d1.mPosition - Cross(d1.mRotation, c->mBody1ToPosition);
+        const f32 separation = c->mSeparation + Dot(displacement, manifold.mNormal);
+
+        f32 bias = 0.0f;
+        f32 massScale = 1.0f;
+        f32 impulseScale = 0.0f;
+        if (separation > 0.0f)
+        {
+            // Speculative, the bodies may approach by the separation during this sub-step.
+            bias = -separation * inverseSubStep;
+        }
+        else if (useBias)
+        {
+            bias = Min(
+                -soft.mBiasRate * Min(0.0f, separation + PHYSICS_ALLOWED_PENETRATION),
+                PHYSICS_CONTACT_PUSH_MAX_VELOCITY
+            );
+            massScale = soft.mMassScale;
+            impulseScale = soft.mImpulseScale;
+        }
+
+        Vec3 relativeVelocity = b2.mVelocity + Cross(b2.mAngularVelocity, c->mBody2ToPosition)
+            - b1.mVelocity - Cross(b1.mAngularVelocity, c->mBody1ToPosition);
+
+        const f32 relativeVelocityNormal = Dot(relativeVelocity, manifold.mNormal);
+
+        f32 impulseNormalMag = c->mMassNormal * massScale * (-relativeVelocityNormal + bias)
+            - impulseScale * c->mImpulseNormal;
+
+        const f32 impulseNormalMag0 = c->mImpulseNormal;
+        c->mImpulseNormal = Max(impulseNormalMag0 + impulseNormalMag, 0.0f);
+        impulseNormalMag = c->mImpulseNormal - impulseNormalMag0;
+
+        const Vec3 impulseNormal = manifold.mNormal * impulseNormalMag;
+
+        b1.mVelocity -= impulseNormal * b1.mInverseMass;
+        b1.mAngularVelocity -= b1.mInverseInertia * Cross(c->mBody1ToPosition, impulseNormal);
+
+        b2.mVelocity += impulseNormal * b2.mInverseMass;
+        b2.mAngularVelocity += b2.mInverseInertia * Cross(c->mBody2ToPosition, impulseNormal);
+
+        relativeVelocity = b2.mVelocity + Cross(b2.mAngularVelocity, c->mBody2ToPosition)
+            - b1.mVelocity - Cross(b1.mAngularVelocity, c->mBody1ToPosition);
+
+        for (int j = 0; j < 2; ++j)
+        {
+            f32 impulseTangentMag
+                = c->mMassTangent[j] * (-Dot(relativeVelocity, manifold.mTangents[j]));
+            const f32 maxImpulseTangent = manifold.mFriction * c->mImpulseNormal;
+            const f32 oldImpulseTangent = c->mImpulseTangent[j];
+            c->mImpulseTangent[j] = Clamp(
+                oldImpulseTangent + impulseTangentMag,
+                -maxImpulseTangent,
+                maxImpulseTangent
+            );
+            impulseTangentMag = c->mImpulseTangent[j] - oldImpulseTangent;
+
+            const Vec3 impulseTangent = manifold.mTangents[j] * impulseTangentMag;
+
+            b1.mVelocity -= impulseTangent * b1.mInverseMass;
+            b1.mAngularVelocity -= b1.mInverseInertia * Cross(c->mBody1ToPosition, impulseTangent);
+
+            b2.mVelocity += impulseTangent * b2.mInverseMass;
+            b2.mAngularVelocity += b2.mInverseInertia * Cross(c->mBody2ToPosition, impulseTangent);
+        }
+    }
+
+    StoreVelocities(mSolverBodies[key.mBodyId1], b1);
+    StoreVelocities(mSolverBodies[key.mBodyId2], b2);
 }
 
 void World::ManifoldUpdate(
@@ -906,7 +2219,7 @@ void World::ManifoldUpdate(
         for (int j = 0; j < manifold.mContactsCount; ++j)
         {
             const ContactPoint* const cOld = manifold.mContacts + j;
-            if (Utils::BitCast<u32>(cNew->mFeatureId) == Utils::BitCast<u32>(cOld->mFeatureId))
+            if (Utils::BitCast<u64>(cNew->mFeatureId) == Utils::BitCast<u64>(cOld->mFeatureId))
             {
                 k = j;
                 break;
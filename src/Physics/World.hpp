@@ -4,6 +4,9 @@
 
 #include "Geometry.hpp"
 #include "Config.hpp"
+#include "DynamicTree.hpp"
+#include "PairSet.hpp"
+#include "SweepAndPrune.hpp"
 
 struct Body
 {
@@ -14,18 +17,21 @@ struct Body
         enum : u8
         {
             Sphere,
+            Box,
             ConvexHull,
             Count,
         };
     };
 
-    Mat3 mInverseInertia;
-
+    // Pose, read by the collision detection every step.
     Quat mOrientation;
-
     Vec3 mPosition;
+
+    // Persistent between steps, copied to a SolverBody for the solver.
     Vec3 mVelocity;
     Vec3 mAngularVelocity;
+    Mat3 mInverseInertia; // Local space.
+
     Vec3 mForce;
     Vec3 mTorque;
 
@@ -38,10 +44,16 @@ struct Body
     // Per-shape data.
     struct ConvexHullData
     {
-        ConvexHull::Id mId;
+        ConvexHull::Id mId; // Shared by any number of bodies.
+        Vec3 mScale; // Of this body, may be non-uniform.
+    };
+    struct BoxData
+    {
+        Vec3 mHalfExtents;
     };
     union
     {
+        BoxData mBox;
         ConvexHullData mConvexHull;
         // ...
     };
@@ -51,8 +63,41 @@ struct Body
     f32 mLinearDamping;
     f32 mAngularDamping;
     f32 mInverseMass;
+    f32 mSleepTime; // How long the body has been at rest.
+
+    // Broad-phase proxy, the HGrid doesn't use it. In the static tree for static bodies.
+    int mProxyId;
 
     u8 mShape;
+    bool mIsAsleep;
+    bool mIsBullet; // Continuous collision detection, for small and fast bodies.
+};
+
+// The part of a body the contact solver touches, rebuilt every step (indexed by Body::Id).
+// Fits into a cache line, unlike Body.
+struct alignas(64) SolverBody
+{
+    Mat3 mInverseInertia; // World space.
+    Vec3 mVelocity;
+    Vec3 mAngularVelocity;
+    f32 mInverseMass;
+};
+static_assert(sizeof(SolverBody) == 64);
+
+// Motion of a body during the sub-steps of ContactSolverType::SoftStep, applied at the end.
+struct SolverBodyDelta
+{
+    Quat mOrientation;
+    Vec3 mPosition; // Displacement.
+    Vec3 mRotation; // Small angle approximation, for the contact separations.
+};
+
+// Contact as a damped spring, stiff relative to the sub-step (Solver2D, Erin Catto).
+struct ContactSoftness
+{
+    f32 mBiasRate;
+    f32 mMassScale;
+    f32 mImpulseScale;
 };
 
 struct ContactPoint
@@ -88,12 +133,37 @@ struct ContactManifold
     Vec3 mTangents[2];
     int mContactsCount;
     f32 mFriction;
+    bool mIsTouching; // Set by the narrow phase this step, stale manifolds are removed after it.
+};
+
+// Axis of the hull pair SAT from the last step, it's tested first by the next one: the pair is
+// separated along it or it still gives the contact (temporal coherence).
+// The Separating Axis Test between Convex Polyhedra, Dirk Gregorius.
+struct SatCache
+{
+    enum Type : u8
+    {
+        None,
+        Face1, // Face mIndex1 of the first hull.
+        Face2, // Face mIndex2 of the second hull.
+        Edges, // Edge mIndex1 of the first hull and edge mIndex2 of the second one.
+    };
+
+    int mIndex1;
+    int mIndex2;
+    f32 mSeparation; // Positive -- separating axis.
+    // Last support points of the hulls in the face queries, the hill climbing starts there.
+    int mSupportIndex1;
+    int mSupportIndex2;
+    u8 mType;
+    bool mIsCollided; // Set by the narrow phase this step, stale caches are removed after it.
 };
 
 // Real-Time Collision Detection, Christer Ericson.
+// Persistent between steps, only the objects that moved to another bucket are relinked.
 struct HGrid
 {
-    static constexpr int BUCKETS_COUNT = PHYSICS_MAX_BODIES * 4;
+    static constexpr int BUCKETS_PER_OBJECT = 4;
     static constexpr f32 LEVEL_SIZES[] = {0.4f, 4.0f};
 
     struct Cell
@@ -110,29 +180,83 @@ struct HGrid
         Object* mNext; // Embedded link to next hgrid object.
         Vec3 mPosition; // Bounding sphere center.
         f32 mRadius; // Bounding sphere radius.
-        int mBucket; // Index of hash bucket object is in.
+        int mBucket; // Index of hash bucket object is in, -1 -- not linked yet.
         int mLevel; // Grid level for the object.
         f32 mInverseMass;
         Body::Id mId;
+        bool mIsAsleep;
     };
 
     u32 mOccupiedLevelsMask;
     int mObjectsAtLevel[ARRAY_SIZE(LEVEL_SIZES)];
-    Object* mObjectBucket[BUCKETS_COUNT];
-    int mTimeStamp[BUCKETS_COUNT];
-    int mTick;
-    int mTestsCount;
+    Object* mObjects; // Object i is body i, static bodies aren't in the grid.
+    int mObjectsCount;
+    int mObjectsCapacity;
+    Object** mObjectBucket;
+    // Bucket was visited by the query with this tick, never cleared, so the tick only grows.
+    u32* mTimeStamp;
+    int mBucketsCount;
+    u32 mTick;
+    int mTestsCount; // During the last step.
+};
+
+enum class BroadPhaseType : u8
+{
+    HGrid, // Bounding spheres in a hierarchical hash grid, rebuilt incrementally.
+    AabbTree, // Dynamic AABB tree with a persistent pair set, see DynamicTree.
+    SweepAndPrune, // AABBs sorted along one axis, see SweepAndPrune.
+};
+
+enum class ContactSolverType : u8
+{
+    Sequential, // Scalar, one contact point at a time.
+    Wide, // SIMD, several manifolds at a time, see ContactSolverWide.
+    // Scalar, soft contacts solved once and relaxed once per sub-step, the bodies move between
+    // the sub-steps. The manifolds are still created once per step.
+    SoftStep,
+};
+
+struct ThreadPool;
+struct Sweep;
+
+struct WorldDesc
+{
+    Vec3 mGravity;
+    f32 mTimeStep;
+    int mIterationsCount; // Not used by ContactSolverType::SoftStep.
+    int mSubStepsCount; // ContactSolverType::SoftStep only, 0 -- default from Config.hpp.
+    ContactSolverType mSolver;
+    BroadPhaseType mBroadPhase;
+    // Optional, nullptr -- single-threaded. With a pool the results are the same for any
+    // threads count, but not the same as without one, the contacts are solved in another order.
+    ThreadPool* mThreadPool;
+    bool mDisableSleeping;
+
+    // Initial capacities, 0 -- defaults from Config.hpp. Storage grows when they're exceeded.
+    int mBodiesCapacity;
+    int mConvexHullsCapacity;
+    int mContactManifoldsCapacity;
 };
 
 // TODO: honestly this API design is kind of messed up but I can't be arsed.
 struct World
 {
-    void Init(Vec3 gravity, f32 timeStep, int iterations);
+    void Init(const WorldDesc& desc);
+    // The hull is copied and packed into gArenaReset, its mass properties are computed here.
     ConvexHull::Id AddConvexHull(const ConvexHull& hull);
     void BodyInitSphere(Body& body, f32 density, f32 radius) const;
-    void BodyInitConvexHull(Body& body, f32 density, ConvexHull::Id hullId) const;
+    void BodyInitBox(Body& body, f32 density, Vec3 halfExtents) const;
+    // The mass properties come from the shared hull and the scale of the body.
+    void BodyInitConvexHull(
+        Body& body,
+        f32 density,
+        ConvexHull::Id hullId,
+        Vec3 scale = Vec3{1.0f}
+    ) const;
+    // Bodies with zero inverse mass are static, they may be added in any number.
     Body::Id AddBody(const Body& body);
-    Body::Id SetFloor(const Body& floor);
+    // Copies of the body at the positions, their ids are consecutive from the returned one.
+    Body::Id AddBodies(const Body& body, const Vec3* positions, int count);
     bool IsBodyIdValid(Body::Id bodyId) const;
     void Step();
     void Reset();
@@ -144,44 +268,95 @@ struct World
 #endif
 
     int GetBodiesCount() const;
+    int GetAwakeBodiesCount() const; // Dynamic ones.
     int GetContactManifoldsCount() const;
+    int GetContactManifoldsCapacity() const;
     const HGrid& GetHGrid() const;
     const Slice<ConvexHull> GetConvexHulls() const;
+    // Hull of a box or a hull body and its scale. Boxes are a unit box scaled by their
+    // half-extents, for the pairs with hulls and the time of impact.
+    const ConvexHull& GetBodyHull(const Body& body, Vec3& scale) const;
 
     // Treating Body::Id as an opaque handle, requires accessors
     // but allows to freely mess with the memory, since we don't
     // give user pointers/references.
     Vec3 GetPosition(Body::Id bodyId) const;
+    // Wakes the body up. Static bodies can be moved too, but not the bodies at rest on them.
     void SetPosition(Body::Id bodyId, Vec3 position);
     Quat GetOrientation(Body::Id bodyId) const;
     Vec3 GetScale(Body::Id bodyId) const;
     f32 GetRadius(Body::Id bodyId) const;
+    bool IsAsleep(Body::Id bodyId) const;
     // ...
 
 private:
     static constexpr Body::Id BODY_ID_INVALID = -1;
 
+    BroadPhaseType mBroadPhaseType;
+    // Static bodies, queried by the awake dynamic ones, the dynamic broad-phases don't see them.
+    DynamicTree mStaticTree;
     HGrid mHGrid;
+    DynamicTree mTree;
+    PairSet mTreePairs; // Bodies with overlapping fat AABBs.
+    SweepAndPrune mSap;
     Body* mBodies;
-    Mat3* mInverseInertiasLocal;
+    SolverBody* mSolverBodies; // In gArenaFrame, valid during Step().
+    SolverBodyDelta* mSolverDeltas; // The same, ContactSolverType::SoftStep only.
     int mBodiesCount;
+    int mBodiesCapacity;
+    // Candidate pairs found by the broad-phase during this step, in gArenaFrame.
+    ContactManifold::Key* mPairs;
+    int mPairsCount;
+    int mPairsCapacity;
+    // Manifolds are dense, in the same order as the pairs in mContactPairs (which maps a key to
+    // the index), so iteration is over the existing manifolds only and removal is a swap.
+    PairSet mContactPairs;
     ContactManifold* mContactManifolds;
     ContactManifold::Key* mContactManifoldsKeys;
-    int mContactManifoldsCount;
+    int mContactManifoldsCapacity;
+    // SAT caches of the hull pairs collided by the last step, dense like the manifolds.
+    PairSet mSatPairs;
+    SatCache* mSatCaches;
+    int mSatCachesCapacity;
     Vec3 mGravity;
     int mIterationsCount;
+    int mSubStepsCount;
     f32 mTimeStep;
+    ContactSolverType mSolverType;
+    ThreadPool* mThreadPool;
+    bool mIsSleepingEnabled;
 
     ConvexHull* mConvexHulls;
     int mConvexHullsCount;
+    int mConvexHullsCapacity;
+    int mMaxFaceVerticesCount; // Of all the hulls, sizes the narrow-phase scratch.
+    ConvexHull mBoxHull; // Half-extents of 1, see GetBodyHull.
 
-    void ManifoldInit(ContactManifold& manifold, Body::Id bodyId1, Body::Id bodyId2) const;
+    void ManifoldInit(
+        ContactManifold& manifold,
+        SatCache& satCache,
+        Body::Id bodyId1,
+        Body::Id bodyId2,
+        Arena& scratch
+    ) const;
+    // Anchors and effective masses of the contacts.
+    void ManifoldPrepare(ContactManifold::Key key, ContactManifold& manifold) const;
+    void ManifoldWarmStart(ContactManifold::Key key, ContactManifold& manifold) const;
     void ManifoldPrestep(
         ContactManifold::Key key,
         ContactManifold& manifold,
         f32 inverseTimeStep
     ) const;
     void ManifoldApplyImpulse(ContactManifold::Key key, ContactManifold& manifold) const;
+    // Soft contacts of ContactSolverType::SoftStep, without the bias it's the relax iteration.
+    void ManifoldApplyImpulseSoft(
+        ContactManifold::Key key,
+        ContactManifold& manifold,
+        const ContactSoftness& softness,
+        const ContactSoftness& staticSoftness, // With a static or sleeping body.
+        f32 inverseSubStep,
+        bool useBias
+    ) const;
     void ManifoldUpdate(
         ContactManifold& manifold,
         const ContactManifold& newManifold,
@@ -189,11 +364,41 @@ private:
     ) const;
 
     int ManifoldFind(ContactManifold::Key key) const;
+    void ManifoldsAlloc(int capacity);
     void ManifoldInsert(ContactManifold::Key key, const ContactManifold& manifold);
-    void ManifoldErase(ContactManifold::Key key);
+    void ManifoldRemoveAt(int index); // The last manifold moves to index.
+    void SatCachesAlloc(int capacity);
+    void SatCacheStore(ContactManifold::Key key, const SatCache& cache);
+    // Union-find over the touching dynamic bodies, returns the island root of every body
+    // (in gArenaFrame) and wakes up the whole island if one of its bodies is awake.
+    int* BuildIslands(const int* manifoldsIndices, int manifoldsCount);
+    // Islands at rest for long enough fall asleep together.
+    void UpdateSleeping(const int* islands);
+    bool IsBulletFast(const Body& body, const SolverBody& solverBody, f32 timeStep) const;
+    // Moves the fast bullets back to their first time of impact, bodies are integrated already
+    // and the other dynamic bodies moved by at most maxDisplacement during the step.
+    void SolveContinuous(
+        const Body::Id* bulletIds,
+        const Sweep* sweeps,
+        int bulletsCount,
+        f32 maxDisplacement
+    );
     void BroadPhase();
-    void NarrowPhase(const HGrid::Object* obj1, const HGrid::Object* obj2);
+    void PairAdd(Body::Id bodyId1, Body::Id bodyId2);
+    // Collides the pairs in parallel, then inserts, updates or erases their manifolds in order.
+    void NarrowPhase();
+    Aabb BodyComputeAabb(const Body& body) const;
 
+    void BroadPhaseAlloc(int objectsCapacity);
     void BroadPhaseAdd(HGrid& hgrid, HGrid::Object* obj);
+    void BroadPhaseRemove(HGrid& hgrid, HGrid::Object* obj);
     void BroadPhaseCheck(HGrid& hgrid, const HGrid::Object* obj);
+    void BroadPhaseHGrid();
+    void BroadPhaseTree();
+    void BroadPhaseSap();
+    void BroadPhaseStatic();
+    // callback(bodyId) for the dynamic bodies whose broad-phase bounds overlap aabb, the bounds
+    // are from the start of the step.
+    template <typename F>
+    void BroadPhaseQuery(const Aabb& aabb, const F& callback);
 };
@@ -48,4 +48,35 @@ TEST("Arena")
     TEST_ASSERT(!res);
 }
 
+TEST("Arena realloc")
+{
+    Arena arena;
+    int cmp[] = {1337, -1, 282, 222};
+
+    arena.Init(128);
+    DEFER(arena.FreeBuffer());
+
+    // Last allocation grows in place.
+    int* res = arena.AllocOrDie<int>(2);
+    res[0] = cmp[0];
+    res[1] = cmp[1];
+    int* grown = arena.ReallocOrDie(res, 2, 4);
+    TEST_ASSERT(grown == res);
+    TEST_ASSERT(grown[2] == 0 && grown[3] == 0);
+    grown[2] = cmp[2];
+    grown[3] = cmp[3];
+    TEST_ASSERT(!memcmp(grown, cmp, sizeof(cmp)));
+    TEST_ASSERT(arena.mCurrentOffset == sizeof(cmp));
+
+    // Otherwise it's copied.
+    const int* const other = arena.AllocOrDie<int>(1);
+    TEST_ASSERT(other);
+    res = arena.ReallocOrDie(grown, 4, 8);
+    TEST_ASSERT(res != grown);
+    TEST_ASSERT(!memcmp(res, cmp, sizeof(cmp)));
+    TEST_ASSERT(res[7] == 0);
+
+    TEST_ASSERT(!arena.Realloc(res, sizeof(int) * 8, arena.mBufferSize + 1, alignof(int)));
+}
+
 #endif
@@ -1,6 +1,7 @@
 #if defined(TEST_HEADERS)
 
 #include "Math/Math.hpp"
+#include "Math/FloatW.hpp"
 
 #elif defined(TEST_SOURCE)
 
@@ -545,4 +546,41 @@ TEST("Model matrix")
     TEST_ASSERT(AlmostEqual(model, Model(position, orientation, 2.0f)));
 }
 
+TEST("Wide floats")
+{
+    alignas(FloatW) f32 src[FLOAT_W_WIDTH];
+    alignas(FloatW) f32 dst[FLOAT_W_WIDTH];
+    for (int i = 0; i < FLOAT_W_WIDTH; ++i)
+    {
+        src[i] = static_cast<f32>(i) - 2.0f;
+    }
+
+    const FloatW x = LoadW(src);
+    StoreW(dst, Clamp(x * SplatW(2.0f) + SplatW(1.0f), SplatW(-1.0f), SplatW(3.0f)));
+    for (int i = 0; i < FLOAT_W_WIDTH; ++i)
+    {
+        TEST_ASSERT(dst[i] == Clamp(src[i] * 2.0f + 1.0f, -1.0f, 3.0f));
+        TEST_ASSERT(GetLaneW(x, i) == src[i]);
+    }
+
+    FloatW y = SafeReciprocal(x);
+    SetLaneW(y, 0, 42.0f);
+    TEST_ASSERT(GetLaneW(y, 0) == 42.0f);
+    TEST_ASSERT(GetLaneW(y, 1) == -1.0f);
+    TEST_ASSERT(GetLaneW(y, 2) == 0.0f); // 1 / 0
+    TEST_ASSERT(GetLaneW(y, 3) == 1.0f);
+
+    // Lanes -2, -1, 0 are <= 0 and -1, 0, 1, ... are >= -1.
+    const FloatW mask = AndW(LessEqualW(x, ZeroW()), LessEqualW(SplatW(-1.0f), x));
+    TEST_ASSERT(MoveMaskW(mask) == 0b110);
+    TEST_ASSERT(MoveMaskW(LessEqualW(LoadUnalignedW(src), x)) == (1 << FLOAT_W_WIDTH) - 1);
+
+    // Strict, lanes -2, -1 only.
+    const FloatW negative = LessW(x, ZeroW());
+    TEST_ASSERT(MoveMaskW(negative) == 0b11);
+    StoreW(dst, SelectW(negative, -x, SqrtW(x)));
+    TEST_ASSERT(dst[0] == 2.0f && dst[1] == 1.0f && dst[2] == 0.0f && dst[3] == 1.0f);
+    TEST_ASSERT(GetBlocksCountW(FLOAT_W_WIDTH + 1) == 2);
+}
+
 #endif
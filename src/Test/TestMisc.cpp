@@ -1,6 +1,7 @@
 #if defined(TEST_HEADERS)
 
 #include "PackUtils.hpp"
+#include "ThreadPool.hpp"
 
 #elif defined(TEST_SOURCE)
 
@@ -18,4 +19,78 @@ TEST("Pack 3 bytes to f32, unpack f32 to Vec3")
     TEST_ASSERT(AlmostEqual(UnpackToVec3(PackToF32(255, 255, 255)), {1.0f, 1.0f, 1.0f}, tolerance));
 }
 
+TEST("Thread pool")
+{
+    ThreadPool pool;
+    pool.Init(4);
+    DEFER(pool.Shutdown());
+    TEST_ASSERT(pool.GetThreadsCount() == 4);
+
+    constexpr int COUNT = 10'000;
+    static std::atomic<int> sVisits[COUNT];
+    for (int job = 0; job < 50; ++job)
+    {
+        for (int i = 0; i < COUNT; ++i)
+        {
+            sVisits[i].store(0);
+        }
+        std::atomic<int> threadsMask{0};
+        pool.ParallelFor(
+            COUNT - job,
+            16,
+            [&](int begin, int end, int threadIndex)
+            {
+                threadsMask.fetch_or(1 << threadIndex);
+                for (int i = begin; i < end; ++i)
+                {
+                    sVisits[i].fetch_add(1);
+                }
+            }
+        );
+        bool visitedOnce = true;
+        for (int i = 0; i < COUNT; ++i)
+        {
+            visitedOnce = visitedOnce && sVisits[i].load() == (i < COUNT - job ? 1 : 0);
+        }
+        TEST_ASSERT(visitedOnce);
+        TEST_ASSERT(threadsMask.load() > 0 && threadsMask.load() < 16);
+    }
+
+    // Back to back jobs growing and shrinking, a late worker must not run a chunk of the next
+    // job.
+    for (int i = 0; i < COUNT; ++i)
+    {
+        sVisits[i].store(0);
+    }
+    u32 random = 1337;
+    for (int job = 0; job < 5000; ++job)
+    {
+        random = LfsrNext(random);
+        const int count = 1 + static_cast<int>(random % COUNT);
+        pool.ParallelFor(
+            count,
+            1,
+            [&](int begin, int end, int)
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    sVisits[i].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        );
+        bool visitedOnce = true;
+        for (int i = 0; i < COUNT; ++i)
+        {
+            const int visits = sVisits[i].exchange(0, std::memory_order_relaxed);
+            visitedOnce = visitedOnce && visits == (i < count ? 1 : 0);
+        }
+        TEST_ASSERT(visitedOnce);
+    }
+
+    // Too small to be split, runs on the caller.
+    int threadIndexSmall = -1;
+    pool.ParallelFor(8, 16, [&](int, int, int threadIndex) { threadIndexSmall = threadIndex; });
+    TEST_ASSERT(threadIndexSmall == 0);
+}
+
 #endif
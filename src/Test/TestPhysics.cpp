@@ -2,7 +2,15 @@
 
 #include "../Renderer/Meshes.hpp"
 #include "../Physics/MassProperties.hpp"
+#include "../Physics/World.hpp"
+#include "../Physics/Collide.hpp"
+#include "../Physics/DynamicTree.hpp"
+#include "../Physics/PairSet.hpp"
+#include "../Physics/SweepAndPrune.hpp"
+#include "../Math/FloatW8.hpp"
 #include "../Arena.hpp"
+#include "../Utils.hpp"
+#include "../ThreadPool.hpp"
 
 #elif defined(TEST_SOURCE)
 
@@ -106,6 +114,1411 @@ TEST("Mass properties of shapes")
     TEST_ASSERT(AlmostEqual(inverseMassRes, inverseMassCmp));
     TEST_ASSERT(AlmostEqual(inverseInertiaRes, inverseInertiaCmp));
     TEST_ASSERT(AlmostEqual(centerOfMass, Vec3{0.0f}));
+
+    // The unit density polyhedron scaled afterwards.
+    const MassProperties::Polyhedron polyhedron = MassProperties::CalculatePolyhedron(
+        positions.mData,
+        indices.mData,
+        indices.mCount,
+        Vec3{1.0f}
+    );
+    TEST_ASSERT(AlmostEqual(polyhedron.mVolume, 1.0f));
+    TEST_ASSERT(AlmostEqual(polyhedron.mCenterOfMass, Vec3{0.0f}));
+    MassProperties::CalculateScaledPolyhedron(
+        polyhedron,
+        density,
+        size,
+        inverseInertiaRes,
+        inverseMassRes
+    );
+    TEST_ASSERT(AlmostEqual(inverseMassRes, inverseMassCmp));
+    TEST_ASSERT(AlmostEqual(inverseInertiaRes, inverseInertiaCmp));
+}
+
+TEST("World grows past initial capacities")
+{
+    gArenaReset.Init(64'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mGravity = {0.0f, -9.81f, 0.0f};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    desc.mBodiesCapacity = 2;
+    desc.mConvexHullsCapacity = 1;
+    desc.mContactManifoldsCapacity = 2;
+    world.Init(desc);
+
+    ConvexHull floorHull{};
+    floorHull.InitBox({50.0f, 1.0f, 50.0f});
+    ConvexHull boxHull{};
+    boxHull.InitBox(Vec3{1.0f});
+    const ConvexHull::Id floorHullId = world.AddConvexHull(floorHull);
+    const ConvexHull::Id boxHullId = world.AddConvexHull(boxHull);
+    TEST_ASSERT(boxHullId == 1);
+
+    Body bodyDef{};
+    world.BodyInitConvexHull(bodyDef, FLT_MAX, floorHullId);
+    bodyDef.mPosition.Y() = -0.5f;
+    TEST_ASSERT(world.IsBodyIdValid(world.AddBody(bodyDef)));
+
+    constexpr int BOXES_COUNT = 100;
+    world.BodyInitConvexHull(bodyDef, 1000.0f, boxHullId);
+    Body::Id lastId = -1;
+    for (int i = 0; i < BOXES_COUNT; ++i)
+    {
+        bodyDef.mPosition
+            = {static_cast<f32>(i % 10) * 1.5f, 0.49f, static_cast<f32>(i / 10) * 1.5f};
+        lastId = world.AddBody(bodyDef);
+        TEST_ASSERT(world.IsBodyIdValid(lastId));
+    }
+    TEST_ASSERT(world.GetBodiesCount() == BOXES_COUNT + 1);
+    TEST_ASSERT(AlmostEqual(world.GetPosition(lastId), bodyDef.mPosition));
+
+    // A row more in one call.
+    constexpr int ROW_COUNT = 10;
+    Vec3 rowPositions[ROW_COUNT];
+    for (int i = 0; i < ROW_COUNT; ++i)
+    {
+        rowPositions[i] = {static_cast<f32>(i) * 1.5f, 0.49f, 20.0f};
+    }
+    const Body::Id rowId = world.AddBodies(bodyDef, rowPositions, ROW_COUNT);
+    TEST_ASSERT(rowId == lastId + 1);
+    TEST_ASSERT(world.GetBodiesCount() == BOXES_COUNT + ROW_COUNT + 1);
+    for (int i = 0; i < ROW_COUNT; ++i)
+    {
+        TEST_ASSERT(AlmostEqual(world.GetPosition(rowId + i), rowPositions[i]));
+    }
+
+    gArenaFrame.FreeAll();
+    world.Step();
+
+    // Every box rests on the floor.
+    TEST_ASSERT(world.GetContactManifoldsCount() >= BOXES_COUNT + ROW_COUNT);
+    TEST_ASSERT(world.GetContactManifoldsCapacity() > 2);
+}
+
+TEST("Dynamic AABB tree queries match brute force")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    constexpr int PROXIES_COUNT = 300;
+    DynamicTree tree{};
+    tree.Init(4); // Grows.
+    Aabb aabbs[PROXIES_COUNT];
+    int proxies[PROXIES_COUNT];
+    u32 random = 1;
+    const auto randomAabb = [&]
+    {
+        const Vec3 center{
+            LfsrNextGetFloat(random, 20.0f),
+            LfsrNextGetFloat(random, 20.0f),
+            LfsrNextGetFloat(random, 20.0f),
+        };
+        const Vec3 halfExtents{
+            0.1f + LfsrNextGetFloatAbs(random, 1.0f),
+            0.1f + LfsrNextGetFloatAbs(random, 1.0f),
+            0.1f + LfsrNextGetFloatAbs(random, 3.0f),
+        };
+        return Aabb{center - halfExtents, center + halfExtents};
+    };
+    for (int i = 0; i < PROXIES_COUNT; ++i)
+    {
+        aabbs[i] = randomAabb();
+        proxies[i] = tree.CreateProxy(aabbs[i], i);
+    }
+    // Moves, including a few reinsertions and a removal.
+    for (int i = 0; i < PROXIES_COUNT; i += 3)
+    {
+        aabbs[i] = randomAabb();
+        tree.MoveProxy(proxies[i], aabbs[i]);
+    }
+    tree.DestroyProxy(proxies[0]);
+    TEST_ASSERT(tree.GetHeight() < 20);
+
+    for (int i = 1; i < PROXIES_COUNT; ++i)
+    {
+        const Aabb& query = tree.GetFatAabb(proxies[i]);
+        TEST_ASSERT(Contains(query, aabbs[i]));
+        int found = 0;
+        tree.Query(
+            query,
+            [&](int proxyId)
+            {
+                TEST_ASSERT(Overlap(tree.GetFatAabb(proxyId), query));
+                ++found;
+                return true;
+            }
+        );
+        int expected = 0;
+        for (int j = 1; j < PROXIES_COUNT; ++j)
+        {
+            expected += Overlap(tree.GetFatAabb(proxies[j]), query);
+        }
+        TEST_ASSERT(found == expected);
+    }
+}
+
+TEST("Sweep and prune pairs match brute force")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    constexpr int BOXES_COUNT = 300;
+    SweepAndPrune sap{};
+    sap.Init(4); // Grows.
+    u32 random = 1;
+    const auto randomAabb = [&](f32 spreadX)
+    {
+        const Vec3 center{
+            LfsrNextGetFloat(random, spreadX),
+            LfsrNextGetFloat(random, 10.0f),
+            LfsrNextGetFloat(random, 10.0f),
+        };
+        const Vec3 halfExtents{0.1f + LfsrNextGetFloatAbs(random, 1.0f)};
+        return Aabb{center - halfExtents, center + halfExtents};
+    };
+    for (int i = 0; i < BOXES_COUNT; ++i)
+    {
+        sap.Add(i, randomAabb(2.0f));
+    }
+
+    // Flat along X first, stretched along X then, so the axis switches.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+        {
+            for (int i = 0; i < BOXES_COUNT; ++i)
+            {
+                sap.mAabbs[i] = randomAabb(100.0f);
+            }
+        }
+        sap.Update(gArenaReset);
+        for (int i = 1; i < BOXES_COUNT; ++i)
+        {
+            const f32 min = sap.mAabbs[sap.mOrder[i]].mMin[sap.mAxis];
+            TEST_ASSERT(sap.mAabbs[sap.mOrder[i - 1]].mMin[sap.mAxis] <= min);
+        }
+
+        u64* pairs = nullptr;
+        const int pairsCount = sap.FindPairs(gArenaReset, &pairs);
+        for (int i = 0; i < pairsCount; ++i)
+        {
+            const ContactManifold::Key key = Utils::BitCast<ContactManifold::Key>(pairs[i]);
+            TEST_ASSERT(key.mBodyId1 < key.mBodyId2);
+            TEST_ASSERT(Overlap(sap.mAabbs[key.mBodyId1], sap.mAabbs[key.mBodyId2]));
+        }
+        int expected = 0;
+        for (int i = 0; i < BOXES_COUNT; ++i)
+        {
+            for (int j = i + 1; j < BOXES_COUNT; ++j)
+            {
+                expected += Overlap(sap.mAabbs[i], sap.mAabbs[j]);
+            }
+        }
+        TEST_ASSERT(pairsCount == expected);
+        TEST_ASSERT((sap.mAxis == 0) == (pass == 1));
+
+        for (int i = 0; i < 20; ++i)
+        {
+            const Aabb aabb = randomAabb(pass == 0 ? 2.0f : 100.0f);
+            int queryCount = 0;
+            sap.Query(
+                aabb,
+                [&](int id)
+                {
+                    TEST_ASSERT(Overlap(sap.mAabbs[id], aabb));
+                    ++queryCount;
+                }
+            );
+            int queryExpected = 0;
+            for (int j = 0; j < BOXES_COUNT; ++j)
+            {
+                queryExpected += Overlap(sap.mAabbs[j], aabb);
+            }
+            TEST_ASSERT(queryCount == queryExpected);
+        }
+    }
+}
+
+TEST("Pair set add, find and remove")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    PairSet set{};
+    set.Init(2); // Grows.
+    constexpr u64 PAIRS_COUNT = 1000;
+    for (u64 i = 0; i < PAIRS_COUNT; ++i)
+    {
+        TEST_ASSERT(set.Add(i * 7919));
+    }
+    TEST_ASSERT(!set.Add(7919));
+    TEST_ASSERT(set.mCount == PAIRS_COUNT);
+
+    // Remove the odd ones, the rest must still be found.
+    for (u64 i = 1; i < PAIRS_COUNT; i += 2)
+    {
+        set.RemoveAt(set.Find(i * 7919));
+    }
+    TEST_ASSERT(set.mCount == PAIRS_COUNT / 2);
+    for (u64 i = 0; i < PAIRS_COUNT; ++i)
+    {
+        const int index = set.Find(i * 7919);
+        TEST_ASSERT((i % 2 == 0) == (index != -1));
+        TEST_ASSERT(index == -1 || set.mPairs[index] == i * 7919);
+    }
+}
+
+TEST("Hull hill climbing finds the support point")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    ConvexHull hulls[2]{};
+    hulls[0].InitBox({1.0f, 2.0f, 3.0f});
+    hulls[1].InitTetrahedron(Vec3{1.0f});
+
+    u32 random = 1337;
+    for (const ConvexHull& hull : hulls)
+    {
+        TEST_ASSERT(hull.CheckConsistency() == ConvexHull::ConsistencyResult::Ok);
+        for (int i = 0; i < 100; ++i)
+        {
+            const Vec3 direction = {
+                LfsrNextGetFloat(random, 1.0f),
+                LfsrNextGetFloat(random, 1.0f),
+                LfsrNextGetFloat(random, 1.0f),
+            };
+            const int supportIndex
+                = GetSupportPointIndex(hull.mVertexPositions, hull.mVerticesCount, direction);
+            const f32 maxProjection = Dot(direction, hull.mVertexPositions[supportIndex]);
+            // The wide scan picks the same first vertex, the padding lanes don't count.
+            TEST_ASSERT(
+                GetSupportPointIndex(hull.mVertexPositionsW, hull.mVerticesCount, direction)
+                == supportIndex
+            );
+            // Ties are fine, any start gets to a vertex as far along the direction.
+            for (int start = 0; start < hull.mVerticesCount; ++start)
+            {
+                const int index = hull.HillClimbSupportPointIndex(direction, start);
+                TEST_ASSERT(Dot(direction, hull.mVertexPositions[index]) == maxProjection);
+            }
+        }
+    }
+}
+
+#if defined(FLOAT_W_DISPATCH_AVX2)
+TEST("AVX2 hull kernels match the FloatW ones")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    DEFER(InitCollideKernels(IsAvx2Supported()));
+
+    World world{};
+    WorldDesc desc{};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    u32 random = 1337;
+    const auto getRandomVec3 = [&random]()
+    {
+        return Vec3{
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f) + 0.01f,
+        };
+    };
+    const auto getRandomQuat = [&]()
+    {
+        return Normalize(
+            Quat::FromAxis(LfsrNextGetFloat(random, M_PIf), Normalize(getRandomVec3()))
+        );
+    };
+
+    // Point clouds have an edge direction per edge, so they go through the edge pairs. Their
+    // FloatW block counts of vertices, faces and edges are odd and even, all under the hill
+    // climbing limit.
+    ConvexHull hulls[3]{};
+    hulls[0].InitBox(Vec3{1.0f});
+    const int pointsCounts[] = {12, 8};
+    for (int i = 0; i < ARRAY_SSIZE(pointsCounts); ++i)
+    {
+        Vec3 points[12]{};
+        for (int j = 0; j < pointsCounts[i]; ++j)
+        {
+            points[j] = getRandomVec3();
+        }
+        hulls[i + 1].InitFromPoints(points, pointsCounts[i], gArenaReset);
+    }
+    ConvexHull::Id hullIds[ARRAY_SSIZE(hulls)]{};
+    for (int i = 0; i < ARRAY_SSIZE(hulls); ++i)
+    {
+        TEST_ASSERT(hulls[i].CheckConsistency() == ConvexHull::ConsistencyResult::Ok);
+        hullIds[i] = world.AddConvexHull(hulls[i]);
+    }
+
+    // Nothing to compare on CPUs without AVX2.
+    const bool isAvx2Supported = IsAvx2Supported();
+    for (int i = 0; isAvx2Supported && i < 400; ++i)
+    {
+        const ConvexHull& hull = hulls[i % 3];
+        const Vec3 direction = getRandomVec3();
+        InitCollideKernels(false);
+        const int index
+            = GetSupportPointIndex(hull.mVertexPositionsW, hull.mVerticesCount, direction);
+        InitCollideKernels(true);
+        TEST_ASSERT(
+            GetSupportPointIndex(hull.mVertexPositionsW, hull.mVerticesCount, direction) == index
+        );
+
+        Body body1{};
+        world.BodyInitConvexHull(body1, 1000.0f, hullIds[i % 3], {1.0f, 0.5f, 2.0f});
+        body1.mOrientation = getRandomQuat();
+        Body body2{};
+        world.BodyInitConvexHull(body2, 1000.0f, hullIds[(i / 3) % 3], {0.5f, 1.5f, 1.0f});
+        body2.mOrientation = getRandomQuat();
+        // Deep enough for the face queries to overlap, so the edges are queried too.
+        body2.mPosition
+            = Normalize(getRandomVec3()) * (0.4f * (body1.mRadius + body2.mRadius));
+
+        SatCache caches[2]{};
+        ContactManifold manifolds[2]{};
+        for (int isAvx2 = 0; isAvx2 < 2; ++isAvx2)
+        {
+            InitCollideKernels(isAvx2);
+            Collide(manifolds[isAvx2], caches[isAvx2], world, body1, body2, gArenaReset);
+        }
+        TEST_ASSERT(caches[0].mType == caches[1].mType);
+        TEST_ASSERT(caches[0].mIndex1 == caches[1].mIndex1);
+        TEST_ASSERT(caches[0].mIndex2 == caches[1].mIndex2);
+        TEST_ASSERT(caches[0].mSeparation == caches[1].mSeparation);
+        TEST_ASSERT(manifolds[0].mContactsCount == manifolds[1].mContactsCount);
+        for (int j = 0; j < manifolds[0].mContactsCount; ++j)
+        {
+            const ContactPoint& a = manifolds[0].mContacts[j];
+            const ContactPoint& b = manifolds[1].mContacts[j];
+            TEST_ASSERT(memcmp(&a.mPosition, &b.mPosition, sizeof(Vec3)) == 0);
+            TEST_ASSERT(a.mSeparation == b.mSeparation);
+        }
+    }
+}
+#endif
+
+TEST("Quickhull builds hulls from points")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    u32 random = 1337;
+    Vec3 points[512]{};
+
+    // Box corners off the origin with points inside and on the faces.
+    const Vec3 halfExtents = {0.5f, 1.0f, 1.5f};
+    const Vec3 offset = {5.0f, -2.0f, 1.0f};
+    for (int i = 0; i < 8; ++i)
+    {
+        const Vec3 signs = {i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f};
+        points[i] = offset + signs * halfExtents;
+    }
+    for (int i = 8; i < 200; ++i)
+    {
+        Vec3 point = {
+            LfsrNextGetFloat(random, halfExtents.X()),
+            LfsrNextGetFloat(random, halfExtents.Y()),
+            LfsrNextGetFloat(random, halfExtents.Z()),
+        };
+        const int axis = i % 4;
+        if (axis < 3)
+        {
+            point[axis] = i & 4 ? halfExtents[axis] : -halfExtents[axis];
+        }
+        points[i] = offset + point;
+    }
+    ConvexHull box{};
+    box.InitFromPoints(points, 200, gArenaReset);
+    TEST_ASSERT(box.mVerticesCount == 8);
+    TEST_ASSERT(box.mHalfEdgesCount == 24);
+    TEST_ASSERT(box.mFacesCount == 6);
+    TEST_ASSERT(box.mEdgeDirectionsCount == 3);
+    for (int i = 0; i < box.mEdgeDirectionsCount; ++i)
+    {
+        TEST_ASSERT(box.mEdgeDirections[i].mEdgesCount == 4);
+    }
+    TEST_ASSERT(AlmostEqual(box.mRadius, Magnitude(halfExtents), 0.0001f));
+    for (int i = 0; i < box.mFacesCount; ++i)
+    {
+        const Plane plane = box.mFacePlanes[i];
+        TEST_ASSERT(AlmostEqual(plane.mOffset, Dot(Abs(plane.mNormal), halfExtents), 0.0001f));
+    }
+
+    Mat3 inverseInertia{};
+    Vec3 centerOfMass{};
+    f32 inverseMass{};
+    MassProperties::CalculatePolyhedronTriangleMesh(
+        box.mMeshPositions.mData,
+        box.mMeshIndices.mData,
+        box.mMeshIndices.mCount,
+        1.0f,
+        box.mScale,
+        inverseInertia,
+        centerOfMass,
+        inverseMass
+    );
+    TEST_ASSERT(AlmostEqual(centerOfMass, box.mCentroid, 0.0001f));
+    TEST_ASSERT(AlmostEqual(inverseMass, 1.0f / 6.0f, 0.0001f));
+
+    // 16-sided prism with more points on the caps, merged into 18 faces.
+    constexpr int SIDES = 16;
+    int pointsCount = 0;
+    for (int i = 0; i < SIDES; ++i)
+    {
+        const f32 angle = 2.0f * M_PIf * static_cast<f32>(i) / SIDES;
+        points[pointsCount++] = {cosf(angle), -0.5f, sinf(angle)};
+        points[pointsCount++] = {cosf(angle), 0.5f, sinf(angle)};
+        points[pointsCount++] = {0.5f * cosf(angle), 0.5f, 0.5f * sinf(angle)};
+    }
+    ConvexHull prism{};
+    prism.InitFromPoints(points, pointsCount, gArenaReset);
+    TEST_ASSERT(prism.mVerticesCount == 2 * SIDES);
+    TEST_ASSERT(prism.mHalfEdgesCount == 2 * 3 * SIDES);
+    TEST_ASSERT(prism.mFacesCount == SIDES + 2);
+    // The sides and the pairs of opposite edges of both caps.
+    TEST_ASSERT(prism.mEdgeDirectionsCount == 1 + SIDES / 2);
+
+    // The cap keeps the farthest points of a sphere.
+    for (Vec3& point : points)
+    {
+        point = Normalize({
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f),
+        });
+    }
+    ConvexHull sphere{};
+    sphere.InitFromPoints(points, ARRAY_SSIZE(points), gArenaReset, 0.0f, 20);
+    TEST_ASSERT(sphere.mVerticesCount <= 20);
+    TEST_ASSERT(sphere.CheckConsistency() == ConvexHull::ConsistencyResult::Ok);
+}
+
+TEST("Packed hulls keep their data in one block")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    ConvexHull hull{};
+    hull.InitTetrahedron(Vec3{1.0f});
+    ConvexHull packed = hull;
+    packed.Pack(gArenaReset);
+    TEST_ASSERT(packed.CheckConsistency() == ConvexHull::ConsistencyResult::Ok);
+
+    // Back-to-back from the first array to the end of the last one.
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(packed.mFacePlanesW);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(packed.mVertices + packed.mVerticesCount);
+    TEST_ASSERT(begin % 64 == 0);
+    const void* const arrays[] = {
+        packed.mFacePlanes,
+        packed.mVertexPositionsW,
+        packed.mVertexPositions,
+        packed.mHalfEdges8,
+        packed.mEdgesW,
+        packed.mFaces,
+    };
+    for (const void* const array : arrays)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(array);
+        TEST_ASSERT(address > begin && address < end);
+    }
+    TEST_ASSERT(end - begin < 2048);
+
+    for (int i = 0; i < hull.mVerticesCount; ++i)
+    {
+        TEST_ASSERT(packed.mVertexPositions[i] == hull.mVertexPositions[i]);
+    }
+    for (int i = 0; i < hull.mHalfEdgesCount; ++i)
+    {
+        const ConvexHull::HalfEdge a = packed.GetHalfEdge(i);
+        const ConvexHull::HalfEdge b = hull.GetHalfEdge(i);
+        TEST_ASSERT(a.mNext == b.mNext && a.mTwin == b.mTwin);
+        TEST_ASSERT(a.mOrigin == b.mOrigin && a.mFace == b.mFace);
+    }
+}
+
+TEST("Edge directions find the separating edge axis")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    // Both are zonotopes, every cross product of their edges is a face of the Minkowski
+    // difference, so the largest gap over all of them is the edge x edge SAT separation.
+    constexpr int SIDES = 16;
+    Vec3 points[2 * SIDES]{};
+    for (int i = 0; i < SIDES; ++i)
+    {
+        const f32 angle = 2.0f * M_PIf * static_cast<f32>(i) / SIDES;
+        points[2 * i] = {cosf(angle), -0.5f, sinf(angle)};
+        points[2 * i + 1] = {cosf(angle), 0.5f, sinf(angle)};
+    }
+    ConvexHull prismHull{};
+    prismHull.InitFromPoints(points, ARRAY_SSIZE(points), gArenaReset);
+    ConvexHull boxHull{};
+    boxHull.InitBox(Vec3{1.0f});
+    const ConvexHull::Id hullIds[] = {
+        world.AddConvexHull(boxHull),
+        world.AddConvexHull(prismHull),
+    };
+    const Slice<ConvexHull> hulls = world.GetConvexHulls();
+
+    const auto getVertices = [&](const Body& body, Vec3* vertices)
+    {
+        const ConvexHull& hull = hulls.mData[body.mConvexHull.mId];
+        const TransformMat transform{ToMat3(body.mOrientation), body.mPosition};
+        for (int i = 0; i < hull.mVerticesCount; ++i)
+        {
+            vertices[i] = Transform(transform, hull.mVertexPositions[i] * body.mConvexHull.mScale);
+        }
+        return hull.mVerticesCount;
+    };
+
+    u32 random = 1337;
+    const auto getRandomQuat = [&random]()
+    {
+        const Vec3 axis = {
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f) + 0.01f,
+        };
+        return Normalize(Quat::FromAxis(LfsrNextGetFloat(random, M_PIf), Normalize(axis)));
+    };
+
+    int edgeSeparationsCount = 0;
+    for (int i = 0; i < 400; ++i)
+    {
+        Body body1{};
+        world.BodyInitConvexHull(body1, 1000.0f, hullIds[0], {1.0f, 0.5f, 2.0f});
+        body1.mOrientation = getRandomQuat();
+        Body body2{};
+        world.BodyInitConvexHull(body2, 1000.0f, hullIds[i % 2], {0.5f, 1.5f, 1.0f});
+        body2.mOrientation = getRandomQuat();
+        const Vec3 direction = Normalize({
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f) + 0.01f,
+        });
+        body2.mPosition = direction * (0.8f * (body1.mRadius + body2.mRadius));
+
+        SatCache cache{};
+        ContactManifold manifold{};
+        Collide(manifold, cache, world, body1, body2, gArenaReset);
+        if (cache.mType != SatCache::Edges || cache.mSeparation <= 0.0f)
+        {
+            continue;
+        }
+        ++edgeSeparationsCount;
+
+        Vec3 vertices1[2 * SIDES]{};
+        Vec3 vertices2[2 * SIDES]{};
+        const int verticesCount1 = getVertices(body1, vertices1);
+        const int verticesCount2 = getVertices(body2, vertices2);
+        const ConvexHull& hull1 = hulls.mData[body1.mConvexHull.mId];
+        const ConvexHull& hull2 = hulls.mData[body2.mConvexHull.mId];
+        f32 maxGap = -FLT_MAX;
+        for (int edge1 = 0; edge1 < hull1.mHalfEdgesCount; edge1 += 2)
+        {
+            const int origin1 = hull1.GetHalfEdge(edge1).mOrigin;
+            const int target1 = hull1.GetHalfEdge(edge1 + 1).mOrigin;
+            const Vec3 e1 = vertices1[target1] - vertices1[origin1];
+            for (int edge2 = 0; edge2 < hull2.mHalfEdgesCount; edge2 += 2)
+            {
+                const int origin2 = hull2.GetHalfEdge(edge2).mOrigin;
+                const int target2 = hull2.GetHalfEdge(edge2 + 1).mOrigin;
+                const Vec3 axis = Cross(e1, vertices2[target2] - vertices2[origin2]);
+                if (MagnitudeSq(axis) < 1e-6f)
+                {
+                    continue;
+                }
+                const Vec3 n = Normalize(axis);
+                f32 min1 = FLT_MAX;
+                f32 max1 = -FLT_MAX;
+                for (int j = 0; j < verticesCount1; ++j)
+                {
+                    min1 = Min(min1, Dot(n, vertices1[j]));
+                    max1 = Max(max1, Dot(n, vertices1[j]));
+                }
+                f32 min2 = FLT_MAX;
+                f32 max2 = -FLT_MAX;
+                for (int j = 0; j < verticesCount2; ++j)
+                {
+                    min2 = Min(min2, Dot(n, vertices2[j]));
+                    max2 = Max(max2, Dot(n, vertices2[j]));
+                }
+                maxGap = Max(maxGap, Max(min2 - max1, min1 - max2));
+            }
+        }
+        TEST_ASSERT(AlmostEqual(cache.mSeparation, maxGap, 0.0001f));
+    }
+    TEST_ASSERT(edgeSeparationsCount > 20);
+}
+
+TEST("Hull collision reuses the cached SAT axis")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    ConvexHull boxHull{};
+    boxHull.InitBox(Vec3{1.0f});
+    const ConvexHull::Id boxHullId = world.AddConvexHull(boxHull);
+    Body box1{};
+    world.BodyInitConvexHull(box1, 1000.0f, boxHullId);
+    Body box2 = box1;
+    box2.mPosition = {0.2f, 0.99f, 0.1f};
+
+    SatCache cache{};
+    ContactManifold manifold{};
+    Collide(manifold, cache, world, box1, box2, gArenaReset);
+    TEST_ASSERT(manifold.mContactsCount == 4);
+    TEST_ASSERT(cache.mType == SatCache::Face1 || cache.mType == SatCache::Face2);
+    TEST_ASSERT(AlmostEqual(cache.mSeparation, -0.01f, 0.001f));
+
+    // A small motion reuses the axis, the contacts are the same as from the full SAT.
+    box2.mPosition.Y() -= 0.002f;
+    SatCache cached = cache;
+    ContactManifold manifoldCached{};
+    Collide(manifoldCached, cached, world, box1, box2, gArenaReset);
+    SatCache empty{};
+    ContactManifold manifoldFull{};
+    Collide(manifoldFull, empty, world, box1, box2, gArenaReset);
+    TEST_ASSERT(manifoldCached.mContactsCount == manifoldFull.mContactsCount);
+    TEST_ASSERT(AlmostEqual(manifoldCached.mNormal, manifoldFull.mNormal));
+    for (int i = 0; i < manifoldFull.mContactsCount; ++i)
+    {
+        const ContactPoint& a = manifoldCached.mContacts[i];
+        const ContactPoint& b = manifoldFull.mContacts[i];
+        TEST_ASSERT(AlmostEqual(a.mPosition, b.mPosition));
+        TEST_ASSERT(AlmostEqual(a.mSeparation, b.mSeparation));
+    }
+    // Only the full SAT refreshes the cached separation.
+    TEST_ASSERT(cached.mSeparation == cache.mSeparation);
+
+    // Separated, the separating axis is cached and exits early next time.
+    box2.mPosition = {0.5f, 1.5f, 0.0f};
+    Collide(manifold, cache, world, box1, box2, gArenaReset);
+    TEST_ASSERT(manifold.mContactsCount == 0);
+    TEST_ASSERT(cache.mSeparation > 0.0f);
+    cached = cache;
+    Collide(manifold, cached, world, box1, box2, gArenaReset);
+    TEST_ASSERT(manifold.mContactsCount == 0);
+
+    // The stale axis doesn't separate the bodies anymore, the full SAT finds the contact.
+    box2.mPosition = {0.2f, 0.99f, 0.1f};
+    Collide(manifold, cache, world, box1, box2, gArenaReset);
+    TEST_ASSERT(manifold.mContactsCount == 4);
+    TEST_ASSERT(cache.mSeparation < 0.0f);
+}
+
+TEST("Scaled bodies of a shared hull collide like baked hulls")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    const Vec3 scale = {2.0f, 0.5f, 1.0f};
+    ConvexHull unitHull{};
+    unitHull.InitBox(Vec3{1.0f});
+    ConvexHull bakedHull{};
+    bakedHull.InitBox(scale);
+    const ConvexHull::Id unitHullId = world.AddConvexHull(unitHull);
+    const ConvexHull::Id bakedHullId = world.AddConvexHull(bakedHull);
+
+    Body scaled{};
+    world.BodyInitConvexHull(scaled, 1000.0f, unitHullId, scale);
+    Body baked{};
+    world.BodyInitConvexHull(baked, 1000.0f, bakedHullId);
+    TEST_ASSERT(AlmostEqual(scaled.mInverseMass, baked.mInverseMass));
+    TEST_ASSERT(AlmostEqual(scaled.mRadius, baked.mRadius));
+    TEST_ASSERT(AlmostEqual(scaled.mInverseInertia, baked.mInverseInertia));
+
+    // A tilted plank on another one, and a sphere pushed into the side of it.
+    Body other{};
+    world.BodyInitConvexHull(other, 1000.0f, unitHullId, scale);
+    other.mPosition = {0.3f, 0.45f, 0.2f};
+    other.mOrientation = Normalize(Quat::FromAxis(Radians(20.0f), {0.3f, 1.0f, 0.1f}));
+    Body sphere{};
+    world.BodyInitSphere(sphere, 1000.0f, 0.25f);
+    sphere.mPosition = {1.2f, 0.0f, 0.1f};
+
+    const Body* const others[] = {&other, &sphere};
+    for (const Body* const body : others)
+    {
+        SatCache cacheScaled{};
+        ContactManifold manifoldScaled{};
+        Collide(manifoldScaled, cacheScaled, world, scaled, *body, gArenaReset);
+        SatCache cacheBaked{};
+        ContactManifold manifoldBaked{};
+        Collide(manifoldBaked, cacheBaked, world, baked, *body, gArenaReset);
+        TEST_ASSERT(manifoldScaled.mContactsCount > 0);
+        TEST_ASSERT(manifoldScaled.mContactsCount == manifoldBaked.mContactsCount);
+        TEST_ASSERT(AlmostEqual(manifoldScaled.mNormal, manifoldBaked.mNormal, 0.0001f));
+        for (int i = 0; i < manifoldBaked.mContactsCount; ++i)
+        {
+            const ContactPoint& a = manifoldScaled.mContacts[i];
+            const ContactPoint& b = manifoldBaked.mContacts[i];
+            TEST_ASSERT(AlmostEqual(a.mPosition, b.mPosition, 0.0001f));
+            TEST_ASSERT(AlmostEqual(a.mSeparation, b.mSeparation, 0.0001f));
+        }
+    }
+}
+
+TEST("Boxes collide like box hulls")
+{
+    gArenaReset.Init(1'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    ConvexHull unitHull{};
+    unitHull.InitBox(Vec3{1.0f});
+    const ConvexHull::Id unitHullId = world.AddConvexHull(unitHull);
+
+    const Vec3 halfExtents[] = {{0.5f, 0.25f, 1.0f}, {0.3f, 0.6f, 0.4f}};
+    Body boxes[2]{};
+    Body hulls[2]{};
+    for (int i = 0; i < 2; ++i)
+    {
+        world.BodyInitBox(boxes[i], 1000.0f, halfExtents[i]);
+        world.BodyInitConvexHull(hulls[i], 1000.0f, unitHullId, halfExtents[i] * 2.0f);
+        TEST_ASSERT(AlmostEqual(boxes[i].mInverseMass, hulls[i].mInverseMass));
+        TEST_ASSERT(AlmostEqual(boxes[i].mRadius, hulls[i].mRadius));
+        TEST_ASSERT(AlmostEqual(boxes[i].mInverseInertia, hulls[i].mInverseInertia, 0.0001f));
+    }
+    Body sphere{};
+    world.BodyInitSphere(sphere, 1000.0f, 0.3f);
+
+    const auto collideAndCompare
+        = [&](const Body& a1, const Body& a2, const Body& b1, const Body& b2)
+    {
+        SatCache cacheA{};
+        ContactManifold manifoldA{};
+        Collide(manifoldA, cacheA, world, a1, a2, gArenaReset);
+        SatCache cacheB{};
+        ContactManifold manifoldB{};
+        Collide(manifoldB, cacheB, world, b1, b2, gArenaReset);
+        TEST_ASSERT(manifoldA.mContactsCount == manifoldB.mContactsCount);
+        if (manifoldA.mContactsCount == 0)
+        {
+            return 0;
+        }
+        TEST_ASSERT(AlmostEqual(manifoldA.mNormal, manifoldB.mNormal, 0.0001f));
+        // The same points, maybe in another order.
+        for (int i = 0; i < manifoldA.mContactsCount; ++i)
+        {
+            const ContactPoint& a = manifoldA.mContacts[i];
+            bool isFound = false;
+            for (int j = 0; j < manifoldB.mContactsCount; ++j)
+            {
+                const ContactPoint& b = manifoldB.mContacts[j];
+                isFound = isFound
+                          || (AlmostEqual(a.mPosition, b.mPosition, 0.0001f)
+                              && AlmostEqual(a.mSeparation, b.mSeparation, 0.0001f));
+            }
+            TEST_ASSERT(isFound);
+        }
+        return manifoldA.mContactsCount;
+    };
+
+    u32 random = 1337;
+    const auto getRandomVec3 = [&random]()
+    {
+        return Vec3{
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f),
+            LfsrNextGetFloat(random, 1.0f) + 0.01f,
+        };
+    };
+    const auto getRandomQuat = [&]()
+    {
+        const f32 angle = LfsrNextGetFloat(random, M_PIf);
+        return Normalize(Quat::FromAxis(angle, Normalize(getRandomVec3())));
+    };
+
+    int edgeContactsCount = 0;
+    int faceContactsCount = 0;
+    for (int i = 0; i < 300; ++i)
+    {
+        const Quat orientation1 = getRandomQuat();
+        const Quat orientation2 = getRandomQuat();
+        const Vec3 position2
+            = Normalize(getRandomVec3()) * (0.7f * (boxes[0].mRadius + boxes[1].mRadius));
+        boxes[0].mOrientation = hulls[0].mOrientation = orientation1;
+        boxes[1].mOrientation = hulls[1].mOrientation = orientation2;
+        boxes[1].mPosition = hulls[1].mPosition = position2;
+        const int contactsCount = collideAndCompare(boxes[0], boxes[1], hulls[0], hulls[1]);
+        edgeContactsCount += contactsCount == 1;
+        faceContactsCount += contactsCount > 1;
+
+        // Outside and inside of the box.
+        sphere.mPosition = getRandomVec3() * (i % 2 == 0 ? 1.2f : 0.2f);
+        collideAndCompare(sphere, boxes[0], sphere, hulls[0]);
+        collideAndCompare(boxes[0], sphere, hulls[0], sphere);
+    }
+    TEST_ASSERT(edgeContactsCount > 10);
+    TEST_ASSERT(faceContactsCount > 10);
+
+    // A box resting on another one keeps its feature ids when it moves a little, so the
+    // contacts are warm started.
+    boxes[0].mOrientation = {1.0f, 0.0f, 0.0f, 0.0f};
+    boxes[1].mOrientation = Normalize(Quat::FromAxis(Radians(30.0f), {0.0f, 1.0f, 0.0f}));
+    boxes[1].mPosition = {0.1f, 0.84f, 0.2f};
+    SatCache cache{};
+    ContactManifold manifold1{};
+    Collide(manifold1, cache, world, boxes[0], boxes[1], gArenaReset);
+    boxes[1].mPosition += Vec3{0.01f, -0.002f, 0.0f};
+    ContactManifold manifold2{};
+    Collide(manifold2, cache, world, boxes[0], boxes[1], gArenaReset);
+    TEST_ASSERT(manifold1.mContactsCount == 4);
+    TEST_ASSERT(manifold2.mContactsCount == 4);
+    for (int i = 0; i < manifold1.mContactsCount; ++i)
+    {
+        const u64 id = Utils::BitCast<u64>(manifold1.mContacts[i].mFeatureId);
+        TEST_ASSERT(id == Utils::BitCast<u64>(manifold2.mContacts[i].mFeatureId));
+        for (int j = 0; j < i; ++j)
+        {
+            TEST_ASSERT(id != Utils::BitCast<u64>(manifold1.mContacts[j].mFeatureId));
+        }
+    }
+}
+
+TEST("Hulls with more than 255 half-edges collide")
+{
+    gArenaReset.Init(4'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    // The caps of the prism alone have more vertices than fit in u8.
+    constexpr int SIDES = 300;
+    Vec3 points[2 * SIDES]{};
+    for (int i = 0; i < SIDES; ++i)
+    {
+        const f32 angle = 2.0f * M_PIf * static_cast<f32>(i) / SIDES;
+        points[2 * i] = {cosf(angle), -0.5f, sinf(angle)};
+        points[2 * i + 1] = {cosf(angle), 0.5f, sinf(angle)};
+    }
+    ConvexHull prism{};
+    prism.InitFromPoints(points, ARRAY_SSIZE(points), gArenaReset);
+    TEST_ASSERT(prism.mVerticesCount == 2 * SIDES);
+    TEST_ASSERT(prism.mFacesCount == SIDES + 2);
+    TEST_ASSERT(prism.mMaxFaceVerticesCount == SIDES);
+    TEST_ASSERT(prism.mHalfEdges16 && !prism.mHalfEdges8);
+    TEST_ASSERT(prism.CheckConsistency() == ConvexHull::ConsistencyResult::Ok);
+
+    ConvexHull boxHull{};
+    boxHull.InitBox(Vec3{1.0f});
+    TEST_ASSERT(boxHull.mHalfEdges8 && !boxHull.mHalfEdges16);
+
+    const ConvexHull::Id prismHullId = world.AddConvexHull(prism);
+    Body prism1{};
+    world.BodyInitConvexHull(prism1, 1000.0f, prismHullId);
+    Body prism2 = prism1;
+    prism2.mPosition = {0.3f, 0.99f, 0.0f};
+
+    // The cap against cap clipping goes through all the side planes.
+    SatCache cache{};
+    ContactManifold manifold{};
+    Collide(manifold, cache, world, prism1, prism2, gArenaReset);
+    TEST_ASSERT(manifold.mContactsCount == ContactManifold::CONTACT_MAX_POINTS);
+    TEST_ASSERT(AlmostEqual(Abs(manifold.mNormal.Y()), 1.0f, 0.0001f));
+    for (int i = 0; i < manifold.mContactsCount; ++i)
+    {
+        TEST_ASSERT(AlmostEqual(manifold.mContacts[i].mSeparation, -0.01f, 0.001f));
+    }
+}
+
+TEST("World bodies come to rest on the floor")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    // Other broad-phases are tried with the sequential solver only.
+    struct Config
+    {
+        ContactSolverType mSolver;
+        BroadPhaseType mBroadPhase;
+    };
+    constexpr Config CONFIGS[] = {
+        {ContactSolverType::Sequential, BroadPhaseType::HGrid},
+        {ContactSolverType::Wide, BroadPhaseType::HGrid},
+        {ContactSolverType::SoftStep, BroadPhaseType::HGrid},
+        {ContactSolverType::Sequential, BroadPhaseType::AabbTree},
+        {ContactSolverType::Sequential, BroadPhaseType::SweepAndPrune},
+    };
+    for (const Config& config : CONFIGS)
+    {
+        World world{};
+        WorldDesc desc{};
+        desc.mGravity = {0.0f, -9.81f, 0.0f};
+        desc.mTimeStep = 1.0f / 60.0f;
+        desc.mIterationsCount = 10;
+        desc.mSolver = config.mSolver;
+        desc.mBroadPhase = config.mBroadPhase;
+        world.Init(desc);
+
+        ConvexHull floorHull{};
+        floorHull.InitBox({50.0f, 1.0f, 50.0f});
+        ConvexHull boxHull{};
+        boxHull.InitBox(Vec3{1.0f});
+        Body bodyDef{};
+        world.BodyInitConvexHull(bodyDef, FLT_MAX, world.AddConvexHull(floorHull));
+        bodyDef.mPosition.Y() = -0.5f;
+        world.AddBody(bodyDef);
+
+        constexpr f32 RADIUS = 0.5f;
+        world.BodyInitSphere(bodyDef, 1000.0f, RADIUS);
+        bodyDef.mPosition = {1.0f, 2.0f, -1.0f};
+        const Body::Id sphereId = world.AddBody(bodyDef);
+
+        // A stack of boxes, bodies share contacts between manifolds.
+        constexpr int STACK_HEIGHT = 5;
+        const ConvexHull::Id boxHullId = world.AddConvexHull(boxHull);
+        world.BodyInitConvexHull(bodyDef, 1000.0f, boxHullId);
+        Body::Id stackIds[STACK_HEIGHT];
+        for (int i = 0; i < STACK_HEIGHT; ++i)
+        {
+            bodyDef.mPosition = {-3.0f, 0.5f + 1.01f * static_cast<f32>(i), 2.0f};
+            stackIds[i] = world.AddBody(bodyDef);
+        }
+
+        for (int i = 0; i < 180; ++i)
+        {
+            gArenaFrame.FreeAll();
+            world.Step();
+        }
+
+        const Vec3 position = world.GetPosition(sphereId);
+        TEST_ASSERT(AlmostEqual(position.X(), 1.0f, 0.001f));
+        TEST_ASSERT(AlmostEqual(position.Z(), -1.0f, 0.001f));
+        // Baumgarte stabilization leaves some allowed penetration.
+        TEST_ASSERT(position.Y() < RADIUS && position.Y() > RADIUS - 0.1f);
+
+        // One manifold per pair, the sequential solver lets the stack creep a few centimeters.
+        for (int i = 0; i < STACK_HEIGHT; ++i)
+        {
+            const Vec3 boxPosition = world.GetPosition(stackIds[i]);
+            TEST_ASSERT(AlmostEqual(boxPosition.X(), -3.0f, 0.05f));
+            TEST_ASSERT(AlmostEqual(boxPosition.Z(), 2.0f, 0.05f));
+            TEST_ASSERT(AlmostEqual(boxPosition.Y(), 0.5f + static_cast<f32>(i), 0.1f));
+        }
+        // Boxes in the stack, the bottom one and the sphere on the floor.
+        TEST_ASSERT(world.GetContactManifoldsCount() == STACK_HEIGHT + 1);
+
+        gArenaReset.FreeAll();
+    }
+}
+
+TEST("World bodies rest on several static bodies")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    constexpr BroadPhaseType BROAD_PHASES[]
+        = {BroadPhaseType::HGrid, BroadPhaseType::AabbTree, BroadPhaseType::SweepAndPrune};
+    for (const BroadPhaseType broadPhase : BROAD_PHASES)
+    {
+        World world{};
+        WorldDesc desc{};
+        desc.mGravity = {0.0f, -9.81f, 0.0f};
+        desc.mTimeStep = 1.0f / 60.0f;
+        desc.mIterationsCount = 10;
+        desc.mBroadPhase = broadPhase;
+        world.Init(desc);
+
+        // Platforms at different heights, bigger than the largest HGrid cell.
+        constexpr int PLATFORMS_COUNT = 3;
+        ConvexHull platformHull{};
+        platformHull.InitBox({6.0f, 1.0f, 6.0f});
+        ConvexHull boxHull{};
+        boxHull.InitBox(Vec3{1.0f});
+        const ConvexHull::Id platformHullId = world.AddConvexHull(platformHull);
+        const ConvexHull::Id boxHullId = world.AddConvexHull(boxHull);
+
+        Body bodyDef{};
+        Body::Id boxIds[PLATFORMS_COUNT];
+        for (int i = 0; i < PLATFORMS_COUNT; ++i)
+        {
+            const f32 top = static_cast<f32>(i);
+            world.BodyInitConvexHull(bodyDef, FLT_MAX, platformHullId);
+            bodyDef.mPosition = {10.0f * static_cast<f32>(i), top - 0.5f, 0.0f};
+            world.AddBody(bodyDef);
+
+            world.BodyInitConvexHull(bodyDef, 1000.0f, boxHullId);
+            bodyDef.mPosition = {10.0f * static_cast<f32>(i), top + 0.5f, 0.0f};
+            boxIds[i] = world.AddBody(bodyDef);
+        }
+
+        for (int i = 0; i < 60; ++i)
+        {
+            gArenaFrame.FreeAll();
+            world.Step();
+        }
+
+        for (int i = 0; i < PLATFORMS_COUNT; ++i)
+        {
+            const Vec3 position = world.GetPosition(boxIds[i]);
+            TEST_ASSERT(AlmostEqual(position.Y(), static_cast<f32>(i) + 0.5f, 0.1f));
+        }
+        // Static bodies don't touch each other.
+        TEST_ASSERT(world.GetContactManifoldsCount() == PLATFORMS_COUNT);
+
+        gArenaReset.FreeAll();
+    }
+}
+
+TEST("World bullets don't tunnel through thin walls")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    // Without continuous collision both of them pass through in one step.
+    constexpr f32 SPEED = 120.0f; // 2 m per step.
+    constexpr f32 WALL_X = 5.0f;
+    constexpr f32 WALL_THICKNESS = 0.1f;
+    for (const bool isBullet : {false, true})
+    {
+        World world{};
+        WorldDesc desc{};
+        desc.mTimeStep = 1.0f / 60.0f;
+        desc.mIterationsCount = 10;
+        world.Init(desc);
+
+        ConvexHull wallHull{};
+        wallHull.InitBox({WALL_THICKNESS, 10.0f, 10.0f});
+        ConvexHull boxHull{};
+        boxHull.InitBox(Vec3{0.2f});
+        Body bodyDef{};
+        world.BodyInitConvexHull(bodyDef, FLT_MAX, world.AddConvexHull(wallHull));
+        bodyDef.mPosition = {WALL_X, 0.0f, 0.0f};
+        world.AddBody(bodyDef);
+
+        world.BodyInitSphere(bodyDef, 1000.0f, 0.1f);
+        bodyDef.mPosition = {0.3f, 1.0f, 0.0f};
+        bodyDef.mVelocity = {SPEED, 0.0f, 0.0f};
+        bodyDef.mIsBullet = isBullet;
+        const Body::Id sphereId = world.AddBody(bodyDef);
+
+        world.BodyInitConvexHull(bodyDef, 1000.0f, world.AddConvexHull(boxHull));
+        bodyDef.mPosition = {0.7f, -1.0f, 0.0f};
+        bodyDef.mVelocity = {SPEED, 0.0f, 0.0f};
+        bodyDef.mAngularVelocity = {0.0f, 0.0f, 5.0f};
+        bodyDef.mIsBullet = isBullet;
+        const Body::Id boxId = world.AddBody(bodyDef);
+
+        for (int i = 0; i < 60; ++i)
+        {
+            gArenaFrame.FreeAll();
+            world.Step();
+        }
+
+        for (const Body::Id id : {sphereId, boxId})
+        {
+            const bool isInFront = world.GetPosition(id).X() < WALL_X;
+            TEST_ASSERT(isInFront == isBullet);
+        }
+        gArenaReset.FreeAll();
+    }
+}
+
+TEST("World bullets hit dynamic bodies with every broad phase")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    // A floating slab, the bullet passes through it in one step without continuous collision.
+    constexpr f32 SPEED = 120.0f;
+    constexpr f32 SLAB_X = 5.0f;
+    for (const BroadPhaseType broadPhase :
+         {BroadPhaseType::HGrid, BroadPhaseType::AabbTree, BroadPhaseType::SweepAndPrune})
+    {
+        World world{};
+        WorldDesc desc{};
+        desc.mTimeStep = 1.0f / 60.0f;
+        desc.mIterationsCount = 10;
+        desc.mBroadPhase = broadPhase;
+        world.Init(desc);
+
+        Body bodyDef{};
+        world.BodyInitBox(bodyDef, 1000.0f, {0.05f, 1.2f, 1.2f});
+        bodyDef.mPosition = {SLAB_X, 0.0f, 0.0f};
+        const Body::Id slabId = world.AddBody(bodyDef);
+
+        // Other bodies away from the sweep.
+        world.BodyInitSphere(bodyDef, 1000.0f, 0.1f);
+        for (int i = 0; i < 20; ++i)
+        {
+            bodyDef.mPosition = {static_cast<f32>(i), 10.0f, 0.0f};
+            world.AddBody(bodyDef);
+        }
+
+        bodyDef.mPosition = {0.3f, 0.0f, 0.0f};
+        bodyDef.mVelocity = {SPEED, 0.0f, 0.0f};
+        bodyDef.mIsBullet = true;
+        const Body::Id bulletId = world.AddBody(bodyDef);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            gArenaFrame.FreeAll();
+            world.Step();
+        }
+        TEST_ASSERT(world.GetPosition(bulletId).X() < world.GetPosition(slabId).X());
+        gArenaReset.FreeAll();
+    }
+}
+
+TEST("World removes the manifolds of separated bodies")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    constexpr BroadPhaseType BROAD_PHASES[]
+        = {BroadPhaseType::HGrid, BroadPhaseType::AabbTree, BroadPhaseType::SweepAndPrune};
+    for (const BroadPhaseType broadPhase : BROAD_PHASES)
+    {
+        World world{};
+        WorldDesc desc{};
+        desc.mGravity = {0.0f, -9.81f, 0.0f};
+        desc.mTimeStep = 1.0f / 60.0f;
+        desc.mIterationsCount = 10;
+        desc.mBroadPhase = broadPhase;
+        desc.mContactManifoldsCapacity = 2;
+        world.Init(desc);
+
+        ConvexHull floorHull{};
+        floorHull.InitBox({50.0f, 1.0f, 50.0f});
+        ConvexHull boxHull{};
+        boxHull.InitBox(Vec3{1.0f});
+        Body bodyDef{};
+        world.BodyInitConvexHull(bodyDef, FLT_MAX, world.AddConvexHull(floorHull));
+        bodyDef.mPosition.Y() = -0.5f;
+        world.AddBody(bodyDef);
+
+        // A row of boxes touching each other and the floor.
+        constexpr int BOXES_COUNT = 8;
+        world.BodyInitConvexHull(bodyDef, 1000.0f, world.AddConvexHull(boxHull));
+        Body::Id ids[BOXES_COUNT];
+        for (int i = 0; i < BOXES_COUNT; ++i)
+        {
+            bodyDef.mPosition = {static_cast<f32>(i), 0.49f, 0.0f};
+            ids[i] = world.AddBody(bodyDef);
+        }
+        gArenaFrame.FreeAll();
+        world.Step();
+        TEST_ASSERT(world.GetContactManifoldsCount() == 2 * BOXES_COUNT - 1);
+
+        // Every other box is lifted away, its manifolds are removed, the rest stay valid.
+        for (int i = 0; i < BOXES_COUNT; i += 2)
+        {
+            world.SetPosition(ids[i], world.GetPosition(ids[i]) + Vec3{0.0f, 10.0f, 0.0f});
+        }
+        gArenaFrame.FreeAll();
+        world.Step();
+        TEST_ASSERT(world.GetContactManifoldsCount() == BOXES_COUNT / 2);
+
+        gArenaReset.FreeAll();
+    }
+}
+
+TEST("World results don't depend on the threads count")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    // Colors are independent, so splitting them between threads doesn't change anything.
+    constexpr int PYRAMID_BASE = 6;
+    constexpr int BODIES_COUNT = PYRAMID_BASE * (PYRAMID_BASE + 1) / 2;
+    constexpr int THREADS_COUNTS[] = {1, 2, 4};
+    constexpr ContactSolverType SOLVERS[]
+        = {ContactSolverType::Sequential, ContactSolverType::Wide, ContactSolverType::SoftStep};
+    for (const ContactSolverType solver : SOLVERS)
+    {
+        Vec3 positions[ARRAY_SIZE(THREADS_COUNTS)][BODIES_COUNT];
+        for (size_t t = 0; t < ARRAY_SIZE(THREADS_COUNTS); ++t)
+        {
+            ThreadPool pool;
+            pool.Init(THREADS_COUNTS[t]);
+            DEFER(pool.Shutdown());
+
+            World world{};
+            WorldDesc desc{};
+            desc.mGravity = {0.0f, -9.81f, 0.0f};
+            desc.mTimeStep = 1.0f / 60.0f;
+            desc.mIterationsCount = 10;
+            desc.mSolver = solver;
+            desc.mThreadPool = &pool;
+            world.Init(desc);
+
+            ConvexHull floorHull{};
+            floorHull.InitBox({50.0f, 1.0f, 50.0f});
+            ConvexHull boxHull{};
+            boxHull.InitBox(Vec3{1.0f});
+            Body bodyDef{};
+            world.BodyInitConvexHull(bodyDef, FLT_MAX, world.AddConvexHull(floorHull));
+            bodyDef.mPosition.Y() = -0.5f;
+            world.AddBody(bodyDef);
+
+            // 2D pyramid, plenty of manifolds sharing bodies.
+            world.BodyInitConvexHull(bodyDef, 1000.0f, world.AddConvexHull(boxHull));
+            Body::Id ids[BODIES_COUNT];
+            int added = 0;
+            for (int row = 0; row < PYRAMID_BASE; ++row)
+            {
+                for (int i = 0; i < PYRAMID_BASE - row; ++i)
+                {
+                    bodyDef.mPosition = {
+                        1.05f * static_cast<f32>(i) + 0.525f * static_cast<f32>(row),
+                        0.5f + 1.01f * static_cast<f32>(row),
+                        0.0f,
+                    };
+                    ids[added++] = world.AddBody(bodyDef);
+                }
+            }
+
+            for (int i = 0; i < 30; ++i)
+            {
+                gArenaFrame.FreeAll();
+                world.Step();
+            }
+
+            for (int i = 0; i < BODIES_COUNT; ++i)
+            {
+                positions[t][i] = world.GetPosition(ids[i]);
+            }
+            gArenaReset.FreeAll();
+        }
+
+        for (size_t t = 1; t < ARRAY_SIZE(THREADS_COUNTS); ++t)
+        {
+            TEST_ASSERT(!memcmp(positions[0], positions[t], sizeof(positions[0])));
+        }
+    }
+}
+
+TEST("World islands fall asleep and wake up together")
+{
+    gArenaReset.Init(16'000'000, "Reset");
+    DEFER(gArenaReset.FreeBuffer());
+    gArenaFrame.Init(16'000'000, "Frame");
+    DEFER(gArenaFrame.FreeBuffer());
+
+    World world{};
+    WorldDesc desc{};
+    desc.mGravity = {0.0f, -9.81f, 0.0f};
+    desc.mTimeStep = 1.0f / 60.0f;
+    desc.mIterationsCount = 10;
+    world.Init(desc);
+
+    ConvexHull floorHull{};
+    floorHull.InitBox({50.0f, 1.0f, 50.0f});
+    ConvexHull boxHull{};
+    boxHull.InitBox(Vec3{1.0f});
+    Body bodyDef{};
+    world.BodyInitConvexHull(bodyDef, FLT_MAX, world.AddConvexHull(floorHull));
+    bodyDef.mPosition.Y() = -0.5f;
+    world.AddBody(bodyDef);
+
+    // Two separate stacks, two islands.
+    constexpr int STACK_HEIGHT = 3;
+    world.BodyInitConvexHull(bodyDef, 1000.0f, world.AddConvexHull(boxHull));
+    Body::Id stackIds[2][STACK_HEIGHT];
+    for (int s = 0; s < 2; ++s)
+    {
+        for (int i = 0; i < STACK_HEIGHT; ++i)
+        {
+            bodyDef.mPosition
+                = {5.0f * static_cast<f32>(s), 0.5f + 1.01f * static_cast<f32>(i), 0.0f};
+            stackIds[s][i] = world.AddBody(bodyDef);
+        }
+    }
+
+    const auto step = [&](int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            gArenaFrame.FreeAll();
+            world.Step();
+        }
+    };
+
+    step(240);
+    TEST_ASSERT(world.GetAwakeBodiesCount() == 0);
+    // Sleeping bodies don't drift.
+    const Body::Id topId = stackIds[0][STACK_HEIGHT - 1];
+    const Vec3 restPosition = world.GetPosition(topId);
+    step(10);
+    const Vec3 position = world.GetPosition(topId);
+    TEST_ASSERT(!memcmp(&position, &restPosition, sizeof(position)));
+
+    // Moving the top box (still touching the one below) wakes up its stack only.
+    world.SetPosition(topId, world.GetPosition(topId) + Vec3{0.1f, 0.0f, 0.0f});
+    step(1);
+    for (int i = 0; i < STACK_HEIGHT; ++i)
+    {
+        TEST_ASSERT(!world.IsAsleep(stackIds[0][i]));
+        TEST_ASSERT(world.IsAsleep(stackIds[1][i]));
+    }
+
+    // A falling sphere wakes up the other one on contact.
+    step(240);
+    TEST_ASSERT(world.GetAwakeBodiesCount() == 0);
+    world.BodyInitSphere(bodyDef, 1000.0f, 0.5f);
+    bodyDef.mPosition = {5.0f, 4.0f, 0.0f};
+    world.AddBody(bodyDef);
+    step(30);
+    for (int i = 0; i < STACK_HEIGHT; ++i)
+    {
+        TEST_ASSERT(world.IsAsleep(stackIds[0][i]));
+        TEST_ASSERT(!world.IsAsleep(stackIds[1][i]));
+    }
 }
 
 #endif
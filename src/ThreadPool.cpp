@@ -0,0 +1,151 @@
+#include "ThreadPool.hpp"
+
+static constexpr int SPIN_COUNT = 256;
+
+static u32 GetGeneration(u64 work)
+{
+    return static_cast<u32>(work >> 32);
+}
+
+static int GetChunksLeft(u64 work)
+{
+    return static_cast<int>(work & UINT32_MAX);
+}
+
+void ThreadPool::Init(int threadsCount)
+{
+    assert(threadsCount > 0);
+
+    mThreadsCount = threadsCount < THREADS_MAX ? threadsCount : THREADS_MAX;
+    mWork.store(0);
+    mChunksDone.store(0);
+    mQuit.store(false);
+
+    for (int i = 1; i < mThreadsCount; ++i)
+    {
+        mThreads[i] = std::thread(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+void ThreadPool::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit.store(true);
+    }
+    mWakeUp.notify_all();
+
+    for (int i = 1; i < mThreadsCount; ++i)
+    {
+        mThreads[i].join();
+    }
+    mThreadsCount = 0;
+}
+
+int ThreadPool::GetThreadsCount() const
+{
+    return mThreadsCount;
+}
+
+void ThreadPool::RunChunks(u32 generation, int threadIndex)
+{
+    u64 work = mWork.load(std::memory_order_acquire);
+    for (;;)
+    {
+        if (GetGeneration(work) != generation || GetChunksLeft(work) == 0)
+        {
+            return;
+        }
+        if (!mWork.compare_exchange_weak(work, work - 1, std::memory_order_acquire))
+        {
+            continue;
+        }
+
+        // The job can't change until this chunk is done.
+        const int chunksCount = (mCount + mBatch - 1) / mBatch;
+        const int begin = (chunksCount - GetChunksLeft(work)) * mBatch;
+        const int end = begin + mBatch < mCount ? begin + mBatch : mCount;
+        mFunction(mContext, begin, end, threadIndex);
+        mChunksDone.fetch_add(1, std::memory_order_release);
+        work = mWork.load(std::memory_order_acquire);
+    }
+}
+
+void ThreadPool::WorkerLoop(int threadIndex)
+{
+    u32 generation = 0;
+    for (;;)
+    {
+        u64 work = mWork.load(std::memory_order_acquire);
+        for (int i = 0; i < SPIN_COUNT && GetGeneration(work) == generation; ++i)
+        {
+            std::this_thread::yield();
+            work = mWork.load(std::memory_order_acquire);
+        }
+
+        if (GetGeneration(work) == generation)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeUp.wait(
+                lock,
+                [&]
+                {
+                    work = mWork.load(std::memory_order_acquire);
+                    return mQuit.load() || GetGeneration(work) != generation;
+                }
+            );
+        }
+        if (mQuit.load())
+        {
+            return;
+        }
+
+        generation = GetGeneration(work);
+        RunChunks(generation, threadIndex);
+    }
+}
+
+void ThreadPool::ParallelFor(int count, int minBatch, Function function, void* context)
+{
+    assert(count >= 0);
+    assert(minBatch > 0);
+    assert(function);
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Roughly 4 chunks per thread for load balancing.
+    int batch = count / (mThreadsCount * 4);
+    batch = batch > minBatch ? batch : minBatch;
+    if (mThreadsCount <= 1 || batch >= count)
+    {
+        function(context, 0, count, 0);
+        return;
+    }
+    const int chunksCount = (count + batch - 1) / batch;
+
+    mFunction = function;
+    mContext = context;
+    mCount = count;
+    mBatch = batch;
+    mChunksDone.store(0, std::memory_order_relaxed);
+
+    const u32 generation = GetGeneration(mWork.load()) + 1;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWork.store(
+            (static_cast<u64>(generation) << 32) | static_cast<u64>(chunksCount),
+            std::memory_order_release
+        );
+    }
+    mWakeUp.notify_all();
+
+    RunChunks(generation, 0);
+
+    while (mChunksDone.load(std::memory_order_acquire) < chunksCount)
+    {
+        std::this_thread::yield();
+    }
+}
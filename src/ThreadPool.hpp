@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Common.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread works too,
+// so threadsCount includes it. Workers spin for a while after a job and then sleep,
+// the solver issues many short jobs back to back.
+struct ThreadPool
+{
+    static constexpr int THREADS_MAX = 64;
+
+    // Processes [begin, end), threadIndex is in [0, GetThreadsCount()), 0 is the caller.
+    using Function = void (*)(void* context, int begin, int end, int threadIndex);
+
+    void Init(int threadsCount);
+    void Shutdown();
+    int GetThreadsCount() const;
+
+    // Splits [0, count) into chunks of at least minBatch items and blocks until all of them
+    // are processed. Not reentrant, call only from the thread that called Init.
+    void ParallelFor(int count, int minBatch, Function function, void* context);
+
+    // function(begin, end, threadIndex)
+    template <typename F>
+    void ParallelFor(int count, int minBatch, const F& function)
+    {
+        ParallelFor(
+            count,
+            minBatch,
+            [](void* context, int begin, int end, int threadIndex)
+            { (*static_cast<const F*>(context))(begin, end, threadIndex); },
+            const_cast<F*>(&function)
+        );
+    }
+
+private:
+    std::thread mThreads[THREADS_MAX];
+    int mThreadsCount;
+
+    // Job description, read only after claiming a chunk. The caller waits for all the chunks
+    // before it writes the next job, so a claimed chunk always sees its own job.
+    Function mFunction;
+    void* mContext;
+    int mCount;
+    int mBatch;
+
+    // Generation in the high half, chunks left to claim in the low half. A late worker can't
+    // claim anything of a finished job, there are no chunks left, whatever the next job is.
+    std::atomic<u64> mWork;
+    std::atomic<int> mChunksDone;
+    std::atomic<bool> mQuit;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+
+    void WorkerLoop(int threadIndex);
+    void RunChunks(u32 generation, int threadIndex);
+};
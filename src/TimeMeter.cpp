@@ -1,26 +1,45 @@
 #include "TimeMeter.hpp"
 
+#ifdef DEMO_HEADLESS
+#include <chrono>
+#else
 #include "SDL3/SDL_timer.h"
+#endif
 
 static constexpr f64 ALPHA = 0.02;
 static constexpr f64 ONE_MINUS_ALPHA = 1.0 - ALPHA;
+
+#ifdef DEMO_HEADLESS
+// No SDL in headless builds (benchmark, tests).
+static u64 GetCounter()
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+static constexpr f64 COUNTER_PERIOD = 1.0e-9;
+#else
+static u64 GetCounter()
+{
+    return SDL_GetPerformanceCounter();
+}
 static const f64 COUNTER_PERIOD = 1.0 / static_cast<f64>(SDL_GetPerformanceFrequency());
+#endif
 
 void TimeMeter::Start()
 {
-    mStartTime = SDL_GetPerformanceCounter();
+    mStartTime = GetCounter();
 }
 
 void TimeMeter::End()
 {
-    mEndTime = SDL_GetPerformanceCounter();
+    mEndTime = GetCounter();
     mAverageTime = (ALPHA * static_cast<f64>(mEndTime - mStartTime) * COUNTER_PERIOD)
         + (ONE_MINUS_ALPHA * mAverageTime);
 }
 
 void TimeMeter::MeasureBetween()
 {
-    mEndTime = SDL_GetPerformanceCounter();
+    mEndTime = GetCounter();
     mAverageTime = (ALPHA * static_cast<f64>(mEndTime - mStartTime) * COUNTER_PERIOD)
         + (ONE_MINUS_ALPHA * mAverageTime);
     mStartTime = mEndTime;
@@ -35,3 +54,19 @@ f64 TimeMeter::GetMs() const
 {
     return mAverageTime * 1000.0;
 }
+
+f64 TimeMeter::GetLastUs() const
+{
+    return static_cast<f64>(mEndTime - mStartTime) * COUNTER_PERIOD * 1000'000.0;
+}
+
+void TimeMeter::ClearLast()
+{
+    mStartTime = 0;
+    mEndTime = 0;
+}
+
+bool TimeMeter::HasLast() const
+{
+    return mEndTime != 0;
+}
@@ -10,13 +10,15 @@ struct TimeMeter
         ProcessEvents,
         ProcessInput,
         Physics,
-        PhysicsCreateHGrid,
+        PhysicsUpdateBroadPhase,
         PhysicsContactManifold,
+        PhysicsIslands,
         PhysicsInertiasWorld,
         PhysicsIntegrateForces,
         PhysicsPrestep,
         PhysicsApplyImpulse,
         PhysicsIntegrateVelocities,
+        PhysicsContinuous,
         NewFrameFence,
         UpdateShadowCascades,
         UiDraw,
@@ -33,6 +35,9 @@ struct TimeMeter
     void MeasureBetween(); // uses only 1 getTime function
     f64 GetUs() const;
     f64 GetMs() const;
+    f64 GetLastUs() const; // Last measurement, not averaged.
+    void ClearLast(); // GetLastUs() is 0 until the next measurement.
+    bool HasLast() const; // False after ClearLast() until the next measurement.
 };
 
 inline TimeMeter gTimeMeters[TimeMeter::Count];